@@ -0,0 +1,19 @@
+/*!
+ *  \file cc.h
+ *  \details Host (Linux) replacement for Middlewares/Third_Party/LwIP/system/arch/cc.h, so the lwIP sources can be compiled for the benchmarks.
+ */
+#ifndef BENCH_CC_H_
+#define BENCH_CC_H_
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#define LWIP_TIMEVAL_PRIVATE 0
+#include <sys/time.h>
+
+#define PACK_STRUCT_BEGIN
+#define PACK_STRUCT_STRUCT __attribute__ ((__packed__))
+#define PACK_STRUCT_END
+#define PACK_STRUCT_FIELD(x) x
+
+#endif /* BENCH_CC_H_ */
@@ -0,0 +1,21 @@
+/*!
+ *  \file bench_fsdata.h
+ *  \details Replacement for the generated fsdata_custom.c. The benchmarks build the file system at runtime, so FS_ROOT and the sorted file table point to variables.
+ *  \remark fs.c is compiled twice: once with BENCH_SORTED_FILES (binary search) and once without it (linked list walk).
+ */
+#ifndef BENCH_FSDATA_H_
+#define BENCH_FSDATA_H_
+
+#include "lwip/apps/fs.h"
+
+extern const struct fsdata_file* benchRoot;
+extern const struct fsdata_file** benchSortedFiles;
+extern int benchFileAmount;
+
+#define FS_ROOT benchRoot
+#define FS_NUMFILES benchFileAmount
+#ifdef BENCH_SORTED_FILES
+#define FS_SORTED_FILES benchSortedFiles
+#endif
+
+#endif /* BENCH_FSDATA_H_ */
@@ -0,0 +1,276 @@
+/*!
+ *  \file fs_api_bench.c
+ *  \details Host benchmark for the file system API (Src/fileSystemAPI.c).
+ *  		 A synthetic file system with the same layout as Site_Images/files is built for every step: entryAmount images (.png + one .raw frame)
+ *  		 and entryAmount gifs (.gif + framesPerGif .raw frames). The latency of every API call is measured STEP_REPEATS times and the fastest
+ *  		 time is kept. The scaling over the last decade of steps is fitted and compared with the expected complexity, so a quadratic regression
+ *  		 makes the benchmark fail.
+ *  \remark Usage: fs_api_bench [maxEntryAmount] [framesPerGif] (default 10000 and 4). The steps go from 10 to maxEntryAmount in half decades.
+ */
+#include <math.h>
+#include <time.h>
+#include "fileSystemAPI.h"
+
+#define INIT_ROUNDS 5
+#define LIST_ROUNDS 20
+#define LOOKUP_CALLS 20000
+#define MAX_STEPS 16
+// every step is measured this many times, the fastest time is kept so one slow sample (an interrupt, a migration) doesn't count
+#define STEP_REPEATS 5
+
+// initFileSystemAPI and getImageList are O(n log n) and O(n), the lookups O(log n) or O(1).
+// The limits leave room for cache effects, but a quadratic algorithm always exceeds them.
+#define MAX_EXPONENT_LINEAR 1.5
+#define MAX_EXPONENT_LOOKUP 0.7
+
+typedef enum {bench_init, bench_list, bench_frames, bench_meta, bench_find, bench_amount} benchType;
+
+static const char* benchNames[bench_amount] = {"initFileSystemAPI", "getImageList", "getGifFrames", "getRawImageMetaData", "findImageByName"};
+static const double benchLimits[bench_amount] = {MAX_EXPONENT_LINEAR, MAX_EXPONENT_LINEAR, MAX_EXPONENT_LOOKUP, MAX_EXPONENT_LOOKUP, MAX_EXPONENT_LOOKUP};
+
+// The API walks the file system from pFirstFile, which is a const pointer. It points to a page whose next pointer is set for every step.
+static struct fsdata_file benchFirstFile = {NULL, (const unsigned char*)"/index.shtml", NULL, 0, 0};
+const struct fsdata_file* const pFirstFile = &benchFirstFile;
+
+// Every file has the same data without a .raw header, so the arguments in the names are used.
+static const uint32_t benchData[16] = {0};
+
+// Keeps the compiler from removing the calls that are measured.
+static volatile uintptr_t benchSink;
+
+static double getTime_ns(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+/*!
+ *  \brief Adds a file in front of the file list, the same way makefsdata links the files.
+ */
+static void addFile(struct fsdata_file* pFile, char* pPath, const struct fsdata_file** pLast)
+{
+	pFile->name = (const unsigned char*)pPath;
+	pFile->data = (const unsigned char*)benchData;
+	pFile->len = sizeof(benchData);
+	pFile->next = *pLast;
+	*pLast = pFile;
+}
+
+/*!
+ *  \brief Builds the file system of one step. The names are scrambled, so the catalog can't profit from files that are already sorted.
+ *
+ *  \return The amount of files, pFiles and pPaths have to be freed by the caller.
+ */
+static int buildFileSystem(int entryAmount, int framesPerGif, struct fsdata_file** pFiles, char*** pPaths)
+{
+	int fileAmount = entryAmount * 2 + entryAmount * (1 + framesPerGif);
+	int fileCnt = 0;
+	const struct fsdata_file* pLast = NULL;
+	char pathBuffer[64];
+
+	*pFiles = (struct fsdata_file*)calloc(fileAmount, sizeof(struct fsdata_file));
+	*pPaths = (char**)malloc(fileAmount * sizeof(char*));
+	for(int index = 0; index < entryAmount; index++)
+	{
+		int id = (int)(((long)index * 7919) % entryAmount);
+
+		snprintf(pathBuffer, sizeof(pathBuffer), "/images/img%05d.png", id);
+		(*pPaths)[fileCnt] = strdup(pathBuffer);
+		addFile(&(*pFiles)[fileCnt], (*pPaths)[fileCnt], &pLast);
+		fileCnt++;
+		snprintf(pathBuffer, sizeof(pathBuffer), "/images/img%05d#1#240x135@0.raw", id);
+		(*pPaths)[fileCnt] = strdup(pathBuffer);
+		addFile(&(*pFiles)[fileCnt], (*pPaths)[fileCnt], &pLast);
+		fileCnt++;
+
+		snprintf(pathBuffer, sizeof(pathBuffer), "/gifs/gif%05d/gif%05d.gif", id, id);
+		(*pPaths)[fileCnt] = strdup(pathBuffer);
+		addFile(&(*pFiles)[fileCnt], (*pPaths)[fileCnt], &pLast);
+		fileCnt++;
+		for(int frame = 1; frame <= framesPerGif; frame++)
+		{
+			snprintf(pathBuffer, sizeof(pathBuffer), "/gifs/gif%05d/gif%05d#%d#240x135@100.raw", id, id, frame);
+			(*pPaths)[fileCnt] = strdup(pathBuffer);
+			addFile(&(*pFiles)[fileCnt], (*pPaths)[fileCnt], &pLast);
+			fileCnt++;
+		}
+	}
+	benchFirstFile.next = pLast;
+	return fileCnt;
+}
+
+/*!
+ *  \brief Measures every API call for one step.
+ *
+ *  \return 1 when all results are correct, 0 otherwise.
+ */
+static int measureStep(int entryAmount, int framesPerGif, double* pResults)
+{
+	char** pList = (char**)malloc(entryAmount * sizeof(char*));
+	char* frameList[MAX_GIF_FRAMES];
+	struct imageMetaData metaData;
+	int ok = 1;
+	double start;
+
+	start = getTime_ns();
+	for(int round = 0; round < INIT_ROUNDS; round++)
+	{
+		ok = (initFileSystemAPI() == 1)? ok : 0;
+	}
+	pResults[bench_init] = (getTime_ns() - start) / INIT_ROUNDS;
+	ok = (getImageAmount() == entryAmount && getGifAmount() == entryAmount)? ok : 0;
+
+	start = getTime_ns();
+	for(int round = 0; round < LIST_ROUNDS; round++)
+	{
+		ok = (getImageList(pList, (round & 1)? gif : png, a_z) == entryAmount)? ok : 0;
+		benchSink += (uintptr_t)pList[entryAmount - 1];
+	}
+	pResults[bench_list] = (getTime_ns() - start) / LIST_ROUNDS;
+
+	// The lookups use a random (but reproducible) entry for every call, the names are built before the measurement.
+	char (*pNames)[64] = (char (*)[64])malloc(LOOKUP_CALLS * sizeof(*pNames));
+	int* pIds = (int*)malloc(LOOKUP_CALLS * sizeof(int));
+	srand(entryAmount);
+	for(int call = 0; call < LOOKUP_CALLS; call++)
+	{
+		pIds[call] = rand() % entryAmount;
+		snprintf(pNames[call], sizeof(*pNames), "/gifs/gif%05d/gif%05d.gif", pIds[call], pIds[call]);
+	}
+	start = getTime_ns();
+	for(int call = 0; call < LOOKUP_CALLS; call++)
+	{
+		ok = (getGifFrames(pNames[call], strlen(pNames[call]), frameList) == framesPerGif)? ok : 0;
+		benchSink += (uintptr_t)frameList[0];
+	}
+	pResults[bench_frames] = (getTime_ns() - start) / LOOKUP_CALLS;
+
+	for(int call = 0; call < LOOKUP_CALLS; call++)
+	{
+		snprintf(pNames[call], sizeof(*pNames), "/images/img%05d.png", pIds[call]);
+	}
+	start = getTime_ns();
+	for(int call = 0; call < LOOKUP_CALLS; call++)
+	{
+		ok = (getRawImageMetaData(pNames[call], strlen(pNames[call]), &metaData) == 1)? ok : 0;
+		benchSink += (uintptr_t)metaData.data;
+	}
+	pResults[bench_meta] = (getTime_ns() - start) / LOOKUP_CALLS;
+
+	// findImageByName ignores the folder and the extension and is case insensitive.
+	for(int call = 0; call < LOOKUP_CALLS; call++)
+	{
+		snprintf(pNames[call], sizeof(*pNames), "IMG%05d", pIds[call]);
+	}
+	start = getTime_ns();
+	for(int call = 0; call < LOOKUP_CALLS; call++)
+	{
+		ok = (findImageByName(pNames[call], strlen(pNames[call]), png, &metaData) == 1)? ok : 0;
+		benchSink += (uintptr_t)metaData.data;
+	}
+	pResults[bench_find] = (getTime_ns() - start) / LOOKUP_CALLS;
+
+	free(pIds);
+	free(pNames);
+	free(pList);
+	return ok;
+}
+
+/*!
+ *  \brief Fits time = c * entries^exponent through the results of stepAmount steps with least squares on the logarithms.
+ *
+ *  \return The exponent.
+ */
+static double fitExponent(const int* pEntryAmounts, const double (*pResults)[bench_amount], int bench, int stepAmount)
+{
+	double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+
+	for(int step = 0; step < stepAmount; step++)
+	{
+		double x = log((double)pEntryAmounts[step]);
+		double y = log(pResults[step][bench]);
+		sumX += x;
+		sumY += y;
+		sumXX += x * x;
+		sumXY += x * y;
+	}
+	return (stepAmount * sumXY - sumX * sumY) / (stepAmount * sumXX - sumX * sumX);
+}
+
+int main(int argc, char* argv[])
+{
+	int maxEntryAmount = (argc > 1)? atoi(argv[1]) : 10000;
+	int framesPerGif = (argc > 2)? atoi(argv[2]) : 4;
+	double results[MAX_STEPS][bench_amount];
+	double repeatResults[bench_amount];
+	int entryAmounts[MAX_STEPS];
+	int stepAmount = 0;
+	int failed = 0;
+
+	// Every frame is an entry of the catalog, which uses 16 bit indexes.
+	if(maxEntryAmount < 10 || framesPerGif < 1 || framesPerGif > MAX_GIF_FRAMES || (long)maxEntryAmount * (framesPerGif + 1) >= 0xFFFF)
+	{
+		printf("ERROR: maxEntryAmount has to be >= 10 and maxEntryAmount * (framesPerGif + 1) < 65535\n");
+		return -1;
+	}
+
+	// Half decade steps: 10, 30, 100, 300, ...
+	for(int decade = 10; decade <= maxEntryAmount; decade *= 10)
+	{
+		for(int factor = 1; factor <= 3 && decade * factor <= maxEntryAmount && stepAmount < MAX_STEPS; factor += 2)
+		{
+			entryAmounts[stepAmount++] = decade * factor;
+		}
+	}
+
+	printf("%8s %8s %14s %14s %14s %14s %14s\n", "entries", "files", "init us", "list us", "frames ns", "meta ns", "find ns");
+	for(int step = 0; step < stepAmount; step++)
+	{
+		struct fsdata_file* pFiles;
+		char** pPaths;
+		int fileAmount = buildFileSystem(entryAmounts[step], framesPerGif, &pFiles, &pPaths);
+
+		for(int repeat = 0; repeat < STEP_REPEATS; repeat++)
+		{
+			if(measureStep(entryAmounts[step], framesPerGif, repeatResults) == 0)
+			{
+				printf("ERROR: wrong result with %d entries\n", entryAmounts[step]);
+				return -1;
+			}
+			for(int bench = 0; bench < bench_amount; bench++)
+			{
+				results[step][bench] = (repeat == 0 || repeatResults[bench] < results[step][bench])? repeatResults[bench] : results[step][bench];
+			}
+		}
+		printf("%8d %8d %14.1f %14.1f %14.1f %14.1f %14.1f\n", entryAmounts[step], fileAmount, results[step][bench_init] / 1000, results[step][bench_list] / 1000, results[step][bench_frames], results[step][bench_meta], results[step][bench_find]);
+
+		// The catalog points into this file system, it is only read again after the next step has rebuilt it.
+		for(int index = 0; index < fileAmount; index++)
+		{
+			free(pPaths[index]);
+		}
+		free(pPaths);
+		free(pFiles);
+	}
+
+	// The scaling exponent over the last decade of steps: time ~ entries^exponent, fitted with least squares on log(time) and log(entries).
+	if(stepAmount >= 2)
+	{
+		int last = stepAmount - 1;
+		int first = last;
+		while(first > 0 && entryAmounts[first - 1] * 10 >= entryAmounts[last])
+		{
+			first--;
+		}
+		first = (first == last)? last - 1 : first;
+		printf("\nscaling from %d to %d entries (%d steps):\n", entryAmounts[first], entryAmounts[last], last - first + 1);
+		for(int bench = 0; bench < bench_amount; bench++)
+		{
+			double exponent = fitExponent(&entryAmounts[first], &results[first], bench, last - first + 1);
+			printf("%20s %6.2f (limit %.2f)%s\n", benchNames[bench], exponent, benchLimits[bench], (exponent > benchLimits[bench])? " REGRESSION" : "");
+			failed = (exponent > benchLimits[bench])? 1 : failed;
+		}
+	}
+	return failed;
+}
@@ -0,0 +1,129 @@
+/*!
+ *  \file fs_lookup_bench.c
+ *  \details Host benchmark for fs_open (Middlewares/Third_Party/LwIP/src/apps/http/fs.c).
+ *  		 A synthetic file system with a configurable amount of files is built and every file is opened in a random order,
+ *  		 once with the linked list walk and once with the binary search over the sorted file table that makefsdata generates.
+ *  \remark Usage: fs_lookup_bench [maxFileAmount] (default 4096). The amount of files is doubled every step, starting at 16.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lwip/apps/fs.h"
+
+// fs.c is compiled twice, the linked list version is renamed by the Makefile.
+err_t fs_open_linear(struct fs_file *file, const char *name);
+
+const struct fsdata_file* benchRoot = NULL;
+const struct fsdata_file** benchSortedFiles = NULL;
+int benchFileAmount = 0;
+
+#define LOOKUP_ROUNDS 20
+
+static int compareFiles(const void* pA, const void* pB)
+{
+	return strcmp((const char*)(*(const struct fsdata_file* const*)pA)->name, (const char*)(*(const struct fsdata_file* const*)pB)->name);
+}
+
+static double getTime_ns(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+/*!
+ *  \brief Builds a file system that looks like Site_Images/files: a few pages and a lot of gif frames.
+ */
+static struct fsdata_file* buildFileSystem(int fileAmount, char** pNames)
+{
+	struct fsdata_file* pFiles = (struct fsdata_file*)calloc(fileAmount, sizeof(struct fsdata_file));
+	char pathBuffer[64];
+
+	for(int index = 0; index < fileAmount; index++)
+	{
+		if(index < 4)
+		{
+			snprintf(pathBuffer, sizeof(pathBuffer), "/page%d.html", index);
+		}
+		else
+		{
+			snprintf(pathBuffer, sizeof(pathBuffer), "/gifs/anim%d/anim%d#%d#240x167@150.raw", index / 16, index / 16, index % 16 + 1);
+		}
+		pNames[index] = strdup(pathBuffer);
+		pFiles[index].name = (const unsigned char*)pNames[index];
+		pFiles[index].data = (const unsigned char*)pNames[index];
+		pFiles[index].len = strlen(pNames[index]);
+		pFiles[index].next = (index == 0)? NULL : &pFiles[index - 1];
+	}
+	benchRoot = &pFiles[fileAmount - 1];
+	benchSortedFiles = (const struct fsdata_file**)malloc(fileAmount * sizeof(struct fsdata_file*));
+	for(int index = 0; index < fileAmount; index++)
+	{
+		benchSortedFiles[index] = &pFiles[index];
+	}
+	qsort(benchSortedFiles, fileAmount, sizeof(struct fsdata_file*), compareFiles);
+	benchFileAmount = fileAmount;
+	return pFiles;
+}
+
+static double measure(err_t (*pOpen)(struct fs_file*, const char*), char** pOrder, int fileAmount)
+{
+	struct fs_file file;
+	int found = 0;
+	double start = getTime_ns();
+
+	for(int round = 0; round < LOOKUP_ROUNDS; round++)
+	{
+		for(int index = 0; index < fileAmount; index++)
+		{
+			found += (pOpen(&file, pOrder[index]) == ERR_OK)? 1 : 0;
+		}
+	}
+	if(found != LOOKUP_ROUNDS * fileAmount)
+	{
+		printf("ERROR: only %d of %d lookups succeeded\n", found, LOOKUP_ROUNDS * fileAmount);
+		exit(-1);
+	}
+	return (getTime_ns() - start) / (LOOKUP_ROUNDS * fileAmount);
+}
+
+int main(int argc, char* argv[])
+{
+	int maxFileAmount = (argc > 1)? atoi(argv[1]) : 4096;
+
+	printf("%8s %16s %16s %8s\n", "files", "linear ns/open", "sorted ns/open", "speedup");
+	for(int fileAmount = 16; fileAmount <= maxFileAmount; fileAmount *= 2)
+	{
+		char** pNames = (char**)malloc(fileAmount * sizeof(char*));
+		char** pOrder = (char**)malloc(fileAmount * sizeof(char*));
+		struct fsdata_file* pFiles = buildFileSystem(fileAmount, pNames);
+		double linear_ns;
+		double sorted_ns;
+
+		// The files are opened in a random (but reproducible) order.
+		memcpy(pOrder, pNames, fileAmount * sizeof(char*));
+		srand(fileAmount);
+		for(int index = fileAmount - 1; index > 0; index--)
+		{
+			int swapIndex = rand() % (index + 1);
+			char* pSwap = pOrder[index];
+			pOrder[index] = pOrder[swapIndex];
+			pOrder[swapIndex] = pSwap;
+		}
+
+		linear_ns = measure(fs_open_linear, pOrder, fileAmount);
+		sorted_ns = measure(fs_open, pOrder, fileAmount);
+		printf("%8d %16.1f %16.1f %7.1fx\n", fileAmount, linear_ns, sorted_ns, linear_ns / sorted_ns);
+
+		for(int index = 0; index < fileAmount; index++)
+		{
+			free(pNames[index]);
+		}
+		free(pNames);
+		free(pOrder);
+		free(pFiles);
+		free(benchSortedFiles);
+	}
+	return 0;
+}
@@ -0,0 +1,18 @@
+/*!
+ *  \file lwipopts.h
+ *  \details Host (Linux) lwIP options for the benchmarks. Only the options used by the http file system are set.
+ */
+#ifndef BENCH_LWIPOPTS_H_
+#define BENCH_LWIPOPTS_H_
+
+#define NO_SYS 1
+#define LWIP_NETCONN 0
+#define LWIP_SOCKET 0
+#define LWIP_HTTPD_CUSTOM_FILES 0
+#define LWIP_HTTPD_DYNAMIC_FILE_READ 0
+#define LWIP_HTTPD_FILE_STATE 0
+#define LWIP_HTTPD_FS_ASYNC_READ 0
+#define HTTPD_PRECALCULATED_CHECKSUM 0
+#define HTTPD_FSDATA_FILE "bench_fsdata.h"
+
+#endif /* BENCH_LWIPOPTS_H_ */
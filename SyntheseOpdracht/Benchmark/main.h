@@ -0,0 +1,18 @@
+/*!
+ *  \file main.h
+ *  \details Host (Linux) replacement for Inc/main.h, so Src/fileSystemAPI.c, Src/LAYOUT_functions.c and Src/SCALE_functions.c can be compiled without the HAL.
+ *  \remark The Makefile copies the headers of the file system API, the text layout and the scaler to the build directory, so this file is found instead of Inc/main.h.
+ */
+#ifndef BENCH_MAIN_H_
+#define BENCH_MAIN_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// CMSIS compiler macros that are used by the file system API.
+#define __weak __attribute__((weak))
+#define __DMB() __sync_synchronize()
+
+#endif /* BENCH_MAIN_H_ */
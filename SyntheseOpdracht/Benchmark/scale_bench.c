@@ -0,0 +1,281 @@
+/*!
+ *  \file scale_bench.c
+ *  \details Host benchmark for the image scaler (Src/SCALE_functions.c).
+ *  		 Random images of random sizes are scaled in random strips of rows and every pixel is compared with a scaler that weighs every channel on its own.
+ *  		 Then the time per output megapixel is measured for the sizes of the LCD: a large picture scaled down and a small picture scaled up to the picture area.
+ *  		 The time is also converted to cycles per output megapixel with the clock of the time stamp counter (x86), measured against CLOCK_MONOTONIC,
+ *  		 so it can be compared with the cycles that MEASURE_BLIT_TIME prints on the board for every scaled picture.
+ *  		 The host compiles the C versions of the DSP instructions, so the cycles only show the trend.
+ *  \remark Usage: scale_bench [imageAmount] (default 500). The benchmark fails when a scaled pixel is wrong.
+ */
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "SCALE_functions.h"
+
+#define BENCH_MAX_SOURCE 300
+#define BENCH_ROUNDS 20
+// the time the clock of the time stamp counter is measured over
+#define CLOCK_MEASURE_NS 100000000.0
+
+struct scaleCase
+{
+	const char* pName;
+	uint16_t srcWidth;
+	uint16_t srcHeight;
+};
+
+// a photo that is scaled down and an icon that is scaled up, both to the picture area (240x272)
+static const struct scaleCase scaleCases[] =
+{
+	{"1024x768 down", 1024, 768},
+	{"640x480 down", 640, 480},
+	{"100x100 up", 100, 100},
+};
+
+static struct scaleJob benchJob;
+static uint32_t sourcePixels[1024 * 768];
+static uint32_t scaledPixels[SCALE_MAX_WIDTH * 272 + 1];
+static uint32_t expectedPixels[SCALE_MAX_WIDTH * 272];
+
+// Keeps the compiler from removing the calls that are measured.
+static volatile uint32_t benchSink;
+
+static double getTime_ns(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+/*!
+ *  \brief Measures the clock of the time stamp counter against CLOCK_MONOTONIC.
+ *
+ *  \return The clock in Hz, 0 when the host has no time stamp counter.
+ *  \remark The time stamp counter runs at the nominal clock of the CPU, a CPU that runs faster or slower than that needs more or less real cycles.
+ */
+static double getCycleClock(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	double start = getTime_ns();
+	uint64_t startCycles = __rdtsc();
+	double elapsed;
+
+	while((elapsed = getTime_ns() - start) < CLOCK_MEASURE_NS);
+	return (double)(__rdtsc() - startCycles) * 1e9 / elapsed;
+#else
+	return 0;
+#endif
+}
+
+/*!
+ *  \brief The source line and weight of a scaled line, calculated for every pixel again: the line whose center is nearest, or the 2 lines around the center.
+ */
+static void getReferenceLine(scaleFilter filter, uint16_t line, uint16_t srcSize, uint16_t dstSize, uint16_t* pIndex, uint16_t* pWeight)
+{
+	// the same 16.16 step as the scaler, the position is rounded the same way
+	int32_t step = ((uint32_t)srcSize << 16) / dstSize;
+	int64_t position = (int64_t)step / 2 + (int64_t)line * step - ((filter == scale_bilinear)? 0x8000 : 0);
+
+	position = (position < 0)? 0 : (position > ((int64_t)(srcSize - 1) << 16))? ((int64_t)(srcSize - 1) << 16) : position;
+	*pIndex = (uint16_t)(position >> 16);
+	*pWeight = (filter == scale_bilinear)? (uint16_t)((position >> 8) & 0xFF) : 0;
+	if(filter == scale_bilinear && *pIndex == srcSize - 1 && srcSize > 1)
+	{
+		*pIndex = srcSize - 2;
+		*pWeight = 256;
+	}
+}
+
+/*!
+ *  \brief Scales an image channel by channel, the result the scaler has to give.
+ */
+static void scaleReference(const void* pSrc, uint16_t srcWidth, uint16_t srcHeight, uint8_t pixelFormat, uint16_t dstWidth, uint16_t dstHeight, scaleFilter filter, void* pDst)
+{
+	for(uint16_t y = 0; y < dstHeight; y++)
+	{
+		uint16_t row;
+		uint16_t rowWeight;
+
+		getReferenceLine(filter, y, srcHeight, dstHeight, &row, &rowWeight);
+		for(uint16_t x = 0; x < dstWidth; x++)
+		{
+			uint16_t column;
+			uint16_t columnWeight;
+			uint16_t nextRow = row + ((srcHeight > 1)? 1 : 0);
+			uint16_t nextColumn;
+
+			getReferenceLine(filter, x, srcWidth, dstWidth, &column, &columnWeight);
+			nextColumn = column + ((srcWidth > 1)? 1 : 0);
+			if(pixelFormat == RAW_FORMAT_ARGB8888)
+			{
+				const uint32_t* pPixels = pSrc;
+				uint32_t pixel = 0;
+
+				for(uint8_t shift = 0; shift < 32; shift += 8)
+				{
+					uint32_t top = (((pPixels[row * srcWidth + column] >> shift) & 0xFF) * (256 - columnWeight) + ((pPixels[row * srcWidth + nextColumn] >> shift) & 0xFF) * columnWeight) >> 8;
+					uint32_t bottom = (((pPixels[nextRow * srcWidth + column] >> shift) & 0xFF) * (256 - columnWeight) + ((pPixels[nextRow * srcWidth + nextColumn] >> shift) & 0xFF) * columnWeight) >> 8;
+
+					pixel |= ((top * (256 - rowWeight) + bottom * rowWeight) >> 8) << shift;
+				}
+				((uint32_t*)pDst)[y * dstWidth + x] = pixel;
+			}
+			else
+			{
+				const uint16_t* pPixels = pSrc;
+				uint16_t right = columnWeight >> 3;
+				uint16_t down = rowWeight >> 3;
+				// the alpha bit of the nearest pixel
+				uint16_t pixel = pPixels[((rowWeight >= 128)? nextRow : row) * srcWidth + ((columnWeight >= 128)? nextColumn : column)] & 0x8000;
+
+				for(uint8_t shift = 0; shift < 15; shift += 5)
+				{
+					uint32_t top = (((pPixels[row * srcWidth + column] >> shift) & 0x1F) * (32 - right) + ((pPixels[row * srcWidth + nextColumn] >> shift) & 0x1F) * right) >> 5;
+					uint32_t bottom = (((pPixels[nextRow * srcWidth + column] >> shift) & 0x1F) * (32 - right) + ((pPixels[nextRow * srcWidth + nextColumn] >> shift) & 0x1F) * right) >> 5;
+
+					pixel |= ((top * (32 - down) + bottom * down) >> 5) << shift;
+				}
+				((uint16_t*)pDst)[y * dstWidth + x] = pixel;
+			}
+		}
+	}
+}
+
+/*!
+ *  \brief Scales random images in strips of random heights and compares them with the reference.
+ *
+ *  \return 1 when all pixels are correct, 0 otherwise.
+ */
+static uint8_t checkScaler(int imageAmount)
+{
+	for(int image = 0; image < imageAmount; image++)
+	{
+		uint16_t srcWidth = 1 + rand() % BENCH_MAX_SOURCE;
+		uint16_t srcHeight = 1 + rand() % BENCH_MAX_SOURCE;
+		uint16_t dstWidth = 1 + rand() % 240;
+		uint16_t dstHeight = 1 + rand() % 272;
+		uint8_t pixelFormat = (image % 2)? RAW_FORMAT_ARGB1555 : RAW_FORMAT_ARGB8888;
+		scaleFilter filter = ((image / 2) % 2)? scale_nearest : scale_bilinear;
+		uint32_t bytesPerPixel = (pixelFormat == RAW_FORMAT_ARGB8888)? 4 : 2;
+		uint8_t* pScaled = (uint8_t*)scaledPixels;
+		uint16_t rows;
+
+		for(uint32_t pixel = 0; pixel < (uint32_t)srcWidth * srcHeight; pixel++)
+		{
+			sourcePixels[pixel] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+		}
+		if(initScaleJob(&benchJob, sourcePixels, srcWidth, srcHeight, pixelFormat, dstWidth, dstHeight, filter) == 0)
+		{
+			printf("ERROR: image %d (%ux%u to %ux%u) is not scaled\n", image, srcWidth, srcHeight, dstWidth, dstHeight);
+			return 0;
+		}
+		// the strips follow each other, so a strip of an odd width starts in the middle of a word
+		while((rows = scaleRows(&benchJob, pScaled, 1 + rand() % 20)) != 0)
+		{
+			pScaled += rows * dstWidth * bytesPerPixel;
+		}
+		scaleReference(sourcePixels, srcWidth, srcHeight, pixelFormat, dstWidth, dstHeight, filter, expectedPixels);
+		if(pScaled != (uint8_t*)scaledPixels + (uint32_t)dstWidth * dstHeight * bytesPerPixel || memcmp(scaledPixels, expectedPixels, (uint32_t)dstWidth * dstHeight * bytesPerPixel) != 0)
+		{
+			printf("ERROR: image %d (%s %s, %ux%u to %ux%u) is scaled wrong\n", image, (pixelFormat == RAW_FORMAT_ARGB8888)? "ARGB8888" : "ARGB1555",
+					(filter == scale_bilinear)? "bilinear" : "nearest", srcWidth, srcHeight, dstWidth, dstHeight);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*!
+ *  \brief Measures the scaler, 16 rows at a time like the LCD streams them.
+ *
+ *  \return The time per output megapixel in ms (equal to the time per output pixel in ns).
+ */
+static double measureScaler(const struct scaleCase* pCase, uint8_t pixelFormat, scaleFilter filter, uint8_t reference)
+{
+	uint16_t dstWidth;
+	uint16_t dstHeight;
+	double start;
+
+	fitImageSize(pCase->srcWidth, pCase->srcHeight, 240, 272, &dstWidth, &dstHeight);
+	start = getTime_ns();
+	for(int round = 0; round < BENCH_ROUNDS; round++)
+	{
+		if(reference)
+		{
+			scaleReference(sourcePixels, pCase->srcWidth, pCase->srcHeight, pixelFormat, dstWidth, dstHeight, filter, scaledPixels);
+		}
+		else
+		{
+			initScaleJob(&benchJob, sourcePixels, pCase->srcWidth, pCase->srcHeight, pixelFormat, dstWidth, dstHeight, filter);
+			while(scaleRows(&benchJob, scaledPixels, 16) != 0);
+		}
+		benchSink += scaledPixels[0];
+	}
+	return (getTime_ns() - start) / BENCH_ROUNDS / ((double)dstWidth * dstHeight);
+}
+
+int main(int argc, char** argv)
+{
+	int imageAmount = (argc > 1)? atoi(argv[1]) : 500;
+	uint16_t width;
+	uint16_t height;
+	double cycleClock;
+	double scaler_ms;
+
+	if(imageAmount < 1)
+	{
+		printf("ERROR: imageAmount has to be >= 1\n");
+		return -1;
+	}
+	srand(1);
+	// the size of the picture area is kept when a side touches it, a wide picture fills the width
+	fitImageSize(240, 100, 240, 272, &width, &height);
+	if(width != 240 || height != 100)
+	{
+		printf("ERROR: 240x100 is fitted to %ux%u\n", width, height);
+		return -1;
+	}
+	fitImageSize(1024, 768, 240, 272, &width, &height);
+	if(width != 240 || height != 180)
+	{
+		printf("ERROR: 1024x768 is fitted to %ux%u\n", width, height);
+		return -1;
+	}
+	if(checkScaler(imageAmount) == 0)
+	{
+		return -1;
+	}
+	printf("%d images scaled correctly\n", imageAmount);
+	for(uint32_t pixel = 0; pixel < sizeof(sourcePixels) / sizeof(sourcePixels[0]); pixel++)
+	{
+		sourcePixels[pixel] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+	}
+	cycleClock = getCycleClock();
+	if(cycleClock != 0)
+	{
+		printf("cycle clock %.0f MHz (time stamp counter)\n", cycleClock / 1e6);
+	}
+	else
+	{
+		printf("no time stamp counter, the cycles per output MP are only printed on the board (MEASURE_BLIT_TIME)\n");
+	}
+	printf("%14s %9s %9s %16s %18s %16s\n", "picture", "format", "filter", "ms/output MP", "Mcycles/output MP", "per channel ms");
+	for(uint8_t index = 0; index < sizeof(scaleCases) / sizeof(scaleCases[0]); index++)
+	{
+		for(uint8_t format = 0; format < 2; format++)
+		{
+			for(uint8_t filter = 0; filter < 2; filter++)
+			{
+				uint8_t pixelFormat = (format == 0)? RAW_FORMAT_ARGB8888 : RAW_FORMAT_ARGB1555;
+
+				// ms per output MP times the clock in kHz is the amount of cycles per output MP
+				scaler_ms = measureScaler(&scaleCases[index], pixelFormat, (scaleFilter)filter, 0);
+				printf("%14s %9s %9s %16.2f %18.2f %16.2f\n", scaleCases[index].pName, (format == 0)? "ARGB8888" : "ARGB1555", (filter == 0)? "nearest" : "bilinear",
+						scaler_ms, scaler_ms * (cycleClock / 1e3) / 1e6, measureScaler(&scaleCases[index], pixelFormat, (scaleFilter)filter, 1));
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,360 @@
+/*!
+ *  \file text_layout_bench.c
+ *  \details Host benchmark for the text layout (Src/LAYOUT_functions.c).
+ *  		 The lines of some fixed texts are compared with the expected lines, then synthetic texts (ASCII and UTF-8, with long words and newlines)
+ *  		 are laid out and every layout is checked: no line is too long, no byte is lost and every line is as long as possible.
+ *  		 The throughput is compared with the word wrap that textToLCD used before: copying character by character and going back to the last space.
+ *  \remark Usage: text_layout_bench [textAmount] (default 2000). The benchmark fails when a layout is wrong.
+ */
+#include <time.h>
+#include "LAYOUT_functions.h"
+
+// the amount of characters that fit on a line of the LCD: ((LCD_WIDTH-11)/2)/Font12.Width
+#define BENCH_CHARS_ON_LINE 33
+#define BENCH_TEXT_LENGTH 2048
+#define BENCH_ROUNDS 20
+
+// the expected lines of a text, a line that ends with '-' is broken in a word
+struct layoutCase
+{
+	const char* pText;
+	uint16_t charsOnLine;
+	uint16_t lineAmount;
+	const char* lines[6];
+};
+
+static const struct layoutCase layoutCases[] =
+{
+	{"hello world foo", 10, 2, {"hello", "world foo"}},
+	{"0123456789 next", 10, 2, {"0123456789", "next"}},
+	{"abcdefghijklmnop", 10, 2, {"abcdefghi-", "jklmnop"}},
+	{"a\r\nb\n\nc\rd\n", 10, 5, {"a", "b", "", "c", "d"}},
+	{"one two  three", 8, 2, {"one two ", "three"}},
+	{"\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9", 10, 2,
+	 {"\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9-", "\xc3\xa9\xc3\xa9"}},
+	{"\xe2\x82\xac 5\tX", 3, 2, {"\xe2\x82\xac 5", "X"}},
+	{"", 10, 0, {NULL}},
+};
+
+static struct textLayout benchLayout;
+
+// Keeps the compiler from removing the calls that are measured.
+static volatile uintptr_t benchSink;
+
+static double getTime_ns(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+/*!
+ *  \brief The word wrap of the previous textToLCD, drawTextLine is replaced by the sink. It only handles ASCII without control characters.
+ *
+ *  \return The amount of lines.
+ */
+static uint16_t wrapTextCopying(const char* textArray, uint16_t charsOnLine)
+{
+	// one byte longer than in textToLCD, it wrote the '\0' after a '-' behind the buffer
+	char BufString[charsOnLine + 2];
+	uint16_t lines = 0;
+	uint16_t Count = 0;
+	uint16_t CountTotal = 0;
+	uint8_t Spacefound = 0;
+
+	while(textArray[CountTotal] != '\0')
+	{
+		BufString[Count] = textArray[CountTotal];
+		if(BufString[Count] == ' ')
+		{
+			Spacefound = 1;
+		}
+		Count++;
+		CountTotal++;
+		if(Count == charsOnLine)
+		{
+			if(Spacefound == 1)
+			{
+				while(BufString[(Count - 1)] != ' ')
+				{
+					BufString[(Count - 1)] = '\0';
+					Count--;
+					CountTotal--;
+				}
+			}
+			if(Spacefound == 0)
+			{
+				BufString[(Count + 1)] = '\0';
+				BufString[(Count - 1)] = '-';
+				CountTotal -= 1;
+			}
+			BufString[Count] = '\0';
+			if(BufString[Count - 1] == ' ')
+			{
+				BufString[Count - 1] = '\0';
+			}
+			benchSink += strlen(BufString);
+			lines++;
+			Count = 0;
+			Spacefound = 0;
+		}
+	}
+	BufString[Count] = '\0';
+	benchSink += strlen(BufString);
+	return lines + 1;
+}
+
+/*!
+ *  \brief Compares the layout of the fixed texts with the expected lines.
+ *
+ *  \return 1 when all layouts are correct, 0 otherwise.
+ */
+static int checkCases(void)
+{
+	int ok = 1;
+
+	for(uint16_t index = 0; index < sizeof(layoutCases) / sizeof(layoutCases[0]); index++)
+	{
+		const struct layoutCase* pCase = &layoutCases[index];
+		uint16_t lineAmount = layoutText(&benchLayout, pCase->pText, strlen(pCase->pText), pCase->charsOnLine);
+
+		if(lineAmount != pCase->lineAmount)
+		{
+			printf("ERROR: case %u has %u lines instead of %u\n", index, lineAmount, pCase->lineAmount);
+			ok = 0;
+			continue;
+		}
+		for(uint16_t line = 0; line < lineAmount; line++)
+		{
+			const struct textSpan* pSpan = &benchLayout.lines[line];
+			char text[64];
+
+			snprintf(text, sizeof(text), "%.*s%s", pSpan->length, pCase->pText + pSpan->start, pSpan->hyphen? "-" : "");
+			if(strcmp(text, pCase->lines[line]) != 0)
+			{
+				printf("ERROR: line %u of case %u is \"%s\" instead of \"%s\"\n", line, index, text, pCase->lines[line]);
+				ok = 0;
+			}
+		}
+	}
+	return ok;
+}
+
+/*!
+ *  \brief Counts the characters of a part of a text, like layoutText does.
+ */
+static uint16_t countChars(const char* pText, uint16_t length)
+{
+	const char* pEnd = pText + length;
+	uint16_t chars = 0;
+
+	while(pText < pEnd)
+	{
+		decodeUTF8(&pText, pEnd);
+		chars++;
+	}
+	return chars;
+}
+
+/*!
+ *  \brief Checks a layout: no line has more than charsOnLine characters (with the '-'), the lines and the spaces or newlines between them are the whole text,
+ *  	   a line is only broken in a word when the word doesn't fit on a line, and the first word of the next line doesn't fit on a line that ends at a space.
+ *
+ *  \return 1 when the layout is correct, 0 otherwise.
+ */
+static int checkLayout(const struct textLayout* pLayout, uint16_t charsOnLine)
+{
+	const char* pText = pLayout->pText;
+	uint16_t position = 0;
+
+	for(uint16_t line = 0; line < pLayout->lineAmount; line++)
+	{
+		const struct textSpan* pSpan = &pLayout->lines[line];
+		uint16_t end = pSpan->start + pSpan->length;
+
+		if(pSpan->chars != countChars(pText + pSpan->start, pSpan->length) || pSpan->chars + pSpan->hyphen > charsOnLine || pSpan->start != position)
+		{
+			return 0;
+		}
+		if(line + 1 == pLayout->lineAmount)
+		{
+			// only a newline (or the space where a full line is broken) can follow the last line
+			return end == pLayout->textLength || (end + 1 == pLayout->textLength && (pText[end] == '\n' || pText[end] == '\r' || (pText[end] == ' ' && pSpan->chars == charsOnLine)))
+					|| (end + 2 == pLayout->textLength && pText[end] == '\r' && pText[end + 1] == '\n');
+		}
+		position = pLayout->lines[line + 1].start;
+		if(pSpan->hyphen)
+		{
+			// a word is only broken when the line has no space and is full
+			if(position != end || pSpan->chars != charsOnLine - 1 || memchr(pText + pSpan->start, ' ', pSpan->length) != NULL)
+			{
+				return 0;
+			}
+		}
+		else if(pText[end] == '\n' || pText[end] == '\r')
+		{
+			if(position != end + ((pText[end] == '\r' && pText[end + 1] == '\n')? 2 : 1))
+			{
+				return 0;
+			}
+		}
+		else
+		{
+			const struct textSpan* pNext = &pLayout->lines[line + 1];
+			uint16_t wordLength = 0;
+			uint16_t wordChars;
+
+			// the line is broken at one space
+			if(position != end + 1 || pText[end] != ' ')
+			{
+				return 0;
+			}
+			// the first word of the next line doesn't fit behind it, a broken word is longer than the next line
+			while(wordLength < pNext->length && pText[pNext->start + wordLength] != ' ')
+			{
+				wordLength++;
+			}
+			wordChars = countChars(pText + pNext->start, wordLength) + ((wordLength == pNext->length)? pNext->hyphen : 0);
+			if(pSpan->chars + 1 + wordChars <= charsOnLine)
+			{
+				return 0;
+			}
+		}
+	}
+	return position == 0 && pLayout->textLength == 0;
+}
+
+/*!
+ *  \brief Builds a text of random words: short and long words, optionally UTF-8 characters and newlines.
+ *
+ *  \return The length of the text in bytes.
+ */
+static uint16_t buildText(char* pText, uint16_t length, int utf8)
+{
+	static const char* const utf8Chars[] = {"\xc3\xa9", "\xc3\xab", "\xe2\x82\xac", "\xf0\x9f\x98\x80"};
+	uint16_t position = 0;
+
+	while(position + 8 < length)
+	{
+		int wordLength = (rand() % 10 == 0)? 20 + rand() % 60 : 1 + rand() % 9;
+
+		for(int index = 0; index < wordLength && position + 5 < length; index++)
+		{
+			if(utf8 && rand() % 4 == 0)
+			{
+				const char* pChar = utf8Chars[rand() % 4];
+
+				memcpy(pText + position, pChar, strlen(pChar));
+				position += strlen(pChar);
+			}
+			else
+			{
+				pText[position++] = 'a' + rand() % 26;
+			}
+		}
+		pText[position++] = (utf8 && rand() % 20 == 0)? '\n' : ' ';
+	}
+	pText[position] = '\0';
+	return position;
+}
+
+/*!
+ *  \brief Measures the layout of textAmount texts and checks every layout.
+ *
+ *  \return The time per byte in ns, a negative value when a layout is wrong.
+ */
+static double measureLayout(char (*pTexts)[BENCH_TEXT_LENGTH + 1], const uint16_t* pLengths, int textAmount, int check)
+{
+	double start;
+
+	for(int text = 0; text < textAmount && check; text++)
+	{
+		for(uint16_t charsOnLine = 2; charsOnLine <= BENCH_CHARS_ON_LINE; charsOnLine += 7)
+		{
+			layoutText(&benchLayout, pTexts[text], pLengths[text], charsOnLine);
+			// a truncated layout is checked up to its last line
+			if(benchLayout.truncated)
+			{
+				benchLayout.textLength = benchLayout.lines[TEXT_LAYOUT_MAX_LINES - 1].start + benchLayout.lines[TEXT_LAYOUT_MAX_LINES - 1].length;
+			}
+			if((benchLayout.truncated && benchLayout.lineAmount != TEXT_LAYOUT_MAX_LINES) || checkLayout(&benchLayout, charsOnLine) == 0)
+			{
+				printf("ERROR: wrong layout of text %d with %u characters on a line\n", text, charsOnLine);
+				return -1;
+			}
+		}
+	}
+	start = getTime_ns();
+	uint64_t bytes = 0;
+	for(int round = 0; round < BENCH_ROUNDS; round++)
+	{
+		for(int text = 0; text < textAmount; text++)
+		{
+			benchSink += layoutText(&benchLayout, pTexts[text], pLengths[text], BENCH_CHARS_ON_LINE);
+			bytes += pLengths[text];
+		}
+	}
+	return (getTime_ns() - start) / bytes;
+}
+
+int main(int argc, char** argv)
+{
+	int textAmount = (argc > 1)? atoi(argv[1]) : 2000;
+	char (*pTexts)[BENCH_TEXT_LENGTH + 1];
+	uint16_t* pLengths;
+	double start;
+	double copyingTime;
+	double asciiTime;
+	double utf8Time;
+	uint64_t bytes = 0;
+
+	if(textAmount < 1)
+	{
+		printf("ERROR: textAmount has to be >= 1\n");
+		return -1;
+	}
+	if(checkCases() == 0)
+	{
+		return -1;
+	}
+	pTexts = malloc(textAmount * sizeof(*pTexts));
+	pLengths = malloc(textAmount * sizeof(*pLengths));
+
+	// ASCII texts, the only texts the previous word wrap could show
+	srand(1);
+	for(int text = 0; text < textAmount; text++)
+	{
+		pLengths[text] = buildText(pTexts[text], BENCH_TEXT_LENGTH, 0);
+	}
+	start = getTime_ns();
+	for(int round = 0; round < BENCH_ROUNDS; round++)
+	{
+		for(int text = 0; text < textAmount; text++)
+		{
+			benchSink += wrapTextCopying(pTexts[text], BENCH_CHARS_ON_LINE);
+			bytes += pLengths[text];
+		}
+	}
+	copyingTime = (getTime_ns() - start) / bytes;
+	asciiTime = measureLayout(pTexts, pLengths, textAmount, 1);
+
+	// UTF-8 texts with newlines
+	for(int text = 0; text < textAmount; text++)
+	{
+		pLengths[text] = buildText(pTexts[text], BENCH_TEXT_LENGTH, 1);
+	}
+	utf8Time = measureLayout(pTexts, pLengths, textAmount, 1);
+	free(pTexts);
+	free(pLengths);
+	if(asciiTime < 0 || utf8Time < 0)
+	{
+		return -1;
+	}
+
+	printf("%u cases and %d texts of %d bytes laid out correctly\n", (unsigned)(sizeof(layoutCases) / sizeof(layoutCases[0])), textAmount * 2, BENCH_TEXT_LENGTH);
+	printf("%28s %10s %10s\n", "word wrap", "ns/byte", "MB/s");
+	printf("%28s %10.2f %10.1f\n", "copy and go back (ASCII)", copyingTime, 1e3 / copyingTime);
+	printf("%28s %10.2f %10.1f\n", "layoutText (ASCII)", asciiTime, 1e3 / asciiTime);
+	printf("%28s %10.2f %10.1f\n", "layoutText (UTF-8)", utf8Time, 1e3 / utf8Time);
+	return 0;
+}
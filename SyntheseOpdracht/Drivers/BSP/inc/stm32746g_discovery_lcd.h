@@ -247,6 +247,14 @@ void     BSP_LCD_ClockConfig(LTDC_HandleTypeDef *hltdc, void *Params);
 void WDA_LCD_DrawBitmap(void *pSrc, uint32_t xPos, uint32_t yPos, uint32_t xSize, uint32_t ySize, uint32_t ColorMode);
 //ImageWidth is de breedte van de afbeelding waaruit een stuk moet gekopieerd worden
 void WDA_LCD_DrawPartOfBitmap(void *pSrc, uint32_t xPos, uint32_t yPos, uint32_t xSize, uint32_t ySize, uint32_t ColorMode, uint32_t ImageWidth);
+//Address is het framebuffer waarin de BSP tekent, de laag die getoond wordt verandert niet (voor een back buffer)
+uint32_t WDA_LCD_SetDrawAddress(uint32_t Address);
+//geeft het framebuffer terug waarin de BSP tekent
+uint32_t WDA_LCD_GetDrawAddress(void);
+//laat laag LayerIndex de pixels van een afbeelding rechtstreeks uit het geheugen tonen in een venster van xSize x ySize op xPos, yPos, zonder reload
+void WDA_LCD_SetLayerPicture(uint32_t LayerIndex, const void *pSrc, uint32_t xPos, uint32_t yPos, uint32_t xSize, uint32_t ySize, uint32_t PixelFormat);
+//laadt de CLUT van een laag met een L8 afbeelding, alleen als de LTDC ze niet leest (vertical sync of laag uit)
+void WDA_LCD_SetLayerCLUT(uint32_t LayerIndex, const uint32_t *pCLUT, uint32_t CLUTSize);
 /**
   * @}
   */ 
@@ -71,6 +71,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm32746g_discovery_lcd.h"
 #include "fonts.h"
+#include "DMA2D_functions.h"
 /*
 #include "../drivers/font24.c"
 #include "../drivers/font20.c"
@@ -118,7 +119,6 @@
   * @{
   */ 
 LTDC_HandleTypeDef  hLtdcHandler;
-static DMA2D_HandleTypeDef hDma2dHandler;
 
 /* Default LCD configuration with LCD Layer 1 */
 static uint32_t            ActiveLayer = 0;
@@ -595,6 +595,9 @@ uint32_t BSP_LCD_ReadPixel(uint16_t Xpos, uint16_t Ypos)
 {
   uint32_t ret = 0;
   
+  /* The pixel can still be written by a queued DMA2D job */
+  waitDMA2D();
+
   if(hLtdcHandler.LayerCfg[ActiveLayer].PixelFormat == LTDC_PIXEL_FORMAT_ARGB8888)
   {
     /* Read data value from SDRAM memory */
@@ -1002,6 +1005,9 @@ void BSP_LCD_DrawEllipse(int Xpos, int Ypos, int XRadius, int YRadius)
   */
 void BSP_LCD_DrawPixel(uint16_t Xpos, uint16_t Ypos, uint32_t RGB_Code)
 {
+  /* A queued DMA2D job could overwrite the pixel afterwards */
+  waitDMA2D();
+
   /* Write data value to all SDRAM memory */
   if(hLtdcHandler.LayerCfg[ActiveLayer].PixelFormat == LTDC_PIXEL_FORMAT_RGB565)
   { /* RGB565 format */
@@ -1568,32 +1574,11 @@ static void FillTriangle(uint16_t x1, uint16_t x2, uint16_t x3, uint16_t y1, uin
   */
 static void LL_FillBuffer(uint32_t LayerIndex, void *pDst, uint32_t xSize, uint32_t ySize, uint32_t OffLine, uint32_t ColorIndex) 
 {
-  /* Register to memory mode with ARGB8888 as color Mode */ 
-  hDma2dHandler.Init.Mode         = DMA2D_R2M;
-  if(hLtdcHandler.LayerCfg[ActiveLayer].PixelFormat == LTDC_PIXEL_FORMAT_RGB565)
-  { /* RGB565 format */ 
-    hDma2dHandler.Init.ColorMode    = DMA2D_RGB565;
-  }
-  else
-  { /* ARGB8888 format */
-    hDma2dHandler.Init.ColorMode    = DMA2D_ARGB8888;
-  }
-  hDma2dHandler.Init.OutputOffset = OffLine;      
-  
-  hDma2dHandler.Instance = DMA2D;
-  
-  /* DMA2D Initialization */
-  if(HAL_DMA2D_Init(&hDma2dHandler) == HAL_OK) 
-  {
-    if(HAL_DMA2D_ConfigLayer(&hDma2dHandler, LayerIndex) == HAL_OK) 
-    {
-      if (HAL_DMA2D_Start(&hDma2dHandler, ColorIndex, (uint32_t)pDst, xSize, ySize) == HAL_OK)
-      {
-        /* Polling For DMA transfer */  
-        HAL_DMA2D_PollForTransfer(&hDma2dHandler, 10);
-      }
-    }
-  } 
+  /* Register to memory job in the color mode of the layer, the DMA2D queue converts the color */
+  struct dma2dJob job = {.type = dma2d_fill, .pDst = pDst, .dstOffset = OffLine, .width = xSize, .height = ySize, .color = ColorIndex};
+
+  job.dstFormat = (hLtdcHandler.LayerCfg[LayerIndex].PixelFormat == LTDC_PIXEL_FORMAT_RGB565)? RAW_FORMAT_RGB565 : RAW_FORMAT_ARGB8888;
+  addDMA2DJob(&job);
 }
 
 /**
@@ -1606,31 +1591,10 @@ static void LL_FillBuffer(uint32_t LayerIndex, void *pDst, uint32_t xSize, uint3
   */
 static void LL_ConvertLineToARGB8888(void *pSrc, void *pDst, uint32_t xSize, uint32_t ColorMode)
 {    
-  /* Configure the DMA2D Mode, Color Mode and output offset */
-  hDma2dHandler.Init.Mode         = DMA2D_M2M_PFC;
-  hDma2dHandler.Init.ColorMode    = DMA2D_ARGB8888;
-  hDma2dHandler.Init.OutputOffset = 0;     
-  
-  /* Foreground Configuration */
-  hDma2dHandler.LayerCfg[1].AlphaMode = DMA2D_NO_MODIF_ALPHA;
-  hDma2dHandler.LayerCfg[1].InputAlpha = 0xFF;
-  hDma2dHandler.LayerCfg[1].InputColorMode = ColorMode;
-  hDma2dHandler.LayerCfg[1].InputOffset = 0;
-  
-  hDma2dHandler.Instance = DMA2D; 
-  
-  /* DMA2D Initialization */
-  if(HAL_DMA2D_Init(&hDma2dHandler) == HAL_OK) 
-  {
-    if(HAL_DMA2D_ConfigLayer(&hDma2dHandler, 1) == HAL_OK) 
-    {
-      if (HAL_DMA2D_Start(&hDma2dHandler, (uint32_t)pSrc, (uint32_t)pDst, xSize, 1) == HAL_OK)
-      {
-        /* Polling For DMA transfer */  
-        HAL_DMA2D_PollForTransfer(&hDma2dHandler, 10);
-      }
-    }
-  } 
+  /* Memory to memory job with pixel format conversion */
+  struct dma2dJob job = {.type = dma2d_copy, .pSrc = pSrc, .srcFormat = ColorMode, .srcAlpha = 0xFF, .pDst = pDst, .dstFormat = RAW_FORMAT_ARGB8888, .width = xSize, .height = 1};
+
+  addDMA2DJob(&job);
 }
 
 uint32_t WDA_LCD_GetXSize(){
@@ -1639,71 +1603,62 @@ uint32_t WDA_LCD_GetXSize(){
 
 void WDA_LCD_DrawBitmap(void *pSrc, uint32_t xPos, uint32_t yPos, uint32_t xSize, uint32_t ySize, uint32_t ColorMode)
 {
-
-
 	uint32_t address = hLtdcHandler.LayerCfg[ActiveLayer].FBStartAdress + (((480*yPos) + xPos)*(4));
-	void *pDst = (void *)address;
+	struct dma2dJob job = {.type = dma2d_copy, .pSrc = pSrc, .srcFormat = ColorMode, .srcAlpha = 0xFF, .pDst = (void *)address, .dstOffset = 480-xSize, .dstFormat = RAW_FORMAT_ARGB8888, .width = xSize, .height = ySize};
 
-  /* Configure the DMA2D Mode, Color Mode and output offset */
-	hDma2dHandler.Init.Mode         = DMA2D_M2M_PFC;
-	hDma2dHandler.Init.ColorMode    = DMA2D_ARGB8888;
-	hDma2dHandler.Init.OutputOffset = 480-xSize;
+	//de DMA2D tekent de afbeelding na de vorige jobs, de functie wacht er niet op
+	addDMA2DJob(&job);
+}
 
-  /* Foreground Configuration */
-	hDma2dHandler.LayerCfg[1].AlphaMode = DMA2D_NO_MODIF_ALPHA;
-	hDma2dHandler.LayerCfg[1].InputAlpha = 0xFF;
-	hDma2dHandler.LayerCfg[1].InputColorMode = ColorMode;
-	hDma2dHandler.LayerCfg[1].InputOffset = 0;
+//Address is het framebuffer waarin de BSP tekent, de laag die getoond wordt verandert niet (voor een back buffer)
+//geeft het vorige adres terug zodat het hersteld kan worden
+uint32_t WDA_LCD_SetDrawAddress(uint32_t Address)
+{
+	uint32_t previousAddress = hLtdcHandler.LayerCfg[ActiveLayer].FBStartAdress;
 
-	hDma2dHandler.Instance = DMA2D;
+	hLtdcHandler.LayerCfg[ActiveLayer].FBStartAdress = Address;
+	return previousAddress;
+}
 
-  /* DMA2D Initialization */
-  if(HAL_DMA2D_Init(&hDma2dHandler) == HAL_OK)
-  {
-    if(HAL_DMA2D_ConfigLayer(&hDma2dHandler, 1) == HAL_OK)
-    {
-      if (HAL_DMA2D_Start(&hDma2dHandler, (uint32_t)pSrc, (uint32_t)pDst, xSize, ySize) == HAL_OK)
-      {
-        /* Polling For DMA transfer */
-        HAL_DMA2D_PollForTransfer(&hDma2dHandler, 10);
-      }
-    }
-  }
+//geeft het framebuffer terug waarin de BSP tekent
+uint32_t WDA_LCD_GetDrawAddress(void)
+{
+	return hLtdcHandler.LayerCfg[ActiveLayer].FBStartAdress;
 }
 
 //ImageWidth is de breedte van de afbeelding waaruit een stuk moet gekopieerd worden
 void WDA_LCD_DrawPartOfBitmap(void *pSrc, uint32_t xPos, uint32_t yPos, uint32_t xSize, uint32_t ySize, uint32_t ColorMode, uint32_t ImageWidth)
 {
-
-
 	uint32_t address = hLtdcHandler.LayerCfg[ActiveLayer].FBStartAdress + (((480*yPos) + xPos)*(4));
-	void *pDst = (void *)address;
-
-  /* Configure the DMA2D Mode, Color Mode and output offset */
-	hDma2dHandler.Init.Mode         = DMA2D_M2M_PFC;
-	hDma2dHandler.Init.ColorMode    = DMA2D_ARGB8888;
-	hDma2dHandler.Init.OutputOffset = WDA_LCD_GetXSize()-xSize;
+	struct dma2dJob job = {.type = dma2d_copy, .pSrc = pSrc, .srcOffset = ImageWidth-xSize, .srcFormat = ColorMode, .srcAlpha = 0xFF, .pDst = (void *)address, .dstOffset = WDA_LCD_GetXSize()-xSize, .dstFormat = RAW_FORMAT_ARGB8888, .width = xSize, .height = ySize};
 
-  /* Foreground Configuration */
-	hDma2dHandler.LayerCfg[1].AlphaMode = DMA2D_NO_MODIF_ALPHA;
-	hDma2dHandler.LayerCfg[1].InputAlpha = 0xFF;
-	hDma2dHandler.LayerCfg[1].InputColorMode = ColorMode;
-	hDma2dHandler.LayerCfg[1].InputOffset = ImageWidth-xSize;
+	//de DMA2D tekent de afbeelding na de vorige jobs, de functie wacht er niet op
+	addDMA2DJob(&job);
+}
 
-	hDma2dHandler.Instance = DMA2D;
+//laat laag LayerIndex de pixels van een afbeelding rechtstreeks uit het geheugen tonen, er wordt niets gekopieerd
+//de registers worden pas geladen bij de volgende BSP_LCD_Reload
+void WDA_LCD_SetLayerPicture(uint32_t LayerIndex, const void *pSrc, uint32_t xPos, uint32_t yPos, uint32_t xSize, uint32_t ySize, uint32_t PixelFormat)
+{
+	//eerst het formaat, de lengte van een lijn in bytes hangt ervan af
+	HAL_LTDC_SetPixelFormat_NoReload(&hLtdcHandler, PixelFormat, LayerIndex);
+	//de breedte van het venster is ook de breedte van de afbeelding
+	HAL_LTDC_SetWindowSize_NoReload(&hLtdcHandler, xSize, ySize, LayerIndex);
+	HAL_LTDC_SetWindowPosition_NoReload(&hLtdcHandler, xPos, yPos, LayerIndex);
+	HAL_LTDC_SetAddress_NoReload(&hLtdcHandler, (uint32_t)pSrc, LayerIndex);
+	if(PixelFormat != LTDC_PIXEL_FORMAT_L8)
+	{
+		HAL_LTDC_DisableCLUT_NoReload(&hLtdcHandler, LayerIndex);
+	}
+	__HAL_LTDC_LAYER_ENABLE(&hLtdcHandler, LayerIndex);
+}
 
-  /* DMA2D Initialization */
-  if(HAL_DMA2D_Init(&hDma2dHandler) == HAL_OK)
-  {
-    if(HAL_DMA2D_ConfigLayer(&hDma2dHandler, 1) == HAL_OK)
-    {
-      if (HAL_DMA2D_Start(&hDma2dHandler, (uint32_t)pSrc, (uint32_t)pDst, xSize, ySize) == HAL_OK)
-      {
-        /* Polling For DMA transfer */
-    	HAL_DMA2D_PollForTransfer(&hDma2dHandler, 10);
-      }
-    }
-  }
+//laadt de CLUT van een laag met een L8 afbeelding, de LTDC mag ze op dat moment niet lezen (vertical sync of laag uit)
+//de CLUT van de LTDC heeft geen alpha, die van de ARGB8888 kleuren wordt genegeerd
+void WDA_LCD_SetLayerCLUT(uint32_t LayerIndex, const uint32_t *pCLUT, uint32_t CLUTSize)
+{
+	HAL_LTDC_ConfigCLUT(&hLtdcHandler, (uint32_t *)pCLUT, CLUTSize, LayerIndex);
+	HAL_LTDC_EnableCLUT_NoReload(&hLtdcHandler, LayerIndex);
 }
 /**
   * @}
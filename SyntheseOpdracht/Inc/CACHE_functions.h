@@ -0,0 +1,52 @@
+/*!
+ *  \file CACHE_functions.h
+ *	\details This file contains the function prototypes of the frame cache. The frames and pictures are read from the memory mapped QSPI, which is a lot slower
+ *			 than the SDRAM. The cache copies a frame (or decodes a compressed frame) into a slot in the SDRAM the first time it is used and the DMA2D draws it from there,
+ *			 so a looping gif runs completely out of the SDRAM after its first loop when all its frames fit.
+ */
+#ifndef CACHE_FUNCTIONS_H_
+#define CACHE_FUNCTIONS_H_
+#include <string.h>
+#include "main.h"
+#include "imageManifest.h"
+#include "fileSystemAPI.h"
+#include "DMA2D_functions.h"
+#include "RLE_functions.h"
+
+/*!
+ * \def FRAME_CACHE_SLOT_SIZE
+ * Every slot holds one frame of at most MAX_IMAGE_WIDTH x MAX_IMAGE_HEIGHT 16 bit pixels, larger frames are drawn from the QSPI.
+ */
+#define FRAME_CACHE_SLOT_SIZE (MAX_IMAGE_WIDTH*MAX_IMAGE_HEIGHT*2)
+// the maximum amount of slots, the rest of the region isn't used
+#define FRAME_CACHE_MAX_SLOTS 64
+// the amount of gif frames after the shown frame that are copied into the cache ahead
+#define FRAME_CACHE_PREFETCH 2
+// an uncompressed frame is copied by the DMA2D as lines of this amount of words
+#define FRAME_CACHE_COPY_WIDTH 1024
+
+// use of the cache since startup
+struct frameCacheStatistics
+{
+	// frames that were drawn from the cache
+	uint32_t hits;
+	// frames that had to be copied or decoded before they were drawn
+	uint32_t misses;
+	// frames that were copied or decoded ahead
+	uint32_t prefetches;
+	// frames that were removed to make room for another frame
+	uint32_t evictions;
+	uint16_t usedSlots;
+	uint16_t slotAmount;
+	// cycles the CPU needed to copy or decode a frame (measured when the cycle counter runs, see MEASURE_BLIT_TIME)
+	uint32_t averageFillCycles;
+	uint32_t maxFillCycles;
+};
+
+void initFrameCache(uint32_t address, uint32_t size);
+void* getCachedFrame(const struct imageMetaData* pFrame);
+void prefetchFrame(const struct imageMetaData* pFrame);
+void setFrameCacheJob(const void* pPixels, uint32_t job);
+void getFrameCacheStatistics(struct frameCacheStatistics* pStatistics);
+
+#endif /* CACHE_FUNCTIONS_H_ */
@@ -5,5 +5,8 @@
 #include "httpd.h"
 #include "lwip/init.h"
 
-u16_t mySsiHandler(const char*, char *, int);
+/* amount of images that are inserted in one part of the photo tag (LWIP_HTTPD_SSI_MULTIPART) */
+#define SSI_IMAGES_PER_PART 16
+
+u16_t mySsiHandler(const char*, char *, int, u16_t, u16_t *);
 #endif /* CGI_SSI_H_ */
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*!
+ *  \file DMA2D_functions.h
+ *	\details This file contains the function prototypes of the DMA2D job queue. Fills, copies (with pixel format conversion) and blends are
+ *			 queued and started one after the other by the DMA2D transfer complete interrupt, so the CPU doesn't wait while the DMA2D draws.
+ */
+#ifndef DMA2D_FUNCTIONS_H_
+#define DMA2D_FUNCTIONS_H_
+#include "main.h"
+#include "imageManifest.h"
+
+/*!
+ * \def DMA2D_QUEUE_LENGTH
+ * The maximum amount of jobs that can be queued. Adding a job to a full queue waits until the oldest job is done.
+ */
+#define DMA2D_QUEUE_LENGTH 16
+// priority of the DMA2D interrupt, lower than the SysTick (0) and higher than the LTDC interrupt that queues the steps of a transition
+#define DMA2D_IRQ_PRIORITY 1
+
+// the maximum width and offset of a job (14 bit registers)
+#define DMA2D_MAX_WIDTH 0x3FFF
+#define DMA2D_MAX_OFFSET 0x3FFF
+// the maximum amount of CLUT entries
+#define DMA2D_MAX_CLUT_SIZE 256
+
+typedef enum {dma2d_fill, dma2d_copy, dma2d_blend} dma2dJobType;
+
+/*!
+ * \struct dma2dJob
+ * One DMA2D operation. The formats are DMA2D color modes, which are equal to RAW_FORMAT_xxx. An offset is the amount of pixels that is skipped at the end of every line.
+ * A job with a CLUT first loads it in the DMA2D, unless it is the CLUT that was loaded last.
+ * \remark The job is copied into the queue, but the source, background and destination are only read or written when the job runs.
+ */
+struct dma2dJob
+{
+	dma2dJobType type;
+	// source of a copy, foreground of a blend
+	const void* pSrc;
+	uint16_t srcOffset;
+	uint8_t srcFormat;
+	// alpha the source is multiplied with, 0xFF leaves the source alpha unchanged
+	uint8_t srcAlpha;
+	// ARGB8888 color look-up table of a source in a CLUT format (L8, AL44, AL88, L4), NULL for the other formats
+	const uint32_t* pClut;
+	uint16_t clutSize;
+	// background of a blend
+	const void* pBackground;
+	uint16_t backgroundOffset;
+	uint8_t backgroundFormat;
+	// destination, only RAW_FORMAT_ARGB8888 up to RAW_FORMAT_ARGB4444 can be written
+	void* pDst;
+	uint16_t dstOffset;
+	uint8_t dstFormat;
+	uint16_t width;
+	uint16_t height;
+	// ARGB8888 color of a fill, it is converted to the destination format, or the RGB color of a source in the A8 or A4 format
+	uint32_t color;
+	// called from the interrupt (with interrupts disabled) when the job is done, can be NULL
+	void (*pDone)(void);
+};
+
+void initDMA2D(void);
+uint8_t addDMA2DJob(const struct dma2dJob* pJob);
+void serviceDMA2D(void);
+void waitDMA2D(void);
+uint32_t getLastDMA2DJob(void);
+uint8_t isDMA2DJobDone(uint32_t job);
+void waitDMA2DJob(uint32_t job);
+uint32_t getDMA2DErrors(void);
+
+#endif /* DMA2D_FUNCTIONS_H_ */
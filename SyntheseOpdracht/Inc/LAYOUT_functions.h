@@ -0,0 +1,41 @@
+/*!
+ *  \file LAYOUT_functions.h
+ *	\details This file contains the function prototypes of the text layout. A UTF-8 text is broken into lines (spans of the text) in one pass, the text itself
+ *			 isn't copied, so the text renderer (TEXT_functions.c) can draw any line again when the text scrolls.
+ */
+#ifndef LAYOUT_FUNCTIONS_H_
+#define LAYOUT_FUNCTIONS_H_
+#include "main.h"
+
+// the code point that is returned for invalid UTF-8
+#define UTF8_INVALID_CHAR 0xFFFD
+// the maximum amount of lines of a text, the rest of the text isn't laid out
+#define TEXT_LAYOUT_MAX_LINES 256
+
+// one line of a text
+struct textSpan
+{
+	// offset of the first byte of the line in the text
+	uint16_t start;
+	// amount of bytes of the line, without the space or newline where the text is broken
+	uint16_t length;
+	// amount of characters (code points) of the line
+	uint16_t chars;
+	// 1 when a word is broken because it is longer than a line, a '-' is drawn after the characters
+	uint8_t hyphen;
+};
+
+struct textLayout
+{
+	const char* pText;
+	uint16_t textLength;
+	uint16_t lineAmount;
+	// 1 when the text has more than TEXT_LAYOUT_MAX_LINES lines
+	uint8_t truncated;
+	struct textSpan lines[TEXT_LAYOUT_MAX_LINES];
+};
+
+uint32_t decodeUTF8(const char** ppText, const char* pEnd);
+uint16_t layoutText(struct textLayout* pLayout, const char* pText, uint16_t length, uint16_t charsOnLine);
+
+#endif /* LAYOUT_FUNCTIONS_H_ */
@@ -13,6 +13,20 @@
 
 // include filesystemAPI to use its variables
 #include "fileSystemAPI.h"
+// the LCD is drawn with the DMA2D job queue
+#include "DMA2D_functions.h"
+// decoder of compressed frames
+#include "RLE_functions.h"
+// the frames are drawn from the SDRAM
+#include "CACHE_functions.h"
+// the text is drawn from a glyph atlas
+#include "TEXT_functions.h"
+// a picture that doesn't fit in the picture area is scaled
+#include "SCALE_functions.h"
+// a new picture replaces the previous one with a transition
+#include "TRANSITION_functions.h"
+// the layout of the LCD is a list of widgets that are repainted when they change
+#include "WIDGET_functions.h"
 
 // define lcd dimensions
 #define LCD_WIDTH 480
@@ -20,26 +34,148 @@
 
 // define the length of the buffer of the string thats going to be displayed
 #define TEXT_BUFFER_LENGTH 300
+// textToLCD keeps a copy of the text to scroll it, a longer text is cut off
+#define TEXT_MAX_LENGTH 2048
+// the text is drawn in the left half of the screen, the area between the margins is the text window
+#define TEXT_X 5
+#define TEXT_Y 10
+#define TEXT_WINDOW_WIDTH (LCD_WIDTH/2-1)
+#define TEXT_WINDOW_HEIGHT (LCD_HEIGHT-2*TEXT_Y-STATUS_BAR_HEIGHT)
+// the status bar under the text window holds the default widgets: the picture widget "icon" (STATUS_BAR_HEIGHT square) and the label "status" next to it
+#define STATUS_BAR_HEIGHT 32
+#define STATUS_BAR_Y (LCD_HEIGHT-STATUS_BAR_HEIGHT)
+// the pictures and gifs are centered in the picture area in the right half of the screen, a line of DIVIDER_WIDTH pixels separates it from the text
+#define PICTURE_X (LCD_WIDTH/2)
+#define PICTURE_Y 0
+#define PICTURE_WIDTH MAX_IMAGE_WIDTH
+#define PICTURE_HEIGHT MAX_IMAGE_HEIGHT
+#define DIVIDER_WIDTH 1
+// a text that is higher than the text window scrolls up one pixel line every TEXT_SCROLL_INTERVAL ms,
+// it waits TEXT_SCROLL_PAUSE ms at the start and at the end before it starts again
+#define TEXT_SCROLL_INTERVAL 40
+#define TEXT_SCROLL_PAUSE 2000
 
 // time in ms it take for the screen to go dark after no more touches were detected
 #define SCREENSAVER_DELAY 20000
 
+// TIM2 counts at 100 MHz / FRAME_TIMER_PRESCALER (initLCD replaces the prescaler of MX_TIM2_Init), it is the timebase of the gif frames and measures their timing error.
+// At 1 MHz the 32 bit counter wraps after 71 minutes, deadlines are compared with (int32_t)(a - b)
+#define FRAME_TIMER_PRESCALER 100
+#define FRAME_TIMER_TICKS_PER_MS 1000
+
+// set to 1 to draw the pictures in a back buffer that is shown from the next vertical blanking on (tear free, no wait for vsync)
+// set to 0 to wait for vsync and draw directly in the shown framebuffer
+#define DOUBLE_BUFFER 1
+// size of one ARGB8888 framebuffer
+#define LCD_FRAME_BUFFER_SIZE (LCD_WIDTH*LCD_HEIGHT*4)
+// the back buffer of the foreground layer is placed after the framebuffer of the background layer
+#define LCD_BACK_BUFFER_ADDRESS (LCD_FB_START_ADDRESS+(2*LCD_FRAME_BUFFER_SIZE))
+// amount of framebuffers of the foreground layer, the area that isn't transparent is tracked for every buffer so a clear only fills that area
+#define LCD_BUFFER_AMOUNT (DOUBLE_BUFFER+1)
+// set to 1 to only copy the area of a gif frame that changed since the frame in the back buffer (the dirty rectangles of makefsdata -rawhdr), needs DOUBLE_BUFFER
+#define DELTA_FRAMES 1
+// the buffer doesn't hold a gif frame whose dirty rectangles can be used
+#define NO_GIF_FRAME 0xFFFF
+// set to 1 to show a picture (not a gif) with the background layer: the LTDC reads the picture data in a window of the size of the picture, no pixel is copied
+// the LTDC background color is shown around it, set to 0 to copy every picture into the foreground layer with the DMA2D
+#define LAYER_PICTURES 1
+// the layer that shows the pictures, the text and the gifs are drawn in the foreground layer above it
+#define PICTURE_LAYER 0
+// set to 1 to scale a picture (not a gif) in ARGB8888 or ARGB1555 that is smaller than the picture area up until it touches its sides, the aspect ratio is kept
+// a picture that is larger than the picture area is always scaled down, set to 0 to show a smaller picture as it is
+#define SCALE_PICTURES 1
+// scale_bilinear or scale_nearest (faster, blocky)
+#define SCALE_FILTER scale_bilinear
+// a scaled picture is streamed through SCALE_STRIPS strips of SCALE_STRIP_ROWS rows at the end of the SDRAM: the CPU scales a strip while the DMA2D copies the strip before it
+#define SCALE_STRIP_ROWS 16
+#define SCALE_STRIPS 2
+#define SCALE_STRIP_SIZE (MAX_IMAGE_WIDTH*SCALE_STRIP_ROWS*4)
+#define SCALE_BUFFER_ADDRESS (SDRAM_DEVICE_ADDR+SDRAM_DEVICE_SIZE-(SCALE_STRIPS*SCALE_STRIP_SIZE))
+// a picture (not a gif) replaces the previous one with a transition: every refresh of the LCD the DMA2D mixes the old and the new picture into the back buffer,
+// the steps are started from the LTDC line interrupt at the start of the vertical blanking, so the main loop doesn't wait for them
+// it needs DOUBLE_BUFFER, set to 0 to show a new picture at once. With LAYER_PICTURES the background layer takes the picture over after the transition
+#define PICTURE_TRANSITIONS DOUBLE_BUFFER
+// the transition and its time in ms after startup, setTransition changes them
+#define TRANSITION_TYPE transition_crossfade
+#define TRANSITION_TIME 400
+// priority of the LTDC interrupt, lower than the DMA2D interrupt. The line interrupt also counts the refreshes, the widgets are composed at most once per refresh
+#define LTDC_IRQ_PRIORITY 2
+// the old and the new picture of a transition are drawn in two buffers with the same layout as a framebuffer, before the scale buffer
+#define TRANSITION_FROM_ADDRESS (SCALE_BUFFER_ADDRESS-(PICTURE_TRANSITIONS*2*LCD_FRAME_BUFFER_SIZE))
+#define TRANSITION_TO_ADDRESS (TRANSITION_FROM_ADDRESS+LCD_FRAME_BUFFER_SIZE)
+// the SDRAM between the back buffer and the transition buffers is the frame cache, the frames are copied (compressed frames decoded) in it and drawn from there
+#define FRAME_CACHE_ADDRESS (LCD_BACK_BUFFER_ADDRESS+LCD_FRAME_BUFFER_SIZE)
+#define FRAME_CACHE_SIZE (TRANSITION_FROM_ADDRESS-FRAME_CACHE_ADDRESS)
+
+// set to 1 to measure how long the DMA2D needs to draw a frame with the cycle counter, printBlitTime prints the result and the frame cache counters on the serial terminal
+// the cycles the CPU needs to scale a picture are printed for every scaled picture, the render time of the steps after every transition
+#define MEASURE_BLIT_TIME 0
+// amount of frames that are measured before the result is printed
+#define BLIT_TIME_FRAMES 100
+
+// timing of the gif frames since startup, a timing error is the time between the deadline of a frame and the moment the DMA2D has drawn it
+struct frameStatistics
+{
+	uint32_t drawnFrames;
+	// frames that were drawn more than half a frame time after their deadline
+	uint32_t lateFrames;
+	// frames that were skipped because their time was already over
+	uint32_t droppedFrames;
+	uint32_t lastError_us;
+	uint32_t maxError_us;
+	uint32_t averageError_us;
+};
+
+// timing of the steps of the last transition, a step is rendered from the moment it is queued until the DMA2D has drawn it
+struct transitionStatistics
+{
+	uint32_t steps;
+	// refreshes of the LCD without a new step because the previous step wasn't drawn or shown yet
+	uint32_t missedRefreshes;
+	uint32_t lastStep_us;
+	uint32_t maxStep_us;
+	uint32_t averageStep_us;
+	// time between two line interrupts, a step has to be drawn within it
+	uint32_t refreshPeriod_us;
+};
+
 /* LCD Initialization for normal operation */
 void initLCD(void);
 /* prints text to the LCD */
-int textToLCD(char *textArray, int len, uint32_t color);
+int textToLCD(const char *textArray, int len, uint32_t color);
+/* scrolls a text that is higher than the text window, called from the main loop */
+void scrollText(void);
 /* prints picture to the LCD */
 uint8_t pictureToLCD(struct imageMetaData picture);
 /* clears previous text of the LCD */
 void clearText(void);
 /* clears previous picture of the LCD */
 void clearPicture(void);
+/* resolves the frames of the shown gif again when the file system catalog was rebuilt */
+void refreshPicture(void);
+/* draws the gif frame that is due, called from the main loop */
+void scheduleFrames(void);
+/* returns the timing of the gif frames */
+void getFrameStatistics(struct frameStatistics* pStatistics);
+/* lets the background layer take over the picture of a finished transition, called from the main loop */
+void finishTransition(void);
+/* repaints the widgets that changed, called from the main loop */
+void composeLCD(void);
+/* counts the refreshes and starts the next step of a transition, it is the LTDC interrupt handler */
+void serviceLTDC(void);
+#if PICTURE_TRANSITIONS
+/* chooses the transition between two pictures */
+void setTransition(transitionType type, uint16_t time_ms);
+/* returns the timing of the steps of the last transition */
+void getTransitionStatistics(struct transitionStatistics* pStatistics);
+#endif
+#if MEASURE_BLIT_TIME
+/* prints the average and maximum blit time once BLIT_TIME_FRAMES frames were drawn */
+void printBlitTime(void);
+#endif
 
 /* reads status of onboard blue button */
 uint8_t readButton(void);
 
-/* timer interrupt callback */
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim);
-
 
 #endif /* BSP_FUNCTIONS_H_ */
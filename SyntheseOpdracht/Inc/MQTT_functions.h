@@ -6,6 +6,9 @@
 #include "lwip.h"
 #include "mqtt.h"
 
+/* size of one published page of the image or gif list */
+#define MQTT_LIST_PAGE_LENGTH 250
+
 void mqtt_connection_cb(mqtt_client_t *, void *, mqtt_connection_status_t);
 void mqtt_sub_request_cb(void *, err_t);
 void mqtt_incoming_publish_cb(void *, const char *topic, u32_t);
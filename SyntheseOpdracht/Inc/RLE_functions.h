@@ -0,0 +1,13 @@
+/*!
+ *  \file RLE_functions.h
+ *	\details This file contains the function prototypes of the decoder for compressed .raw frames (RAW_COMPRESSION_RLE16, makefsdata switch -rawrle).
+ *			 A frame is decoded into the frame cache in the SDRAM (CACHE_functions.c), the DMA2D draws it from there like an uncompressed frame.
+ */
+#ifndef RLE_FUNCTIONS_H_
+#define RLE_FUNCTIONS_H_
+#include "main.h"
+#include "imageManifest.h"
+
+uint8_t decodeRLE16(const void* pSrc, uint32_t srcSize, uint16_t* pDst, uint32_t pixelAmount);
+
+#endif /* RLE_FUNCTIONS_H_ */
@@ -0,0 +1,47 @@
+/*!
+ *  \file SCALE_functions.h
+ *	\details This file contains the function prototypes of the image scaler. A picture in ARGB8888 or ARGB1555 is scaled a few rows at a time,
+ *			 so the rows can be streamed through a small buffer while the DMA2D copies the rows before them to the LCD.
+ */
+#ifndef SCALE_FUNCTIONS_H_
+#define SCALE_FUNCTIONS_H_
+#include "main.h"
+#include "imageManifest.h"
+
+// the maximum width of a scaled image, the size of the column tables of a scaleJob
+#define SCALE_MAX_WIDTH 480
+
+// how the pixels of the scaled image are calculated
+typedef enum {scale_nearest, scale_bilinear} scaleFilter;
+
+/*!
+ * \struct scaleJob
+ * One image that is being scaled. The source position of every column is calculated once by initScaleJob, the rows are calculated by scaleRows.
+ * \remark The positions are 16.16 fixed point, the centers of the scaled pixels are mapped on the source image.
+ */
+struct scaleJob
+{
+	const void* pSrc;
+	uint16_t srcWidth;
+	uint16_t srcHeight;
+	// RAW_FORMAT_ARGB8888 or RAW_FORMAT_ARGB1555, the scaled image has the same format
+	uint8_t pixelFormat;
+	scaleFilter filter;
+	uint16_t dstWidth;
+	uint16_t dstHeight;
+	// the row of the scaled image that scaleRows calculates next
+	uint16_t nextRow;
+	// distance between the source positions of 2 scaled rows and the source position of row 0
+	int32_t yStep;
+	int32_t yStart;
+	// the (first) source column of every scaled column
+	uint16_t columns[SCALE_MAX_WIDTH];
+	// bilinear: the weight of the source column after it, 0 up to 256
+	uint16_t weights[SCALE_MAX_WIDTH];
+};
+
+uint8_t initScaleJob(struct scaleJob* pJob, const void* pSrc, uint16_t srcWidth, uint16_t srcHeight, uint8_t pixelFormat, uint16_t dstWidth, uint16_t dstHeight, scaleFilter filter);
+uint16_t scaleRows(struct scaleJob* pJob, void* pDst, uint16_t rowAmount);
+void fitImageSize(uint16_t width, uint16_t height, uint16_t maxWidth, uint16_t maxHeight, uint16_t* pWidth, uint16_t* pHeight);
+
+#endif /* SCALE_FUNCTIONS_H_ */
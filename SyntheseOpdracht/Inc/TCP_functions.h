@@ -29,12 +29,18 @@
  *  MAX_LENGTH_WELCOME_MESSAGE sets the maximum length of the welcome message, to make it easier to initialize the string
  */
 #define MAX_LENGTH_WELCOME_MESSAGE 500
+/*!
+ *  \def IMAGE_LIST_PAGE_SIZE
+ *  IMAGE_LIST_PAGE_SIZE sets how many lines of the image list ('l' command) are sent with one tcp_write
+ */
+#define IMAGE_LIST_PAGE_SIZE 4
 
 
 int init_TCP(void);
 err_t handle_incoming_connection(void* , struct tcp_pcb *, err_t);
 err_t handle_incoming_message(void *, struct tcp_pcb *,struct pbuf *, err_t);
 err_t succesful_send(void*, struct tcp_pcb *, u16_t );
+void send_image_list_pages(struct tcp_pcb *);
 int handle_command(char*,int,struct tcp_pcb *);
 
 #endif /* INC_TCP_FUNCTIONS_H_ */
@@ -0,0 +1,37 @@
+/*!
+ *  \file TEXT_functions.h
+ *	\details This file contains the function prototypes of the text renderer. A font of the BSP is expanded once into an A8 glyph atlas, a line of text is
+ *			 put together from the atlas by the CPU and drawn by the DMA2D with one fill (background color) and one blend (text color), instead of pixel per pixel.
+ */
+#ifndef TEXT_FUNCTIONS_H_
+#define TEXT_FUNCTIONS_H_
+#include <string.h>
+#include "main.h"
+#include "stm32746g_discovery_lcd.h"
+#include "DMA2D_functions.h"
+#include "LAYOUT_functions.h"
+
+// the atlas holds the printable ASCII characters, the accented Latin-1 letters are drawn without accent and the other characters as TEXT_UNKNOWN_CHAR
+#define TEXT_FIRST_CHAR ' '
+#define TEXT_LAST_CHAR '~'
+#define TEXT_UNKNOWN_CHAR '?'
+#define TEXT_CHAR_AMOUNT (TEXT_LAST_CHAR - TEXT_FIRST_CHAR + 1)
+
+/*!
+ * \def TEXT_ATLAS_SIZE
+ * The size of the atlas in bytes, one byte per pixel. It is large enough for Font12 (7x12), the font of textToLCD.
+ */
+#define TEXT_ATLAS_SIZE (TEXT_CHAR_AMOUNT*7*12)
+// the widest line that can be drawn in pixels and the highest font
+#define TEXT_LINE_MAX_WIDTH 480
+#define TEXT_LINE_MAX_HEIGHT 12
+// a line is put together in one buffer while the DMA2D draws the previous line from the other one
+#define TEXT_LINE_BUFFERS 2
+
+uint8_t initTextAtlas(const sFONT* pFont);
+uint16_t drawTextLine(uint16_t x, uint16_t y, const char* pText, uint16_t length, uint32_t textColor, uint32_t backColor);
+uint16_t drawTextLinePart(uint16_t x, uint16_t y, const char* pText, uint16_t length, uint16_t firstRow, uint16_t rowAmount, uint32_t textColor, uint32_t backColor);
+uint16_t getTextLineHeight(void);
+uint16_t getTextCharWidth(void);
+
+#endif /* TEXT_FUNCTIONS_H_ */
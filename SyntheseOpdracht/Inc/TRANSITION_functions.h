@@ -0,0 +1,23 @@
+/*!
+ *  \file TRANSITION_functions.h
+ *	\details This file contains the function prototypes of the picture transitions. A step of a transition is a few DMA2D jobs that mix the old and the new picture
+ *			 into a framebuffer: a blend for a crossfade, two copies for a wipe or a slide.
+ */
+#ifndef TRANSITION_FUNCTIONS_H_
+#define TRANSITION_FUNCTIONS_H_
+#include "main.h"
+#include "DMA2D_functions.h"
+
+// the progress of a transition goes from 0 (only the old picture) up to TRANSITION_PROGRESS_END (only the new picture)
+#define TRANSITION_PROGRESS_END 256
+// the maximum amount of DMA2D jobs of one step
+#define TRANSITION_MAX_JOBS 2
+
+// crossfade: the new picture fades in over the old one, wipe: the new picture covers the old one from left to right,
+// slide: the new picture pushes the old one out to the left
+typedef enum {transition_none, transition_crossfade, transition_wipe, transition_slide} transitionType;
+
+uint16_t getTransitionProgress(uint32_t elapsed, uint32_t duration);
+uint8_t getTransitionJobs(transitionType type, uint16_t progress, const uint32_t* pFrom, const uint32_t* pTo, uint32_t* pDst, uint16_t width, uint16_t height, uint16_t lineLength, struct dma2dJob* pJobs);
+
+#endif /* TRANSITION_FUNCTIONS_H_ */
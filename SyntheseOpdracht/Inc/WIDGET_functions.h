@@ -0,0 +1,72 @@
+/*!
+ *  \file WIDGET_functions.h
+ *	\details This file contains the function prototypes of the widget compositor. The layout of the LCD is a list of widgets: areas with a z-order and a content
+ *			 (a color, a line of text or a picture) that is kept by the compositor. A change only marks the widget dirty, composeWidgets repaints the areas of
+ *			 the dirty widgets with the DMA2D, with every widget that overlaps them in z-order.
+ */
+#ifndef WIDGET_FUNCTIONS_H_
+#define WIDGET_FUNCTIONS_H_
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "stm32746g_discovery_lcd.h"
+#include "fileSystemAPI.h"
+#include "DMA2D_functions.h"
+#include "CACHE_functions.h"
+#include "TEXT_functions.h"
+
+// the maximum amount of widgets, including the zones
+#define WIDGET_MAX_AMOUNT 16
+// the size of the name (with the null character) and the maximum length of the text of a label, in bytes
+#define WIDGET_NAME_LENGTH 16
+#define WIDGET_TEXT_LENGTH 64
+// the maximum amount of areas composeWidgets repaints: the old and new area of every dirty widget or the area of a widget that overlaps them
+#define WIDGET_MAX_AREAS (3*WIDGET_MAX_AMOUNT)
+// returned by createWidget and findWidget when there is no widget
+#define NO_WIDGET 0xFF
+
+// fill: an area of one color, label: one line of text on a background color, picture: a picture (not a gif) centered in the area and cut off when it is larger,
+// zone: an area that the LCD functions draw in themselves (the text window and the picture area), it is never painted and no widget can overlap it
+typedef enum {widget_fill, widget_label, widget_picture, widget_zone} widgetType;
+
+/*!
+ * \struct widget
+ * One widget of the layout. A widget with a higher z is drawn over the widgets with a lower z, widgets with the same z are drawn in the order they were created.
+ * \remark shownArea is the area the widget was last composed in, it is repainted as well when the widget moves, is hidden or is deleted.
+ */
+struct widget
+{
+	// 1 when the widget exists, a deleted widget stays dirty until its area is repainted
+	uint8_t used;
+	uint8_t visible;
+	uint8_t dirty;
+	uint8_t z;
+	widgetType type;
+	char name[WIDGET_NAME_LENGTH];
+	struct rawDirtyRect area;
+	struct rawDirtyRect shownArea;
+	// fill: the color of the area, label: the color of the text
+	uint32_t color;
+	// label and picture: the color of the area under the text or picture, a label always replaces the widgets under it, a picture only when the color isn't transparent
+	uint32_t backColor;
+	char text[WIDGET_TEXT_LENGTH];
+	uint16_t textLength;
+	struct imageMetaData picture;
+};
+
+uint8_t createWidget(widgetType type, const char* pName, uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t z);
+uint8_t deleteWidget(uint8_t widget);
+uint8_t findWidget(const char* pName, uint16_t nameLength);
+uint8_t moveWidget(uint8_t widget, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+uint8_t setWidgetOrder(uint8_t widget, uint8_t z);
+uint8_t setWidgetVisible(uint8_t widget, uint8_t visible);
+uint8_t setWidgetColor(uint8_t widget, uint32_t color, uint32_t backColor);
+uint8_t setWidgetText(uint8_t widget, const char* pText, uint16_t length);
+uint8_t setWidgetPicture(uint8_t widget, const struct imageMetaData* pPicture);
+uint8_t updateWidget(const char* pName, uint16_t nameLength, const char* pContent, uint16_t contentLength);
+uint8_t widgetCommand(const char* pCommand, uint16_t length);
+uint8_t widgetsDirty(void);
+uint8_t composeWidgets(struct rawDirtyRect* pAreas);
+
+#endif /* WIDGET_FUNCTIONS_H_ */
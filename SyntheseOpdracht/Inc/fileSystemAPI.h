@@ -8,6 +8,7 @@
 #define FILESYSTEMAPI_H_
 #include "main.h"
 #include "lwip/apps/fs.h"
+#include "imageManifest.h"
 
 /*!
  * \def MAX_PATH_LENGTH
@@ -18,17 +19,24 @@
 #define MAX_IMAGE_WIDTH 240
 #define MIN_IMAGE_HEIGHT 1
 #define MAX_IMAGE_HEIGHT 272
+// a picture (frame time 0) in ARGB8888 or ARGB1555 that isn't compressed can be larger than MAX_IMAGE_WIDTH x MAX_IMAGE_HEIGHT, the LCD scales it down
+#define MAX_SCALED_IMAGE_WIDTH 1024
+#define MAX_SCALED_IMAGE_HEIGHT 1024
 
+// the size of the list getGifFrames fills, a gif itself can have up to 65535 frames (see getGifFrameData)
 #define MAX_GIF_FRAMES 255
 
-struct imageMetaData{
-	char* name;
-    void* data;
-    uint16_t width;
-    uint16_t height;
-    uint8_t num;
-    uint16_t frameTime;
-};
+/*!
+ * \def RAW_HEADER_VERIFY_CHECKSUM
+ * When RAW_HEADER_VERIFY_CHECKSUM is 1, the checksum of every .raw file with a header is verified while the catalog is built. This reads all frames once, so it slows down initFileSystemAPI.
+ */
+#define RAW_HEADER_VERIFY_CHECKSUM 0
+
+/*!
+ * \def CATALOG_SNAPSHOT_AMOUNT
+ * The catalog is double buffered: initFileSystemAPI builds a new catalog next to the published one, so it can be rebuilt while animations keep reading the published one.
+ */
+#define CATALOG_SNAPSHOT_AMOUNT 2
 
 typedef enum {png, gif} fileExtension;
 typedef enum {ext, no_ext} extensionType;
@@ -36,13 +44,41 @@ typedef enum {lower, upper, initial} caseType;
 typedef enum {a_z, z_a, no_sort} sortType;
 typedef enum {stop_at_ext, stop_at_args, stop_at_any} pathStopType;
 
-uint8_t getImageList(char* imageList[], fileExtension extType, sortType sortState);
+// One published version of the catalog, its content is only used inside the API.
+struct catalogSnapshot;
+
+/*!
+ * \struct imageCursor
+ * An imageCursor walks through the sorted catalog without copying it. It is opened with openImageCursor and read with getNextImage or getImagePage.
+ * \remark A cursor reads the catalog that was published when it was opened. It stays valid until initFileSystemAPI has published two newer catalogs, or as long as that catalog is acquired.
+ */
+struct imageCursor
+{
+	const struct catalogEntry* pEntries;
+	uint16_t firstIndex;
+	uint16_t endIndex;
+	uint16_t position;
+	sortType sortState;
+};
+
+uint16_t getImageList(char* imageList[], fileExtension extType, sortType sortState);
 uint8_t getRawImageMetaData(char* imagePath, uint16_t pathLength, struct imageMetaData* pMetaData);
+uint8_t findImageByName(char* pName, uint16_t nameLength, fileExtension extType, struct imageMetaData* pMetaData);
 uint8_t initFileSystemAPI(void);
-uint8_t getImageAmount(void);
+struct catalogSnapshot* acquireCatalog(void);
+void releaseCatalog(struct catalogSnapshot* pCatalog);
+uint32_t getCatalogVersion(void);
+uint16_t getImageAmount(void);
 uint8_t getLargestNameLength(void);
 void extractNameOutOfPath(char* pPath, uint16_t pathLength, char* pName, extensionType nameState, caseType caseState);
-uint8_t getGifFrames(char* pGif, uint16_t pathLength, char* frameList[]);
-uint8_t getGifAmount(void);
+uint16_t getGifFrames(char* pGif, uint16_t pathLength, char* frameList[]);
+uint16_t getGifFrameData(char* pGifPath, uint16_t pathLength, const struct imageMetaData** pFrames);
+uint16_t getGifAmount(void);
+uint8_t getRawBitsPerPixel(uint8_t pixelFormat);
+uint16_t getRawClutEntries(uint8_t pixelFormat);
+uint16_t openImageCursor(struct imageCursor* pCursor, fileExtension extType, sortType sortState, char* pPrefix, uint16_t prefixLength);
+void seekImageCursor(struct imageCursor* pCursor, uint16_t offset);
+char* getNextImage(struct imageCursor* pCursor);
+uint16_t getImagePage(struct imageCursor* pCursor, char* imageList[], uint16_t limit);
 
 #endif /* FILESYSTEMAPI_H_ */
@@ -0,0 +1,135 @@
+/*!
+ *  \file imageManifest.h
+ *	\details This file contains the types of the image catalog that is used by the filesystem API.
+ *  		 The catalog is built at runtime by initFileSystemAPI, or generated at build time by makefsdata (switch -img) as image manifest in fsdata_custom.c.
+ *  \remark This header only uses standard types, because it is also included by the generated fsdata_custom.c.
+ */
+#ifndef IMAGEMANIFEST_H_
+#define IMAGEMANIFEST_H_
+#include <stdint.h>
+
+/*!
+ * \def RAW_HEADER_MAGIC
+ * RAW_HEADER_MAGIC are the first 4 bytes ("RAW1") of a .raw file that starts with a rawImageHeader. (Little endian)
+ */
+#define RAW_HEADER_MAGIC 0x31574152u
+
+// Pixel formats of a .raw file. The values are equal to the DMA2D input color modes (DMA2D_INPUT_xxx), so they can be passed to the DMA2D directly.
+#define RAW_FORMAT_ARGB8888 0x00u
+#define RAW_FORMAT_RGB888 0x01u
+#define RAW_FORMAT_RGB565 0x02u
+#define RAW_FORMAT_ARGB1555 0x03u
+#define RAW_FORMAT_ARGB4444 0x04u
+#define RAW_FORMAT_L8 0x05u
+#define RAW_FORMAT_AL44 0x06u
+#define RAW_FORMAT_AL88 0x07u
+#define RAW_FORMAT_L4 0x08u
+#define RAW_FORMAT_A8 0x09u
+#define RAW_FORMAT_A4 0x0Au
+
+// Compression of the pixel data of a .raw file (rawImageHeader.compression).
+#define RAW_COMPRESSION_NONE 0x00u
+/*!
+ * \def RAW_COMPRESSION_RLE16
+ * Run length encoding of 16 bit pixels (ARGB1555, RGB565, ARGB4444). The data is a list of 16 bit packets: a token followed by its pixels.
+ * Bit 15 of the token is RLE16_RUN_FLAG, bits 0..14 are the amount of pixels - 1. A run is followed by one pixel that is repeated, a literal by all its pixels.
+ */
+#define RAW_COMPRESSION_RLE16 0x01u
+#define RLE16_RUN_FLAG 0x8000u
+#define RLE16_COUNT_MASK 0x7FFFu
+
+/*!
+ * \struct rawImageHeader
+ * The binary header at the start of a .raw file, written by makefsdata (switch -rawhdr). The pixel data follows the header (headerSize bytes after the start of the file).
+ * The payload is payloadSize bytes, compressed with RAW_COMPRESSION_xxx (header version 3, makefsdata switch -rawrle). The checksum is calculated over the payload as it is stored.
+ * A frame in a CLUT format (L8, AL44, AL88, L4) has clutSize ARGB8888 CLUT entries after the rawDirtyRect (header version 4, makefsdata switch -rawclut).
+ * All fields are little endian and naturally aligned, so the header can be read with one struct load.
+ * \remark The layout HAS to match the header that makefsdata writes.
+ */
+struct rawImageHeader{
+	uint32_t magic;
+	uint8_t version;
+	uint8_t pixelFormat;
+	uint16_t headerSize;
+	uint16_t width;
+	uint16_t height;
+	uint16_t stride;
+	uint16_t frameTime;
+	uint16_t frameNumber;
+	uint16_t frameCount;
+	uint32_t payloadSize;
+	uint32_t checksum;
+	uint8_t compression;
+	uint8_t reserved;
+	uint16_t clutSize;
+};
+
+/*!
+ * \struct rawDirtyRect
+ * The area of a frame that changed since the previous frame of the gif (for frame 1: the last frame, because a gif loops).
+ * A header of version 2 (RAW_HEADER_DIRTY_VERSION) is followed by this rectangle. A width of 0 means the frame is equal to the previous one.
+ */
+struct rawDirtyRect{
+	uint16_t x;
+	uint16_t y;
+	uint16_t width;
+	uint16_t height;
+};
+
+/*!
+ * \def RAW_HEADER_DIRTY_VERSION
+ * The first header version that contains a rawDirtyRect after the rawImageHeader.
+ */
+#define RAW_HEADER_DIRTY_VERSION 2
+
+/*!
+ * \def RAW_HEADER_CLUT_VERSION
+ * The first header version that contains the CLUT of a frame in a CLUT format after the rawDirtyRect.
+ */
+#define RAW_HEADER_CLUT_VERSION 4
+
+struct imageMetaData{
+	char* name;
+    void* data;
+    uint16_t width;
+    uint16_t height;
+    uint16_t num;
+    uint16_t frameTime;
+    uint8_t pixelFormat;
+    // area that changed since the previous frame, the whole frame when the .raw file has no dirty rectangle
+    struct rawDirtyRect dirty;
+    // RAW_COMPRESSION_xxx of the data and its size in bytes, a compressed frame has to be decoded before it is drawn
+    uint8_t compression;
+    uint32_t dataSize;
+    // ARGB8888 CLUT of a frame in a CLUT format, NULL for the other formats
+    const uint32_t* clut;
+    uint16_t clutSize;
+};
+
+/*!
+ * \struct catalogEntry
+ * A catalogEntry describes one valid .png or .gif file and the range of its .raw frames inside the frame table.
+ */
+struct catalogEntry{
+	char* path;
+	uint16_t nameOffset;
+	uint16_t baseLength;
+	uint16_t firstFrame;
+	uint16_t frameAmount;
+};
+
+/*!
+ * \struct imageManifest
+ * The complete catalog: images and gifs sorted a_z on their name, frames sorted on their path without arguments and then on frame number.
+ */
+struct imageManifest{
+	const struct catalogEntry* images;
+	uint16_t imageAmount;
+	const struct catalogEntry* gifs;
+	uint16_t gifAmount;
+	const struct imageMetaData* frames;
+	uint16_t frameAmount;
+	uint8_t largestNameLength;
+};
+
+#endif /* IMAGEMANIFEST_H_ */
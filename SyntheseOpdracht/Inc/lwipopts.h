@@ -113,6 +113,8 @@
 #define CHECKSUM_CHECK_ICMP6 0
 /*-----------------------------------------------------------------------------*/
 /* USER CODE BEGIN 1 */
+/* The photo SSI tag is inserted page by page, so the amount of images is not limited by LWIP_HTTPD_MAX_TAG_INSERT_LEN */
+#define LWIP_HTTPD_SSI_MULTIPART 1
 
 /* USER CODE END 1 */
 
@@ -50,8 +50,9 @@
 void SVC_Handler(void);
 void PendSV_Handler(void);
 void SysTick_Handler(void);
-void TIM2_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void DMA2D_IRQHandler(void);
+void LTDC_IRQHandler(void);
 
 /* USER CODE END EFP */
 
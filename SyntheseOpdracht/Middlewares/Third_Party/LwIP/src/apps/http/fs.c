@@ -52,6 +52,26 @@ int fs_read_custom(struct fs_file *file, char *buffer, int count);
 #endif /* LWIP_HTTPD_FS_ASYNC_READ */
 #endif /* LWIP_HTTPD_CUSTOM_FILES */
 
+/*-----------------------------------------------------------------------------------*/
+static void
+fs_fill_file(struct fs_file *file, const struct fsdata_file *f, const char *name)
+{
+  file->data = (const char *)f->data;
+  file->len = f->len;
+  file->index = f->len;
+  file->pextension = NULL;
+  file->flags = f->flags;
+#if HTTPD_PRECALCULATED_CHECKSUM
+  file->chksum_count = f->chksum_count;
+  file->chksum = f->chksum;
+#endif /* HTTPD_PRECALCULATED_CHECKSUM */
+#if LWIP_HTTPD_FILE_STATE
+  file->state = fs_state_init(file, name);
+#else /* LWIP_HTTPD_FILE_STATE */
+  LWIP_UNUSED_ARG(name);
+#endif /* #if LWIP_HTTPD_FILE_STATE */
+}
+
 /*-----------------------------------------------------------------------------------*/
 err_t
 fs_open(struct fs_file *file, const char *name)
@@ -70,23 +90,33 @@ fs_open(struct fs_file *file, const char *name)
   file->is_custom_file = 0;
 #endif /* LWIP_HTTPD_CUSTOM_FILES */
 
+#ifdef FS_SORTED_FILES
+  {
+    /* makefsdata generated a file table sorted with strcmp: binary search it */
+    int low = 0;
+    int high = FS_NUMFILES;
+    while (low < high) {
+      int middle = low + ((high - low) / 2);
+      int cmp = strcmp(name, (const char *)FS_SORTED_FILES[middle]->name);
+      if (cmp == 0) {
+        fs_fill_file(file, FS_SORTED_FILES[middle], name);
+        return ERR_OK;
+      } else if (cmp < 0) {
+        high = middle;
+      } else {
+        low = middle + 1;
+      }
+    }
+  }
+  LWIP_UNUSED_ARG(f);
+#else /* FS_SORTED_FILES */
   for (f = FS_ROOT; f != NULL; f = f->next) {
     if (!strcmp(name, (const char *)f->name)) {
-      file->data = (const char *)f->data;
-      file->len = f->len;
-      file->index = f->len;
-      file->pextension = NULL;
-      file->flags = f->flags;
-#if HTTPD_PRECALCULATED_CHECKSUM
-      file->chksum_count = f->chksum_count;
-      file->chksum = f->chksum;
-#endif /* HTTPD_PRECALCULATED_CHECKSUM */
-#if LWIP_HTTPD_FILE_STATE
-      file->state = fs_state_init(file, name);
-#endif /* #if LWIP_HTTPD_FILE_STATE */
+      fs_fill_file(file, f, name);
       return ERR_OK;
     }
   }
+#endif /* FS_SORTED_FILES */
   /* file not found */
   return ERR_VAL;
 }
@@ -1,3 +1,3 @@
-makefsdata.exe .\files -f:..\Inc\fsdata_custom.c -x:txt -xc:raw -defl -xh:raw
+makefsdata.exe .\files -f:..\Inc\fsdata_custom.c -x:txt -xc:raw -defl -xh:raw -img -rawrle -rawclut -layout
 REM makefsdata.exe -? 
 pause
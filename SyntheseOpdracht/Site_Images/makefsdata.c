@@ -104,6 +104,12 @@ char serverIDBuffer[1024];
 #define PAYLOAD_ALIGN_TYPE "unsigned int"
 static int payload_alingment_dummy_counter = 0;
 
+/* QSPI layout (-layout): every .raw file gets its own section .ExtQSPIFlashSection.<path without args>.<frame number>.
+ * The linker script sorts these sections on name (SORT_BY_NAME), so all frames of one animation are placed next to each other
+ * in play order and the QSPI prefetcher and DMA2D can read them sequentially. Their payload is aligned to a cache line. */
+#define QSPI_SECTION          ".ExtQSPIFlashSection"
+#define LAYOUT_ALIGNMENT      32
+
 #define HEX_BYTES_PER_LINE 16
 
 #define MAX_PATH_LEN 256
@@ -111,6 +117,86 @@ static int payload_alingment_dummy_counter = 0;
 struct file_entry {
   struct file_entry *next;
   const char *filename_c;
+  const char *qualified_name;
+};
+
+/* Image manifest (-img): the image syntax /Folder/Name#NUM#WIDTHxHEIGHT@TIME.raw is parsed here
+ * at build time instead of at runtime by the file system API.
+ * The limits HAVE to match the ones in fileSystemAPI.h. */
+#define IMG_MIN_WIDTH  1
+#define IMG_MAX_WIDTH  240
+#define IMG_MIN_HEIGHT 1
+#define IMG_MAX_HEIGHT 272
+/* a picture (TIME 0) can be larger, the LCD scales it down (MAX_SCALED_IMAGE_WIDTH/HEIGHT) */
+#define IMG_MAX_SCALED_WIDTH  1024
+#define IMG_MAX_SCALED_HEIGHT 1024
+
+typedef enum {img_other, img_png, img_gif, img_raw} img_kind;
+
+/* Binary header of a .raw file (-rawhdr), all fields little endian.
+ * The layout HAS to match struct rawImageHeader in imageManifest.h:
+ * u32 magic, u8 version, u8 pixelFormat, u16 headerSize, u16 width, u16 height, u16 stride,
+ * u16 frameTime, u16 frameNumber, u16 frameCount, u32 payloadSize, u32 checksum (CRC-32 of the payload), u32 reserved
+ * Version 2 adds struct rawDirtyRect: u16 x, u16 y, u16 width, u16 height of the pixels that changed since the previous frame
+ * Version 3 uses the first reserved byte as compression (-rawrle), payloadSize and checksum are those of the stored (compressed) payload
+ * Version 4 uses the last reserved u16 as clutSize: a frame in a CLUT format (-rawclut) has clutSize u32 ARGB8888 entries after the dirty rect */
+#define RAW_HEADER_MAGIC      0x31574152UL /* "RAW1" */
+#define RAW_HEADER_VERSION    4
+#define RAW_HEADER_DIRTY_VERSION 2
+#define RAW_HEADER_CLUT_VERSION 4
+#define RAW_HEADER_SIZE       40
+#define RAW_HEADER_V1_SIZE    32
+#define RAW_COMPRESSION_NONE  0x00
+#define RAW_COMPRESSION_RLE16 0x01 /* packets of a u16 token (bit 15 run, bits 0..14 count - 1) and 1 (run) or count (literal) pixels */
+#define RLE16_RUN_FLAG        0x8000
+#define RLE16_MAX_COUNT       0x8000
+#define RLE16_MIN_RUN         3 /* a run of 2 pixels in a literal costs more than it saves */
+#define RAW_FORMAT_ARGB1555   0x03 /* equal to DMA2D_INPUT_ARGB1555 */
+#define RAW_FORMAT_L8         0x05 /* equal to DMA2D_INPUT_L8 */
+#define RAW_FORMAT_L4         0x08 /* equal to DMA2D_INPUT_L4 */
+#define RAW_CLUT_MAX          256 /* entries of an L8 CLUT */
+#define RAW_CLUT_L4_MAX       16 /* entries of an L4 CLUT */
+#define RAW_ARGB1555_COLORS   0x10000
+
+struct img_entry {
+  struct img_entry *next;
+  const char *filename_c;
+  char *qualified_name;
+  int payload_offset;
+  img_kind kind;
+  size_t name_offset;
+  size_t base_len;
+  int num;
+  int width;
+  int height;
+  int frame_time;
+  int pixel_format;
+  int dirty_x;
+  int dirty_y;
+  int dirty_width;
+  int dirty_height;
+  int compression;
+  int data_size;
+  u32_t *clut;
+  int clut_size;
+  int clut_offset;
+  int first_frame;
+  int frame_amount;
+};
+
+/* Palette of all frames of an image or gif (-rawclut) */
+struct raw_color {
+  u16_t color;
+  u32_t count;
+};
+struct raw_palette {
+  char key[MAX_PATH_LEN * 2]; /* working directory and path without arguments */
+  int width;
+  int height;
+  int size;
+  int exact; /* 1 when every color of the frames is in the CLUT */
+  u32_t clut[RAW_CLUT_MAX];
+  u8_t index[RAW_ARGB1555_COLORS]; /* CLUT index of every ARGB1555 color */
 };
 
 int process_sub(FILE *data_file, FILE *struct_file);
@@ -127,6 +213,11 @@ static int file_to_exclude(const char* filename);
 static int file_to_exclude_http_header(const char* filename);
 static int file_can_be_compressed(const char* filename);
 static void strToLower(char* str, int len);
+static void write_sorted_file_table(FILE *struct_file);
+static void register_image(const char *qualifiedName, int payload_offset, const u8_t *file_data, int file_size);
+static u8_t *add_raw_header(const char *filename, u8_t *file_data, int *file_size);
+static void write_image_manifest(FILE *struct_file);
+static int layout_section_name(const char *qualifiedName, char *section, size_t size);
 /* 5 bytes per char + 3 bytes per line */
 static char file_buffer_c[COPY_BUFSIZE * 5 + ((COPY_BUFSIZE / HEX_BYTES_PER_LINE) * 3)];
 
@@ -140,6 +231,14 @@ unsigned char useHttp11 = 0;
 unsigned char supportSsi = 1;
 unsigned char precalcChksum = 0;
 unsigned char includeLastModified = 0;
+unsigned char generateImageManifest = 0;
+unsigned char writeRawHeader = 0;
+unsigned char compressRaw = 0;
+unsigned char indexRaw = 0;
+static struct raw_palette raw_palette_cache;
+size_t rawBytesIn = 0;
+size_t rawBytesOut = 0;
+unsigned char qspiLayout = 0;
 #if MAKEFS_SUPPORT_DEFLATE
 unsigned char deflateNonSsiFiles = 0;
 size_t deflatedBytesReduced = 0;
@@ -150,6 +249,7 @@ const char *ncompress_list = NULL;
 const char *exclude_http_header_list = NULL;
 struct file_entry *first_file = NULL;
 struct file_entry *last_file = NULL;
+struct img_entry *first_img = NULL;
 
 static char *ssi_file_buffer;
 static char **ssi_file_lines;
@@ -176,6 +276,11 @@ static void print_usage(void)
   printf("                 ATTENTION: browser has to support \"Content-Encoding: deflate\"!" NEWLINE);
 #endif
   printf("   switch -xh: comma separated list of extensions of files to exclude the http header (e.g., -xh:raw) (lowercase)" NEWLINE);
+  printf("   switch -img: generate an image manifest for the file system API (parses Name#NUM#WIDTHxHEIGHT@TIME.raw)" NEWLINE);
+  printf("   switch -rawhdr: prepend a binary header (size, frame number, delay, pixel format, checksum) to .raw files named Name#NUM#WIDTHxHEIGHT@TIME.raw" NEWLINE);
+  printf("   switch -rawrle: like -rawhdr, and run length encode the 16 bit pixels of a .raw file when it gets smaller" NEWLINE);
+  printf("   switch -rawclut: like -rawhdr, and store a .raw file as L8 or L4 indexes in one CLUT per image or gif (more than 256 colors are reduced)" NEWLINE);
+  printf("   switch -layout: place the frames of every animation next to each other in play order, payload aligned to %d bytes (needs SORT_BY_NAME in the linker script)" NEWLINE, LAYOUT_ALIGNMENT);
   printf("   if targetdir not specified, htmlgen will attempt to" NEWLINE);
   printf("   process files in subdirectory 'fs'" NEWLINE);
 }
@@ -233,6 +338,23 @@ int main(int argc, char *argv[])
         printf("Writing to file \"%s\"\n", targetfile);
       } else if (!strcmp(argv[i], "-m")) {
         includeLastModified = 1;
+      } else if (!strcmp(argv[i], "-img")) {
+        generateImageManifest = 1;
+        printf("Generating image manifest" NEWLINE);
+      } else if (!strcmp(argv[i], "-rawhdr")) {
+        writeRawHeader = 1;
+        printf("Writing .raw headers" NEWLINE);
+      } else if (!strcmp(argv[i], "-rawrle")) {
+        writeRawHeader = 1;
+        compressRaw = 1;
+        printf("Writing .raw headers and compressing .raw files" NEWLINE);
+      } else if (!strcmp(argv[i], "-rawclut")) {
+        writeRawHeader = 1;
+        indexRaw = 1;
+        printf("Writing .raw headers and indexing .raw files" NEWLINE);
+      } else if (!strcmp(argv[i], "-layout")) {
+        qspiLayout = 1;
+        printf("Grouping .raw frames per animation in the QSPI layout" NEWLINE);
       } else if (!strcmp(argv[i], "-defl")) {
 #if MAKEFS_SUPPORT_DEFLATE
         char *colon = strstr(argv[i], ":");
@@ -344,6 +466,10 @@ int main(int argc, char *argv[])
   fprintf(struct_file, "const struct fsdata_file* const pFirstFile = file_%s;" NEWLINE, lastFileVar);
   fprintf(struct_file, "#define FS_ROOT file_%s" NEWLINE, lastFileVar);
   fprintf(struct_file, "#define FS_NUMFILES %d" NEWLINE NEWLINE, filesProcessed);
+  write_sorted_file_table(struct_file);
+  if (generateImageManifest) {
+    write_image_manifest(struct_file);
+  }
 
   fclose(data_file);
   fclose(struct_file);
@@ -362,6 +488,10 @@ int main(int argc, char *argv[])
   }
 
   printf(NEWLINE "Processed %d files - done." NEWLINE, filesProcessed);
+  if ((compressRaw || indexRaw) && (rawBytesIn != 0)) {
+    printf("(%s .raw byte reduction: %d bytes -> %d bytes (%.02f%%)" NEWLINE,
+           (compressRaw && indexRaw) ? "RLE16/CLUT" : (compressRaw ? "RLE16" : "CLUT"), (int)rawBytesIn, (int)rawBytesOut, (float)((rawBytesOut * 100.0) / rawBytesIn));
+  }
 #if MAKEFS_SUPPORT_DEFLATE
   if (deflateNonSsiFiles) {
     printf("(Deflated total byte reduction: %d bytes -> %d bytes (%.02f%%)" NEWLINE,
@@ -373,8 +503,16 @@ int main(int argc, char *argv[])
   while (first_file != NULL) {
     struct file_entry *fe = first_file;
     first_file = fe->next;
+    free((void *)fe->qualified_name);
     free(fe);
   }
+  while (first_img != NULL) {
+    struct img_entry *ie = first_img;
+    first_img = ie->next;
+    free(ie->qualified_name);
+    free(ie->clut);
+    free(ie);
+  }
 
   if (ssi_file_buffer) {
     free(ssi_file_buffer);
@@ -746,10 +884,11 @@ static void fix_filename_for_c(char *qualifiedName, size_t max_len)
   free(new_name);
 }
 
-static void register_filename(const char *qualifiedName)
+static void register_filename(const char *varname, const char *qualifiedName)
 {
   struct file_entry *fe = (struct file_entry *)malloc(sizeof(struct file_entry));
-  fe->filename_c = strdup(qualifiedName);
+  fe->filename_c = strdup(varname);
+  fe->qualified_name = strdup(qualifiedName);
   fe->next = NULL;
   if (first_file == NULL) {
     first_file = last_file = fe;
@@ -759,6 +898,906 @@ static void register_filename(const char *qualifiedName)
   }
 }
 
+static int compare_file_entries(const void *a, const void *b)
+{
+  const struct file_entry *fa = *(const struct file_entry * const *)a;
+  const struct file_entry *fb = *(const struct file_entry * const *)b;
+  return strcmp(fa->qualified_name, fb->qualified_name);
+}
+
+/** Write a table of all files sorted with strcmp on their name, so fs_open
+ * can binary search it instead of walking the linked list. */
+static void write_sorted_file_table(FILE *struct_file)
+{
+  struct file_entry *fe;
+  struct file_entry **sorted;
+  size_t num_files = 0;
+  size_t i;
+
+  for (fe = first_file; fe != NULL; fe = fe->next) {
+    num_files++;
+  }
+  if (num_files == 0) {
+    return;
+  }
+  sorted = (struct file_entry **)malloc(num_files * sizeof(struct file_entry *));
+  LWIP_ASSERT("sorted != NULL", sorted != NULL);
+  i = 0;
+  for (fe = first_file; fe != NULL; fe = fe->next) {
+    sorted[i++] = fe;
+  }
+  qsort(sorted, num_files, sizeof(struct file_entry *), compare_file_entries);
+
+  fprintf(struct_file, "/* all files sorted on name (strcmp order), used by fs_open for a binary search */" NEWLINE);
+  fprintf(struct_file, "const struct fsdata_file* const fsdata_sorted_files[] = {" NEWLINE);
+  for (i = 0; i < num_files; i++) {
+    fprintf(struct_file, "file_%s," NEWLINE, sorted[i]->filename_c);
+  }
+  fprintf(struct_file, "};" NEWLINE);
+  fprintf(struct_file, "#define FS_SORTED_FILES fsdata_sorted_files" NEWLINE NEWLINE);
+  free(sorted);
+}
+
+/** Length of the path without arguments (first '#') or extension (first '.'),
+ * the same way the file system API calculates it. */
+static size_t img_base_len(const char *path)
+{
+  const char *stop = strchr(path, '#');
+  if (stop == NULL) {
+    stop = strchr(path, '.');
+  }
+  return (stop == NULL) ? strlen(path) : (size_t)(stop - path);
+}
+
+/** Parse the arguments of a .raw file: Name#NUM#WIDTHxHEIGHT@TIME.raw
+ * @return 1 if all arguments are present and valid, 0 otherwise */
+static int img_parse_args(const char *path, struct img_entry *ie)
+{
+  char buf[MAX_PATH_LEN];
+  const char *ext = strchr(path, '.');
+  const char *args = strchr(path, '#');
+  char *tok;
+  int values[4];
+  int v;
+
+  if ((args == NULL) || (ext == NULL) || (ext < args) || ((size_t)(ext - args) < strlen("#-#-x-@-") - 1)) {
+    return 0;
+  }
+  strncpy(buf, args, ext - args);
+  buf[ext - args] = 0;
+  tok = strtok(buf, "#x@");
+  for (v = 0; v < 4; v++) {
+    if (tok == NULL) {
+      return 0;
+    }
+    values[v] = (int)strtol(tok, NULL, 10);
+    tok = strtok(NULL, "#x@");
+  }
+  if ((values[0] <= 0) || (values[0] > 0xFFFF) ||
+      (values[1] < IMG_MIN_WIDTH) || (values[2] < IMG_MIN_HEIGHT)) {
+    return 0;
+  }
+  if (((values[1] > IMG_MAX_WIDTH) || (values[2] > IMG_MAX_HEIGHT)) &&
+      ((values[3] != 0) || (values[1] > IMG_MAX_SCALED_WIDTH) || (values[2] > IMG_MAX_SCALED_HEIGHT))) {
+    return 0;
+  }
+  ie->num = values[0];
+  ie->width = values[1];
+  ie->height = values[2];
+  ie->frame_time = values[3];
+  return 1;
+}
+
+static u32_t raw_read_u32(const u8_t *p)
+{
+  return (u32_t)p[0] | ((u32_t)p[1] << 8) | ((u32_t)p[2] << 16) | ((u32_t)p[3] << 24);
+}
+
+static u16_t raw_read_u16(const u8_t *p)
+{
+  return (u16_t)(p[0] | (p[1] << 8));
+}
+
+static void raw_write_u32(u8_t *p, u32_t value)
+{
+  p[0] = (u8_t)value;
+  p[1] = (u8_t)(value >> 8);
+  p[2] = (u8_t)(value >> 16);
+  p[3] = (u8_t)(value >> 24);
+}
+
+static void raw_write_u16(u8_t *p, u16_t value)
+{
+  p[0] = (u8_t)value;
+  p[1] = (u8_t)(value >> 8);
+}
+
+/** @return 1 if the file data starts with a .raw header */
+static int raw_has_header(const u8_t *file_data, int file_size)
+{
+  return (file_data != NULL) && (file_size >= RAW_HEADER_V1_SIZE) && (raw_read_u32(file_data) == RAW_HEADER_MAGIC);
+}
+
+/** @return the size of a .raw header of size bytes with the padding after it: with -layout the payload starts on a cache line,
+ * like the file data itself (LAYOUT_ALIGNMENT). The reader skips the padding with headerSize. */
+static int raw_header_size(int size)
+{
+  return qspiLayout ? ((size + LAYOUT_ALIGNMENT - 1) / LAYOUT_ALIGNMENT) * LAYOUT_ALIGNMENT : size;
+}
+
+/** CRC-32 (IEEE 802.3, the same as zlib) of the .raw payload */
+static u32_t raw_checksum(const u8_t *data, int size)
+{
+  u32_t crc = 0xFFFFFFFFUL;
+  int i, bit;
+  for (i = 0; i < size; i++) {
+    crc ^= data[i];
+    for (bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320UL) : (crc >> 1);
+    }
+  }
+  return ~crc;
+}
+
+/** Count the valid frames (Name#NUM#WIDTHxHEIGHT@TIME.raw) in the current directory that belong to the same image or gif as filename */
+static int raw_count_frames(const char *filename)
+{
+  tinydir_dir dir;
+  struct img_entry ie;
+  size_t base_len = img_base_len(filename);
+  int frames = 0;
+  unsigned int i;
+
+  if (tinydir_open_sorted(&dir, TINYDIR_STRING(".")) == 0) {
+    for (i = 0; i < dir.n_files; i++) {
+      tinydir_file file;
+      if ((tinydir_readfile_n(&dir, &file, i) == 0) && !file.is_dir) {
+#if (defined _MSC_VER || defined __MINGW32__) && (defined _UNICODE)
+        size_t num_char_converted;
+        char curName[256];
+        wcstombs_s(&num_char_converted, curName, sizeof(curName), file.name, sizeof(curName));
+#else
+        const char *curName = file.name;
+#endif
+        if ((img_base_len(curName) == base_len) && (strncmp(curName, filename, base_len) == 0) && img_parse_args(curName, &ie)) {
+          frames++;
+        }
+      }
+    }
+    tinydir_close(&dir);
+  }
+  return frames;
+}
+
+/** Find the frame that is shown before filename: frame NUM-1, or the last frame for frame 1 because a gif loops.
+ * @return 1 if prev_name is filled in, 0 if the image or gif has no other frame */
+static int raw_previous_frame(const char *filename, int num, char *prev_name, size_t size)
+{
+  tinydir_dir dir;
+  struct img_entry ie;
+  size_t base_len = img_base_len(filename);
+  int found_num = 0;
+  unsigned int i;
+
+  if (tinydir_open_sorted(&dir, TINYDIR_STRING(".")) == 0) {
+    for (i = 0; i < dir.n_files; i++) {
+      tinydir_file file;
+      if ((tinydir_readfile_n(&dir, &file, i) == 0) && !file.is_dir) {
+#if (defined _MSC_VER || defined __MINGW32__) && (defined _UNICODE)
+        size_t num_char_converted;
+        char curName[256];
+        wcstombs_s(&num_char_converted, curName, sizeof(curName), file.name, sizeof(curName));
+#else
+        const char *curName = file.name;
+#endif
+        if ((img_base_len(curName) == base_len) && (strncmp(curName, filename, base_len) == 0) && img_parse_args(curName, &ie) &&
+            (ie.num != num) && ((ie.num == num - 1) || ((num == 1) && (ie.num > found_num)))) {
+          found_num = ie.num;
+          strncpy(prev_name, curName, size - 1);
+          prev_name[size - 1] = 0;
+        }
+      }
+    }
+    tinydir_close(&dir);
+  }
+  return (found_num != 0);
+}
+
+/** Bounding box of the ARGB1555 pixels of file_data that differ from the frame shown before it.
+ * The whole frame is used when there is no previous frame or it has another size, width 0 means the frames are equal. */
+static void raw_dirty_rect(const char *filename, const u8_t *file_data, const struct img_entry *ie, int rect[4])
+{
+  char prev_name[MAX_PATH_LEN];
+  struct img_entry prev_ie;
+  u8_t *prev_data;
+  const u8_t *prev_pixels;
+  int prev_size;
+  int is_compressed;
+  int x, y;
+  int min_x = ie->width, min_y = ie->height, max_x = -1, max_y = -1;
+
+  rect[0] = 0;
+  rect[1] = 0;
+  rect[2] = ie->width;
+  rect[3] = ie->height;
+  if (!raw_previous_frame(filename, ie->num, prev_name, sizeof(prev_name)) || !img_parse_args(prev_name, &prev_ie) ||
+      (prev_ie.width != ie->width) || (prev_ie.height != ie->height)) {
+    return;
+  }
+  prev_data = get_file_data(prev_name, &prev_size, 0, &is_compressed);
+  prev_pixels = prev_data;
+  /* a frame that already has a header is compared without it */
+  if (raw_has_header(prev_data, prev_size)) {
+    prev_pixels += raw_read_u16(&prev_data[6]);
+    prev_size -= raw_read_u16(&prev_data[6]);
+  }
+  if (prev_size >= ie->width * ie->height * 2) {
+    for (y = 0; y < ie->height; y++) {
+      for (x = 0; x < ie->width; x++) {
+        int offset = (y * ie->width + x) * 2;
+        if ((file_data[offset] != prev_pixels[offset]) || (file_data[offset + 1] != prev_pixels[offset + 1])) {
+          min_x = LWIP_MIN(min_x, x);
+          min_y = LWIP_MIN(min_y, y);
+          max_x = LWIP_MAX(max_x, x);
+          max_y = LWIP_MAX(max_y, y);
+        }
+      }
+    }
+    rect[0] = (max_x < 0) ? 0 : min_x;
+    rect[1] = (max_x < 0) ? 0 : min_y;
+    rect[2] = (max_x < 0) ? 0 : (max_x - min_x + 1);
+    rect[3] = (max_x < 0) ? 0 : (max_y - min_y + 1);
+  }
+  free(prev_data);
+}
+
+/** Run length encode 16 bit pixels (RAW_COMPRESSION_RLE16). Runs of RLE16_MIN_RUN or more equal pixels are stored as
+ * token + pixel, the pixels in between as token + literal pixels. The data is little endian, like the pixels.
+ * @return the encoded data (to be freed by the caller) and its size in out_size */
+static u8_t *raw_rle16_encode(const u8_t *data, int pixels, int *out_size)
+{
+  /* worst case: a literal token every RLE16_MAX_COUNT pixels */
+  u8_t *out = (u8_t *)malloc((size_t)pixels * 2 + ((pixels / RLE16_MAX_COUNT) + 1) * 2);
+  int in = 0, pos = 0, literal_start = 0;
+  LWIP_ASSERT("out != NULL", out != NULL);
+
+  while (in <= pixels) {
+    int run = 1;
+    if (in < pixels) {
+      u16_t pixel = raw_read_u16(&data[in * 2]);
+      while ((in + run < pixels) && (run < RLE16_MAX_COUNT) && (raw_read_u16(&data[(in + run) * 2]) == pixel)) {
+        run++;
+      }
+    }
+    /* the pending literal ends at a run, at the end of the data or when it is full */
+    if ((run >= RLE16_MIN_RUN) || (in == pixels) || (in - literal_start == RLE16_MAX_COUNT)) {
+      while (literal_start < in) {
+        int count = LWIP_MIN(in - literal_start, RLE16_MAX_COUNT);
+        raw_write_u16(&out[pos], (u16_t)(count - 1));
+        memcpy(&out[pos + 2], &data[literal_start * 2], (size_t)count * 2);
+        pos += 2 + count * 2;
+        literal_start += count;
+      }
+    }
+    if (in == pixels) {
+      break;
+    }
+    if (run >= RLE16_MIN_RUN) {
+      raw_write_u16(&out[pos], (u16_t)(RLE16_RUN_FLAG | (run - 1)));
+      memcpy(&out[pos + 2], &data[in * 2], 2);
+      pos += 4;
+      in += run;
+      literal_start = in;
+    } else {
+      in++;
+    }
+  }
+  *out_size = pos;
+  return out;
+}
+
+/** Key of an ARGB1555 pixel in the palette histogram: every transparent pixel is the same color */
+static u16_t raw_palette_key(u16_t pixel)
+{
+  return (pixel & 0x8000) ? pixel : 0;
+}
+
+/** ARGB8888 CLUT entry of 5 bit color channels, the same expansion the DMA2D does for ARGB1555 */
+static u32_t raw_clut_entry(int alpha, int red, int green, int blue)
+{
+  return ((u32_t)(alpha ? 0xFF : 0) << 24) | ((u32_t)((red << 3) | (red >> 2)) << 16) |
+         ((u32_t)((green << 3) | (green >> 2)) << 8) | (u32_t)((blue << 3) | (blue >> 2));
+}
+
+static int raw_color_channel(u16_t color, int channel)
+{
+  return (color >> (10 - channel * 5)) & 0x1F;
+}
+
+static int raw_sort_channel;
+
+static int raw_compare_colors(const void *pa, const void *pb)
+{
+  const struct raw_color *a = (const struct raw_color *)pa;
+  const struct raw_color *b = (const struct raw_color *)pb;
+  int cmp = raw_color_channel(a->color, raw_sort_channel) - raw_color_channel(b->color, raw_sort_channel);
+  return (cmp != 0) ? cmp : (a->color - b->color);
+}
+
+/** Range of the largest color channel of a box, the channel is returned in channel */
+static int raw_box_range(const struct raw_color *colors, int amount, int *channel)
+{
+  int range = -1;
+  int c, i;
+  for (c = 0; c < 3; c++) {
+    int min = 0x1F, max = 0;
+    for (i = 0; i < amount; i++) {
+      min = LWIP_MIN(min, raw_color_channel(colors[i].color, c));
+      max = LWIP_MAX(max, raw_color_channel(colors[i].color, c));
+    }
+    if (max - min > range) {
+      range = max - min;
+      *channel = c;
+    }
+  }
+  return range;
+}
+
+/** Median cut of the opaque colors into at most max_boxes boxes, every color is mapped to the average color of its box.
+ * @return the amount of CLUT entries that is added after first_entry */
+static int raw_median_cut(struct raw_color *colors, int amount, int max_boxes, int first_entry)
+{
+  int box_first[RAW_CLUT_MAX + 1];
+  int box_amount[RAW_CLUT_MAX + 1];
+  int boxes = 1;
+  int b, i;
+
+  box_first[0] = 0;
+  box_amount[0] = amount;
+  while (boxes < max_boxes) {
+    int split = -1, split_channel = 0, split_range = 0;
+    u32_t total = 0, half = 0;
+    /* the box with the largest range is split at the median of its pixels */
+    for (b = 0; b < boxes; b++) {
+      int channel;
+      int range = (box_amount[b] > 1) ? raw_box_range(&colors[box_first[b]], box_amount[b], &channel) : 0;
+      if (range > split_range) {
+        split = b;
+        split_range = range;
+        split_channel = channel;
+      }
+    }
+    if (split < 0) {
+      break;
+    }
+    raw_sort_channel = split_channel;
+    qsort(&colors[box_first[split]], box_amount[split], sizeof(struct raw_color), raw_compare_colors);
+    for (i = 0; i < box_amount[split]; i++) {
+      total += colors[box_first[split] + i].count;
+    }
+    for (i = 0; (i < box_amount[split] - 2) && ((half += colors[box_first[split] + i].count) < total / 2); i++) {
+    }
+    box_first[boxes] = box_first[split] + i + 1;
+    box_amount[boxes] = box_amount[split] - i - 1;
+    box_amount[split] = i + 1;
+    boxes++;
+  }
+
+  for (b = 0; b < boxes; b++) {
+    double sum[3] = {0, 0, 0};
+    double total = 0;
+    int c;
+    for (i = box_first[b]; i < box_first[b] + box_amount[b]; i++) {
+      for (c = 0; c < 3; c++) {
+        sum[c] += (double)raw_color_channel(colors[i].color, c) * colors[i].count;
+      }
+      total += colors[i].count;
+    }
+    raw_palette_cache.clut[first_entry + b] = raw_clut_entry(1, (int)(sum[0] / total + 0.5), (int)(sum[1] / total + 0.5), (int)(sum[2] / total + 0.5));
+    for (i = box_first[b]; i < box_first[b] + box_amount[b]; i++) {
+      raw_palette_cache.index[colors[i].color] = (u8_t)(first_entry + b);
+    }
+  }
+  return boxes;
+}
+
+/** The palette of every frame (Name#NUM#WIDTHxHEIGHT@TIME.raw) in the current directory that belongs to the same image or gif as filename,
+ * so all frames of a gif share one CLUT. Up to RAW_CLUT_MAX colors are stored exactly, more colors are reduced with a median cut.
+ * The palette of the last image or gif is cached, it is built once for all its frames.
+ * @return the palette */
+static const struct raw_palette *raw_build_palette(const char *filename, const struct img_entry *ie)
+{
+  char key[MAX_PATH_LEN * 2];
+  size_t base_len = img_base_len(filename);
+  tinydir_dir dir;
+  u32_t *counts;
+  struct raw_color *colors;
+  int amount = 0;
+  int has_transparent;
+  unsigned int i;
+  int color;
+
+  if (GETCWD(key, MAX_PATH_LEN) == NULL) {
+    key[0] = 0;
+  }
+  strcat(key, "/");
+  strncat(key, filename, base_len);
+  if ((strcmp(key, raw_palette_cache.key) == 0) && (raw_palette_cache.width == ie->width) && (raw_palette_cache.height == ie->height)) {
+    return &raw_palette_cache;
+  }
+
+  counts = (u32_t *)calloc(RAW_ARGB1555_COLORS, sizeof(u32_t));
+  colors = (struct raw_color *)malloc(RAW_ARGB1555_COLORS * sizeof(struct raw_color));
+  LWIP_ASSERT("palette alloc", (counts != NULL) && (colors != NULL));
+  if (tinydir_open_sorted(&dir, TINYDIR_STRING(".")) == 0) {
+    for (i = 0; i < dir.n_files; i++) {
+      tinydir_file file;
+      struct img_entry frame_ie;
+      if ((tinydir_readfile_n(&dir, &file, i) == 0) && !file.is_dir) {
+#if (defined _MSC_VER || defined __MINGW32__) && (defined _UNICODE)
+        size_t num_char_converted;
+        char curName[256];
+        wcstombs_s(&num_char_converted, curName, sizeof(curName), file.name, sizeof(curName));
+#else
+        const char *curName = file.name;
+#endif
+        if ((img_base_len(curName) == base_len) && (strncmp(curName, filename, base_len) == 0) && img_parse_args(curName, &frame_ie) &&
+            (frame_ie.width == ie->width) && (frame_ie.height == ie->height)) {
+          int frame_size, is_compressed, p;
+          u8_t *frame_data = get_file_data(curName, &frame_size, 0, &is_compressed);
+          /* frames that already have a header are left as they are */
+          if (!raw_has_header(frame_data, frame_size) && (frame_size >= ie->width * ie->height * 2)) {
+            for (p = 0; p < ie->width * ie->height; p++) {
+              counts[raw_palette_key(raw_read_u16(&frame_data[p * 2]))]++;
+            }
+          }
+          free(frame_data);
+        }
+      }
+    }
+    tinydir_close(&dir);
+  }
+
+  /* transparent pixels get their own entry, the opaque colors share the others */
+  has_transparent = (counts[0] != 0);
+  for (color = 0x8000; color < RAW_ARGB1555_COLORS; color++) {
+    if (counts[color] != 0) {
+      colors[amount].color = (u16_t)color;
+      colors[amount].count = counts[color];
+      amount++;
+    }
+  }
+  memset(raw_palette_cache.index, 0, sizeof(raw_palette_cache.index));
+  raw_palette_cache.clut[0] = 0;
+  raw_palette_cache.exact = (has_transparent + amount <= RAW_CLUT_MAX);
+  if (raw_palette_cache.exact) {
+    for (color = 0; color < amount; color++) {
+      raw_palette_cache.clut[has_transparent + color] = raw_clut_entry(1, raw_color_channel(colors[color].color, 0),
+                                                                       raw_color_channel(colors[color].color, 1), raw_color_channel(colors[color].color, 2));
+      raw_palette_cache.index[colors[color].color] = (u8_t)(has_transparent + color);
+    }
+    raw_palette_cache.size = has_transparent + amount;
+  } else {
+    raw_palette_cache.size = has_transparent + raw_median_cut(colors, amount, RAW_CLUT_MAX - has_transparent, has_transparent);
+    printf(" - raw clut: %.*s has %d colors, reduced to %d" NEWLINE, (int)base_len, filename, has_transparent + amount, raw_palette_cache.size);
+  }
+  /* an asset without pixels still needs one entry */
+  raw_palette_cache.size = LWIP_MAX(raw_palette_cache.size, 1);
+  strcpy(raw_palette_cache.key, key);
+  raw_palette_cache.width = ie->width;
+  raw_palette_cache.height = ie->height;
+  free(colors);
+  free(counts);
+  return &raw_palette_cache;
+}
+
+/** Convert ARGB1555 pixels to indexes in the palette: L4 (two pixels per byte, the first pixel in the low nibble) for up to
+ * RAW_CLUT_L4_MAX colors and an even width, L8 otherwise.
+ * @return the indexes (to be freed by the caller), their size in out_size and the format in pixel_format */
+static u8_t *raw_index_pixels(const u8_t *data, const struct img_entry *ie, const struct raw_palette *palette, int *out_size, int *pixel_format)
+{
+  int pixels = ie->width * ie->height;
+  int is_l4 = (palette->size <= RAW_CLUT_L4_MAX) && ((ie->width % 2) == 0);
+  u8_t *out;
+  int p;
+
+  *out_size = is_l4 ? (pixels / 2) : pixels;
+  *pixel_format = is_l4 ? RAW_FORMAT_L4 : RAW_FORMAT_L8;
+  out = (u8_t *)calloc((size_t)*out_size, 1);
+  LWIP_ASSERT("out != NULL", out != NULL);
+  for (p = 0; p < pixels; p++) {
+    u8_t index = palette->index[raw_palette_key(raw_read_u16(&data[p * 2]))];
+    if (is_l4) {
+      out[p / 2] |= (u8_t)(index << ((p % 2) * 4));
+    } else {
+      out[p] = index;
+    }
+  }
+  return out;
+}
+
+/** Prepend the binary header to a .raw file whose name contains valid arguments.
+ * Files that already have a header or no valid arguments are returned unchanged. */
+static u8_t *add_raw_header(const char *filename, u8_t *file_data, int *file_size)
+{
+  struct img_entry ie;
+  char *ext_lower;
+  int is_raw;
+  u8_t *new_data;
+  u8_t *hdr;
+  u8_t *payload;
+  int payload_size;
+  int compression = RAW_COMPRESSION_NONE;
+  int pixel_format = RAW_FORMAT_ARGB1555;
+  int header_size = raw_header_size(RAW_HEADER_SIZE);
+  const struct raw_palette *palette = NULL;
+  int rect[4];
+  int i;
+
+  ext_lower = strdup(filename);
+  is_raw = (strchr(ext_lower, '.') != NULL);
+  if (is_raw) {
+    strToLower(strchr(ext_lower, '.'), strlen(strchr(ext_lower, '.')));
+    is_raw = (strstr(ext_lower, ".raw") != NULL);
+  }
+  free(ext_lower);
+  if (!is_raw || raw_has_header(file_data, *file_size) || !img_parse_args(filename, &ie)) {
+    return file_data;
+  }
+  if (*file_size < ie.width * ie.height * 2) {
+    printf(" - raw header: %s is smaller than %dx%d ARGB1555, no header written" NEWLINE, filename, ie.width, ie.height);
+    return file_data;
+  }
+
+  /* only the pixels of the frame are compressed or indexed, the payload is only replaced when it gets smaller */
+  payload = file_data;
+  payload_size = *file_size;
+  if (compressRaw || indexRaw) {
+    rawBytesIn += (size_t)*file_size;
+  }
+  if (compressRaw) {
+    int rle_size;
+    u8_t *rle_data = raw_rle16_encode(file_data, ie.width * ie.height, &rle_size);
+    if (rle_size < *file_size) {
+      payload = rle_data;
+      payload_size = rle_size;
+      compression = RAW_COMPRESSION_RLE16;
+    } else {
+      free(rle_data);
+    }
+  }
+  if (indexRaw) {
+    int index_size, index_format, index_header_size;
+    const struct raw_palette *index_palette = raw_build_palette(filename, &ie);
+    u8_t *index_data = raw_index_pixels(file_data, &ie, index_palette, &index_size, &index_format);
+    /* the CLUT is part of the header (with its padding), so it counts for the size of the frame */
+    index_header_size = raw_header_size(RAW_HEADER_SIZE + index_palette->size * 4);
+    if (index_size + index_header_size < payload_size + header_size) {
+      if (payload != file_data) {
+        free(payload);
+      }
+      payload = index_data;
+      payload_size = index_size;
+      compression = RAW_COMPRESSION_NONE;
+      pixel_format = index_format;
+      palette = index_palette;
+      header_size = index_header_size;
+    } else {
+      free(index_data);
+    }
+  }
+  if (compressRaw || indexRaw) {
+    rawBytesOut += (size_t)(payload_size + header_size - RAW_HEADER_SIZE);
+  }
+
+  new_data = (u8_t *)malloc(payload_size + header_size);
+  LWIP_ASSERT("new_data != NULL", new_data != NULL);
+  hdr = new_data;
+  memset(hdr, 0, header_size);
+  raw_write_u32(&hdr[0], RAW_HEADER_MAGIC);
+  hdr[4] = RAW_HEADER_VERSION;
+  hdr[5] = (u8_t)pixel_format;
+  raw_write_u16(&hdr[6], (u16_t)header_size);
+  raw_write_u16(&hdr[8], (u16_t)ie.width);
+  raw_write_u16(&hdr[10], (u16_t)ie.height);
+  raw_write_u16(&hdr[12], (u16_t)((pixel_format == RAW_FORMAT_L4) ? (ie.width / 2) : ((pixel_format == RAW_FORMAT_L8) ? ie.width : (ie.width * 2))));
+  raw_write_u16(&hdr[14], (u16_t)ie.frame_time);
+  raw_write_u16(&hdr[16], (u16_t)ie.num);
+  raw_write_u16(&hdr[18], (u16_t)raw_count_frames(filename));
+  raw_write_u32(&hdr[20], (u32_t)payload_size);
+  raw_write_u32(&hdr[24], raw_checksum(payload, payload_size));
+  hdr[28] = (u8_t)compression;
+  raw_dirty_rect(filename, file_data, &ie, rect);
+  raw_write_u16(&hdr[32], (u16_t)rect[0]);
+  raw_write_u16(&hdr[34], (u16_t)rect[1]);
+  raw_write_u16(&hdr[36], (u16_t)rect[2]);
+  raw_write_u16(&hdr[38], (u16_t)rect[3]);
+  if (palette != NULL) {
+    raw_write_u16(&hdr[30], (u16_t)palette->size);
+    for (i = 0; i < palette->size; i++) {
+      raw_write_u32(&hdr[RAW_HEADER_SIZE + i * 4], palette->clut[i]);
+    }
+  }
+  memcpy(&new_data[header_size], payload, payload_size);
+  if (payload != file_data) {
+    free(payload);
+  }
+  free(file_data);
+  *file_size = payload_size + header_size;
+  return new_data;
+}
+
+/** Section of a .raw file for the QSPI layout (-layout): .ExtQSPIFlashSection.<path without args>.<frame number>
+ * The frame number is zero padded so the sections sort in play order. '.' sorts before every character of
+ * a C variable name, so the frames of cat and cat_2 can't end up between each other.
+ * @return 1 if the file is a .raw file and section is filled in, 0 otherwise */
+static int layout_section_name(const char *qualifiedName, char *section, size_t size)
+{
+  char base[MAX_PATH_LEN];
+  const char *args = strchr(qualifiedName, '#');
+  size_t base_len = img_base_len(qualifiedName);
+  size_t i;
+
+  if (!ext_in_list(qualifiedName, "raw")) {
+    return 0;
+  }
+  strncpy(base, qualifiedName, base_len);
+  base[base_len] = 0;
+  for (i = 0; i < base_len; i++) {
+    if (!is_valid_char_for_c_var(base[i])) {
+      base[i] = '_';
+    }
+  }
+  snprintf(section, size, QSPI_SECTION ".%s.%05d", base, (args == NULL) ? 0 : (int)strtol(args + 1, NULL, 10));
+  return 1;
+}
+
+static void register_image(const char *qualifiedName, int payload_offset, const u8_t *file_data, int file_size)
+{
+  struct img_entry *ie;
+  char *ext_lower;
+  img_kind kind = img_other;
+
+  /* the extension is compared in lowercase, so .PNG and .png are both accepted */
+  ext_lower = strdup(qualifiedName);
+  if (strchr(ext_lower, '.') != NULL) {
+    strToLower(strchr(ext_lower, '.'), strlen(strchr(ext_lower, '.')));
+    kind = (strstr(ext_lower, ".png") != NULL) ? img_png : kind;
+    kind = (strstr(ext_lower, ".gif") != NULL) ? img_gif : kind;
+    kind = (strstr(ext_lower, ".raw") != NULL) ? img_raw : kind;
+  }
+  free(ext_lower);
+  if (kind == img_other) {
+    return;
+  }
+
+  ie = (struct img_entry *)calloc(1, sizeof(struct img_entry));
+  LWIP_ASSERT("ie != NULL", ie != NULL);
+  ie->pixel_format = RAW_FORMAT_ARGB1555;
+  if ((kind == img_raw) && raw_has_header(file_data, file_size)) {
+    /* the header replaces the arguments in the name, the frame data starts after the header */
+    ie->pixel_format = file_data[5];
+    ie->width = raw_read_u16(&file_data[8]);
+    ie->height = raw_read_u16(&file_data[10]);
+    ie->frame_time = raw_read_u16(&file_data[14]);
+    ie->num = raw_read_u16(&file_data[16]);
+    ie->compression = file_data[28];
+    ie->data_size = (int)raw_read_u32(&file_data[20]);
+    payload_offset += raw_read_u16(&file_data[6]);
+  } else if ((kind == img_raw) && !img_parse_args(qualifiedName, ie)) {
+    printf(" - image manifest: invalid arguments, skipping %s" NEWLINE, qualifiedName);
+    free(ie);
+    return;
+  }
+  if (!((kind == img_raw) && raw_has_header(file_data, file_size))) {
+    ie->data_size = file_size;
+  }
+  /* without a version 2 header the whole frame is drawn */
+  ie->dirty_width = ie->width;
+  ie->dirty_height = ie->height;
+  if ((kind == img_raw) && raw_has_header(file_data, file_size) && (file_size >= RAW_HEADER_SIZE) && (file_data[4] >= RAW_HEADER_DIRTY_VERSION) && (raw_read_u16(&file_data[6]) >= RAW_HEADER_SIZE)) {
+    ie->dirty_x = raw_read_u16(&file_data[32]);
+    ie->dirty_y = raw_read_u16(&file_data[34]);
+    ie->dirty_width = raw_read_u16(&file_data[36]);
+    ie->dirty_height = raw_read_u16(&file_data[38]);
+  }
+  /* the CLUT of a version 4 header follows the dirty rect, the manifest points to it */
+  if ((kind == img_raw) && raw_has_header(file_data, file_size) && (file_data[4] >= RAW_HEADER_CLUT_VERSION) && (raw_read_u16(&file_data[30]) != 0) &&
+      (raw_read_u16(&file_data[6]) >= RAW_HEADER_SIZE + raw_read_u16(&file_data[30]) * 4)) {
+    int i;
+    ie->clut_size = raw_read_u16(&file_data[30]);
+    ie->clut_offset = payload_offset - raw_read_u16(&file_data[6]) + RAW_HEADER_SIZE;
+    ie->clut = (u32_t *)malloc(ie->clut_size * sizeof(u32_t));
+    LWIP_ASSERT("clut != NULL", ie->clut != NULL);
+    for (i = 0; i < ie->clut_size; i++) {
+      ie->clut[i] = raw_read_u32(&file_data[RAW_HEADER_SIZE + i * 4]);
+    }
+    if ((ie->clut_offset % 4) != 0) {
+      printf(" - image manifest: the CLUT of %s isn't word aligned (use -xh:raw), skipping" NEWLINE, qualifiedName);
+      free(ie->clut);
+      free(ie);
+      return;
+    }
+  }
+  ie->kind = kind;
+  ie->filename_c = last_file->filename_c; /* register_filename() already stored a copy of varname */
+  ie->qualified_name = strdup(qualifiedName);
+  ie->payload_offset = payload_offset;
+  ie->name_offset = (strrchr(qualifiedName, '/') == NULL) ? 0 : (size_t)(strrchr(qualifiedName, '/') - qualifiedName + 1);
+  ie->base_len = img_base_len(qualifiedName);
+  ie->next = first_img;
+  first_img = ie;
+}
+
+static int img_compare_base(const struct img_entry *a, const struct img_entry *b)
+{
+  int cmp = strncmp(a->qualified_name, b->qualified_name, (a->base_len < b->base_len) ? a->base_len : b->base_len);
+  if (cmp == 0) {
+    cmp = (a->base_len > b->base_len) - (a->base_len < b->base_len);
+  }
+  return cmp;
+}
+
+static int img_compare_frames(const void *pa, const void *pb)
+{
+  const struct img_entry *a = *(const struct img_entry * const *)pa;
+  const struct img_entry *b = *(const struct img_entry * const *)pb;
+  int cmp = img_compare_base(a, b);
+  if (cmp == 0) {
+    cmp = (a->num > b->num) - (a->num < b->num);
+  }
+  return cmp;
+}
+
+/** lowercase name with extension, the same way extractNameOutOfPath(.., ext, lower) creates it */
+static void img_sort_name(const struct img_entry *ie, char *buf)
+{
+  const char *dot = strchr(ie->qualified_name, '.');
+  size_t len = ie->base_len - ie->name_offset;
+  memcpy(buf, &ie->qualified_name[ie->name_offset], len);
+  buf[len] = 0;
+  if (dot != NULL) {
+    strcat(buf, dot);
+  }
+  strToLower(buf, strlen(buf));
+}
+
+static int img_compare_names(const void *pa, const void *pb)
+{
+  char name_a[MAX_PATH_LEN * 2];
+  char name_b[MAX_PATH_LEN * 2];
+  img_sort_name(*(const struct img_entry * const *)pa, name_a);
+  img_sort_name(*(const struct img_entry * const *)pb, name_b);
+  return strcmp(name_a, name_b);
+}
+
+static void write_catalog_entries(FILE *struct_file, const char *varname, struct img_entry **entries, int amount)
+{
+  int i;
+  if (amount == 0) {
+    return;
+  }
+  fprintf(struct_file, "static const struct catalogEntry %s[] = {" NEWLINE, varname);
+  for (i = 0; i < amount; i++) {
+    fprintf(struct_file, "{(char *)data_%s, %d, %d, %d, %d}," NEWLINE, entries[i]->filename_c,
+            (int)entries[i]->name_offset, (int)entries[i]->base_len, entries[i]->first_frame, entries[i]->frame_amount);
+  }
+  fprintf(struct_file, "};" NEWLINE);
+}
+
+/** Write the image manifest (struct imageManifest from imageManifest.h): the same
+ * catalog initFileSystemAPI would build at runtime, sorted and linked. */
+static void write_image_manifest(FILE *struct_file)
+{
+  struct img_entry *ie;
+  struct img_entry **frames, **images, **gifs;
+  int frame_cnt = 0, image_cnt = 0, gif_cnt = 0;
+  int kept_frames = 0, kept_images = 0, kept_gifs = 0;
+  int largest_name = 0;
+  int i, j, group_end;
+
+  for (ie = first_img; ie != NULL; ie = ie->next) {
+    frame_cnt += (ie->kind == img_raw);
+    image_cnt += (ie->kind == img_png);
+    gif_cnt += (ie->kind == img_gif);
+  }
+  frames = (struct img_entry **)malloc((frame_cnt + 1) * sizeof(struct img_entry *));
+  images = (struct img_entry **)malloc((image_cnt + 1) * sizeof(struct img_entry *));
+  gifs = (struct img_entry **)malloc((gif_cnt + 1) * sizeof(struct img_entry *));
+  LWIP_ASSERT("manifest alloc", (frames != NULL) && (images != NULL) && (gifs != NULL));
+  frame_cnt = image_cnt = gif_cnt = 0;
+  for (ie = first_img; ie != NULL; ie = ie->next) {
+    if (ie->kind == img_raw) {
+      frames[frame_cnt++] = ie;
+    } else if (ie->kind == img_png) {
+      images[image_cnt++] = ie;
+    } else {
+      gifs[gif_cnt++] = ie;
+    }
+  }
+
+  /* link every group of frames (same path without arguments) to its .png and/or .gif,
+     frames without .png or .gif are dropped */
+  qsort(frames, frame_cnt, sizeof(struct img_entry *), img_compare_frames);
+  for (i = 0; i < frame_cnt; i = group_end) {
+    int owned = 0;
+    for (group_end = i + 1; (group_end < frame_cnt) && (img_compare_base(frames[group_end], frames[i]) == 0); group_end++) {
+    }
+    for (j = 0; j < image_cnt; j++) {
+      if (img_compare_base(images[j], frames[i]) == 0) {
+        images[j]->first_frame = kept_frames;
+        images[j]->frame_amount = group_end - i;
+        owned = 1;
+      }
+    }
+    for (j = 0; j < gif_cnt; j++) {
+      if (img_compare_base(gifs[j], frames[i]) == 0) {
+        gifs[j]->first_frame = kept_frames;
+        gifs[j]->frame_amount = group_end - i;
+        owned = 1;
+      }
+    }
+    if (owned) {
+      for (j = i; j < group_end; j++) {
+        frames[kept_frames++] = frames[j];
+      }
+    } else {
+      printf(" - image manifest: no .png or .gif found for %s" NEWLINE, frames[i]->qualified_name);
+    }
+  }
+  for (i = 0; i < image_cnt; i++) {
+    if (images[i]->frame_amount != 0) {
+      images[kept_images++] = images[i];
+    }
+  }
+  for (i = 0; i < gif_cnt; i++) {
+    if (gifs[i]->frame_amount != 0) {
+      gifs[kept_gifs++] = gifs[i];
+    }
+  }
+  qsort(images, kept_images, sizeof(struct img_entry *), img_compare_names);
+  qsort(gifs, kept_gifs, sizeof(struct img_entry *), img_compare_names);
+
+  for (i = 0; i < kept_images; i++) {
+    largest_name = LWIP_MAX(largest_name, (int)strlen(&images[i]->qualified_name[images[i]->name_offset]) + 1);
+  }
+  for (i = 0; i < kept_gifs; i++) {
+    largest_name = LWIP_MAX(largest_name, (int)strlen(&gifs[i]->qualified_name[gifs[i]->name_offset]) + 1);
+  }
+  for (i = 0; i < kept_frames; i++) {
+    largest_name = LWIP_MAX(largest_name, (int)strlen(&frames[i]->qualified_name[frames[i]->name_offset]) + 1);
+  }
+
+  fprintf(struct_file, "/* image manifest for the file system API: %d images, %d gifs, %d frames */" NEWLINE, kept_images, kept_gifs, kept_frames);
+  fprintf(struct_file, "#include \"imageManifest.h\"" NEWLINE);
+  if (kept_frames != 0) {
+    fprintf(struct_file, "static const struct imageMetaData fsImageFrames[] = {" NEWLINE);
+    for (i = 0; i < kept_frames; i++) {
+      char clut[MAX_PATH_LEN + 48] = "NULL";
+      /* frames with the same CLUT point to the first copy, so the DMA2D only loads it when the palette changes */
+      if (frames[i]->clut != NULL) {
+        for (j = 0; (j < i) && ((frames[j]->clut_size != frames[i]->clut_size) ||
+                                (memcmp(frames[j]->clut, frames[i]->clut, frames[i]->clut_size * sizeof(u32_t)) != 0)); j++) {
+        }
+        snprintf(clut, sizeof(clut), "(const uint32_t *)(data_%s + %d)", frames[j]->filename_c, frames[j]->clut_offset);
+      }
+      fprintf(struct_file, "{(char *)data_%s, (void *)(data_%s + %d), %d, %d, %d, %d, %d, {%d, %d, %d, %d}, %d, %d, %s, %d}," NEWLINE, frames[i]->filename_c, frames[i]->filename_c,
+              frames[i]->payload_offset, frames[i]->width, frames[i]->height, frames[i]->num, frames[i]->frame_time, frames[i]->pixel_format,
+              frames[i]->dirty_x, frames[i]->dirty_y, frames[i]->dirty_width, frames[i]->dirty_height, frames[i]->compression, frames[i]->data_size,
+              clut, frames[i]->clut_size);
+    }
+    fprintf(struct_file, "};" NEWLINE);
+  }
+  write_catalog_entries(struct_file, "fsImageImages", images, kept_images);
+  write_catalog_entries(struct_file, "fsImageGifs", gifs, kept_gifs);
+  fprintf(struct_file, "const struct imageManifest fsImageManifest = {%s, %d, %s, %d, %s, %d, %d};" NEWLINE NEWLINE,
+          kept_images ? "fsImageImages" : "NULL", kept_images, kept_gifs ? "fsImageGifs" : "NULL", kept_gifs,
+          kept_frames ? "fsImageFrames" : "NULL", kept_frames, largest_name);
+  free(frames);
+  free(images);
+  free(gifs);
+}
+
 static int checkSsiByFilelist(const char* filename_listfile)
 {
   FILE *f = fopen(filename_listfile, "r");
@@ -985,6 +2024,8 @@ int process_file(FILE *data_file, FILE *struct_file, const char *filename)
   int can_be_compressed;
   int is_compressed = 0;
   int flags_printed;
+  int data_alignment = PAYLOAD_ALIGNMENT;
+  char section_name[MAX_PATH_LEN + 32];
 
   /* create qualified name (@todo: prepend slash or not?) */
   sprintf(qualifiedName, "%s/%s", curSubdir, filename);
@@ -992,21 +2033,27 @@ int process_file(FILE *data_file, FILE *struct_file, const char *filename)
   strcpy(varname, qualifiedName);
   /* convert slashes & dots to underscores */
   fix_filename_for_c(varname, MAX_PATH_LEN);
-  register_filename(varname);
+  register_filename(varname, qualifiedName);
 #if ALIGN_PAYLOAD
   /* to force even alignment of array, type 1 */
   fprintf(data_file, "#if FSDATA_FILE_ALIGNMENT==1" NEWLINE);
   fprintf(data_file, "static const " PAYLOAD_ALIGN_TYPE " dummy_align_%s = %d;" NEWLINE, varname, payload_alingment_dummy_counter++);
   fprintf(data_file, "#endif" NEWLINE);
 #endif /* ALIGN_PAYLOAD */
-  fprintf(data_file, "__attribute__((section(\".ExtQSPIFlashSection\")))" NEWLINE);
+  if (qspiLayout && layout_section_name(qualifiedName, section_name, sizeof(section_name))) {
+    /* a frame starts on a cache line, so a DMA2D burst never needs an extra line */
+    data_alignment = LAYOUT_ALIGNMENT;
+    fprintf(data_file, "__attribute__((section(\"%s\"), aligned(%d)))" NEWLINE, section_name, data_alignment);
+  } else {
+    fprintf(data_file, "__attribute__((section(\"" QSPI_SECTION "\")))" NEWLINE);
+  }
   fprintf(data_file, "static const unsigned char FSDATA_ALIGN_PRE data_%s[] FSDATA_ALIGN_POST = {" NEWLINE, varname);
   /* encode source file name (used by file system, not returned to browser) */
   fprintf(data_file, "/* %s (%"SZT_F" chars) */" NEWLINE, qualifiedName, strlen(qualifiedName) + 1);
   file_put_ascii(data_file, qualifiedName, strlen(qualifiedName) + 1, &i);
 #if ALIGN_PAYLOAD
   /* pad to even number of bytes to assure payload is on aligned boundary */
-  while (i % PAYLOAD_ALIGNMENT != 0) {
+  while (i % data_alignment != 0) {
     fprintf(data_file, "0x%02x,", 0);
     i++;
   }
@@ -1020,6 +2067,9 @@ int process_file(FILE *data_file, FILE *struct_file, const char *filename)
   has_content_len = !is_ssi;
   can_be_compressed = includeHttpHeader && !is_ssi && file_can_be_compressed(filename) && file_to_exclude_http_header(filename);
   file_data = get_file_data(filename, &file_size, can_be_compressed, &is_compressed);
+  if (writeRawHeader && !is_compressed) {
+    file_data = add_raw_header(filename, file_data, &file_size);
+  }
   if (includeHttpHeader && file_to_exclude_http_header(filename)) {
     file_write_http_header(data_file, filename, file_size, &http_hdr_len, &http_hdr_chksum, has_content_len, is_compressed);
     flags |= FS_FILE_FLAGS_HEADER_INCLUDED;
@@ -1034,6 +2084,10 @@ int process_file(FILE *data_file, FILE *struct_file, const char *filename)
     chksum_count = write_checksums(struct_file, varname, http_hdr_len, http_hdr_chksum, file_data, file_size);
   }
 
+  if (generateImageManifest) {
+    register_image(qualifiedName, i, is_compressed ? NULL : file_data, file_size);
+  }
+
   /* build declaration of struct fsdata_file in temp file */
   fprintf(struct_file, "const struct fsdata_file file_%s[] = { {" NEWLINE, varname);
   fprintf(struct_file, "file_%s," NEWLINE, lastFileVar);
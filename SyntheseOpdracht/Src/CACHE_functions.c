@@ -0,0 +1,216 @@
+/*!
+ *  \file CACHE_functions.c
+ *	\details This file contains the frame cache. The SDRAM region that is given to initFrameCache is split in slots of FRAME_CACHE_SLOT_SIZE bytes, every slot holds
+ *			 one frame: an uncompressed frame is copied by the DMA2D, a compressed frame is decoded by the CPU. A slot is found by the address of the frame data in the QSPI,
+ *			 so it stays valid when the file system catalog is rebuilt. When all slots are used the slot that was used longest ago is reused (LRU).
+ *  \remark A slot is only reused when the DMA2D jobs that read or write it are done (setFrameCacheJob), the functions have to be called from the main loop.
+ */
+#include "CACHE_functions.h"
+
+static void* loadFrame(const struct imageMetaData* pFrame, uint8_t prefetch);
+static uint8_t fillSlot(const struct imageMetaData* pFrame, uint16_t slot, uint32_t size);
+
+struct cacheSlot
+{
+	// data of the frame in the QSPI, NULL when the slot is free
+	const void* pSource;
+	// value of useCounter when the frame was used last, the slot with the lowest value is reused first
+	uint32_t lastUse;
+	// the last DMA2D job that reads or writes the slot
+	uint32_t job;
+};
+
+static struct cacheSlot cacheSlots[FRAME_CACHE_MAX_SLOTS];
+static uint8_t* pCacheMemory = NULL;
+static uint16_t slotAmount = 0;
+static uint32_t useCounter = 0;
+static struct frameCacheStatistics cacheStatistics;
+static uint32_t totalFillCycles = 0;
+static uint32_t fillAmount = 0;
+
+/*!
+ * \brief Gives the cache its SDRAM region, all slots are free afterwards.
+ *
+ * \param address -> start of the region, word aligned
+ * \param size -> size of the region in bytes
+ *
+ * \retval void
+ */
+void initFrameCache(uint32_t address, uint32_t size)
+{
+	pCacheMemory = (uint8_t*)address;
+	slotAmount = (size / FRAME_CACHE_SLOT_SIZE > FRAME_CACHE_MAX_SLOTS)? FRAME_CACHE_MAX_SLOTS : size / FRAME_CACHE_SLOT_SIZE;
+	memset(cacheSlots, 0, sizeof(cacheSlots));
+	memset(&cacheStatistics, 0, sizeof(cacheStatistics));
+	totalFillCycles = 0;
+	fillAmount = 0;
+}
+
+/*!
+ * \brief Returns the pixels of a frame that the DMA2D can draw: the slot that holds the frame, after it is copied or decoded when it isn't cached yet.
+ *
+ * \param pFrame -> the frame or picture
+ *
+ * \return the pixel data, the frame data in the QSPI itself when an uncompressed frame can't be cached
+ * \return NULL when the frame can't be decoded
+ *
+ * \note call setFrameCacheJob with the job that draws the pixels
+ */
+void* getCachedFrame(const struct imageMetaData* pFrame)
+{
+	return loadFrame(pFrame, 0);
+}
+
+/*!
+ * \brief Copies or decodes a frame into the cache ahead, so it is a hit when it is drawn.
+ *
+ * \param pFrame -> the frame that will be drawn soon
+ *
+ * \retval void
+ *
+ * \note an uncompressed frame is copied by the DMA2D after the jobs that are queued already, so it doesn't delay them
+ */
+void prefetchFrame(const struct imageMetaData* pFrame)
+{
+	loadFrame(pFrame, 1);
+}
+
+/*!
+ * \brief Remembers the DMA2D job that reads pixels of the cache, the slot isn't reused before the job is done.
+ *
+ * \param pPixels -> the pixels that are read (getCachedFrame), other memory is ignored
+ * \param job -> number of the job (getLastDMA2DJob)
+ *
+ * \retval void
+ */
+void setFrameCacheJob(const void* pPixels, uint32_t job)
+{
+	uint32_t offset = (uint32_t)((const uint8_t*)pPixels - pCacheMemory);
+
+	if(pCacheMemory != NULL && (const uint8_t*)pPixels >= pCacheMemory && offset < (uint32_t)slotAmount * FRAME_CACHE_SLOT_SIZE)
+	{
+		cacheSlots[offset / FRAME_CACHE_SLOT_SIZE].job = job;
+	}
+}
+
+/*!
+ * \brief Returns the use of the cache since startup.
+ *
+ * \param pStatistics -> struct that is filled with the hits, misses, prefetches, evictions, used slots and fill time
+ *
+ * \retval void
+ */
+void getFrameCacheStatistics(struct frameCacheStatistics* pStatistics)
+{
+	*pStatistics = cacheStatistics;
+	pStatistics->usedSlots = 0;
+	for(uint16_t slot = 0; slot < slotAmount; slot++)
+	{
+		pStatistics->usedSlots += (cacheSlots[slot].pSource != NULL)? 1 : 0;
+	}
+	pStatistics->slotAmount = slotAmount;
+	pStatistics->averageFillCycles = (fillAmount != 0)? totalFillCycles / fillAmount : 0;
+}
+
+/*!
+ * \brief Looks a frame up in the cache and fills the least recently used slot with it when it isn't cached.
+ *
+ * \param pFrame -> the frame
+ * \param prefetch -> 1 when the frame is loaded ahead, it is counted as prefetch instead of hit or miss
+ *
+ * \return the pixel data (see getCachedFrame)
+ * \return NULL when the frame can't be decoded
+ */
+static void* loadFrame(const struct imageMetaData* pFrame, uint8_t prefetch)
+{
+	uint16_t victim = 0;
+	// the size of the pixels in the slot: a compressed frame is stored decoded
+	uint32_t size = (pFrame->compression == RAW_COMPRESSION_NONE)? ((uint32_t)pFrame->width * getRawBitsPerPixel(pFrame->pixelFormat) + 7) / 8 * pFrame->height
+																 : (uint32_t)pFrame->width * pFrame->height * sizeof(uint16_t);
+
+	// a frame that doesn't fit in a slot (or data that the DMA2D can't copy) is drawn from the QSPI, a compressed frame can't be drawn then
+	if(slotAmount == 0 || size > FRAME_CACHE_SLOT_SIZE || (pFrame->compression != RAW_COMPRESSION_NONE && pFrame->compression != RAW_COMPRESSION_RLE16)
+			|| (pFrame->compression == RAW_COMPRESSION_NONE && ((uintptr_t)pFrame->data % sizeof(uint32_t)) != 0))
+	{
+		return (pFrame->compression == RAW_COMPRESSION_NONE)? pFrame->data : NULL;
+	}
+	for(uint16_t slot = 0; slot < slotAmount; slot++)
+	{
+		if(cacheSlots[slot].pSource == pFrame->data)
+		{
+			cacheSlots[slot].lastUse = ++useCounter;
+			cacheStatistics.hits += (prefetch == 0)? 1 : 0;
+			return pCacheMemory + (uint32_t)slot * FRAME_CACHE_SLOT_SIZE;
+		}
+		// a free slot is used first, otherwise the slot that was used longest ago
+		if(cacheSlots[victim].pSource != NULL && (cacheSlots[slot].pSource == NULL || (int32_t)(cacheSlots[slot].lastUse - cacheSlots[victim].lastUse) < 0))
+		{
+			victim = slot;
+		}
+	}
+	cacheStatistics.misses += (prefetch == 0)? 1 : 0;
+	cacheStatistics.prefetches += (prefetch != 0)? 1 : 0;
+	cacheStatistics.evictions += (cacheSlots[victim].pSource != NULL)? 1 : 0;
+	if(fillSlot(pFrame, victim, size) == 0)
+	{
+		return NULL;
+	}
+	cacheSlots[victim].lastUse = ++useCounter;
+	return pCacheMemory + (uint32_t)victim * FRAME_CACHE_SLOT_SIZE;
+}
+
+/*!
+ * \brief Copies or decodes a frame into a slot.
+ *
+ * \param pFrame -> the frame
+ * \param slot -> index of the slot
+ * \param size -> size of the pixels in the slot in bytes
+ *
+ * \retval 1 when the slot holds the frame (the copy can still be queued).
+ * \retval 0 when the frame can't be decoded, the slot is free then.
+ */
+static uint8_t fillSlot(const struct imageMetaData* pFrame, uint16_t slot, uint32_t size)
+{
+	uint8_t* pSlot = pCacheMemory + (uint32_t)slot * FRAME_CACHE_SLOT_SIZE;
+	uint32_t start = DWT->CYCCNT;
+	uint32_t cycles;
+
+	// a queued frame can still read the slot, or a prefetch write it
+	waitDMA2DJob(cacheSlots[slot].job);
+	cacheSlots[slot].pSource = NULL;
+	if(pFrame->compression == RAW_COMPRESSION_RLE16)
+	{
+		if(decodeRLE16(pFrame->data, pFrame->dataSize, (uint16_t*)pSlot, (uint32_t)pFrame->width * pFrame->height) == 0)
+		{
+			return 0;
+		}
+	}
+	else
+	{
+		// the bytes are copied as ARGB8888 pixels (no conversion): whole lines of FRAME_CACHE_COPY_WIDTH words and the rest as one line
+		uint32_t words = (size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+		uint32_t lines = words / FRAME_CACHE_COPY_WIDTH;
+		struct dma2dJob job = {.type = dma2d_copy, .pSrc = pFrame->data, .srcFormat = RAW_FORMAT_ARGB8888, .srcAlpha = 0xFF, .pDst = pSlot, .dstFormat = RAW_FORMAT_ARGB8888,
+							   .width = FRAME_CACHE_COPY_WIDTH, .height = lines};
+
+		if(lines != 0)
+		{
+			addDMA2DJob(&job);
+		}
+		if(words % FRAME_CACHE_COPY_WIDTH != 0)
+		{
+			job.pSrc = (const uint32_t*)pFrame->data + lines * FRAME_CACHE_COPY_WIDTH;
+			job.pDst = (uint32_t*)pSlot + lines * FRAME_CACHE_COPY_WIDTH;
+			job.width = words % FRAME_CACHE_COPY_WIDTH;
+			job.height = 1;
+			addDMA2DJob(&job);
+		}
+		cacheSlots[slot].job = getLastDMA2DJob();
+	}
+	cacheSlots[slot].pSource = pFrame->data;
+	cycles = DWT->CYCCNT - start;
+	totalFillCycles += cycles;
+	fillAmount++;
+	cacheStatistics.maxFillCycles = (cycles > cacheStatistics.maxFillCycles)? cycles : cacheStatistics.maxFillCycles;
+	return 1;
+}
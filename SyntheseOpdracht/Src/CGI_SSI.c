@@ -15,7 +15,7 @@ void fs_close_custom(struct fs_file *file){
 }
 
 
-//cgi handler for receiving and printing incomming message and photo
+//cgi handler for receiving and printing incomming message and photo, and for updating a widget (widget=name&value=content)
 extern void httpd_cgi_handler(struct fs_file *file, const char* uri, int iNumParams,
                               char **pcParam, char **pcValue){
 	for(int i = 0; i < iNumParams; i++){
@@ -33,54 +33,70 @@ extern void httpd_cgi_handler(struct fs_file *file, const char* uri, int iNumPar
 
 			//show photo on lcd screen
 		}
+		if(strcmp(pcParam[i], "widget") == 0){
+			//the new content of the widget is the value parameter, the main loop repaints the widget
+			for(int j = 0; j < iNumParams; j++){
+				if(strcmp(pcParam[j], "value") == 0){
+					updateWidget(pcValue[i], strlen(pcValue[i]), pcValue[j], strlen(pcValue[j]));
+				}
+			}
+		}
 	}
 }
 
 
-//making httpd_cgi_handler the sgi handler
-u16_t mySsiHandler(const char* ssi_tag_name, char *pcInsert, int iInsertLen){
+//inserting one page of images or gifs from the catalog, starting at offset
+static void insertImagePage(char *pcInsert, int iInsertLen, fileExtension extType, uint16_t offset){
+	struct imageCursor cursor;
+	char* page[SSI_IMAGES_PER_PART];
+	int amount_page;
+	int len = strlen(pcInsert);
 
+	openImageCursor(&cursor, extType, a_z, NULL, 0);
+	seekImageCursor(&cursor, offset);
+	amount_page = getImagePage(&cursor, page, SSI_IMAGES_PER_PART);
+	for(int i = 0; i < amount_page && len < iInsertLen; i++){
+		len += snprintf(pcInsert + len, iInsertLen - len, "<img src = '%s' alt = 'photo %d' onclick =\"sendphoto(\'%s\')\" class = '%s'>", page[i]+1, offset + i, page[i]+1, (extType == png)? "photo" : "gif");
+	}
+}
 
-	//insering photo's in webside
-	if(strcmp(ssi_tag_name, "photo") == 0){
-		
-		//getting photo list
-		char* photolist[getImageAmount()];
-		getImageList(photolist, png, a_z);
 
+//making httpd_cgi_handler the sgi handler
+//the photo tag is inserted in multiple parts: part 0 is the photo header, followed by the pages of photo's, the gif header and the pages of gifs
+u16_t mySsiHandler(const char* ssi_tag_name, char *pcInsert, int iInsertLen, u16_t current_tag_part, u16_t *next_tag_part){
 
-		char teststr[2560];
 
-		//adding string that shows how many photo's where detected
-		sprintf(pcInsert, "<h2 class = 'count'>%d Photo's were detected.</h2>", getImageAmount());
+	//insering photo's in webside
+	if(strcmp(ssi_tag_name, "photo") == 0){
 
-		//printing photo's
-		strcat(pcInsert, "<div><p style = 'text-align: center;'>");
-		for(int i = 0; i < getImageAmount(); i++){
+		uint16_t photoParts = (getImageAmount() + SSI_IMAGES_PER_PART - 1) / SSI_IMAGES_PER_PART;
+		uint16_t gifParts = (getGifAmount() + SSI_IMAGES_PER_PART - 1) / SSI_IMAGES_PER_PART;
+		pcInsert[0] = '\0';
 
-			sprintf(teststr, "<img src = '%s' alt = 'photo %d' onclick =\"sendphoto(\'%s\')\" class = 'photo'>",photolist[i]+1, i, photolist[i]+1);
-			strcat(pcInsert, teststr);
+		if(current_tag_part == 0){
+			//adding string that shows how many photo's where detected
+			snprintf(pcInsert, iInsertLen, "<h2 class = 'count'>%d Photo's were detected.</h2><div><p style = 'text-align: center;'>", getImageAmount());
 		}
-		strcat(pcInsert, "</div></p>");
-
-		//getting gif list
-		char* giflist[getGifAmount()];
-		getImageList(giflist, gif, a_z);
-
-		//adding string that shows how many gifs where detected
-		sprintf(teststr, "</br></br><h2 class = 'count'>%d Gifs were detected.</h2>", getGifAmount());
-		strcat(pcInsert, teststr);
-
-		//printing gifs
-		strcat(pcInsert, "<div><p style = 'text-align: center;'>");
-		for(int i = 0; i < getGifAmount(); i++){
-
-			sprintf(teststr, "<img src = '%s' alt = 'photo %d' onclick =\"sendphoto(\'%s\')\" class = 'gif'>",giflist[i]+1, i, giflist[i]+1);
-			strcat(pcInsert, teststr);
+		else if(current_tag_part <= photoParts){
+			//printing photo's
+			insertImagePage(pcInsert, iInsertLen, png, (current_tag_part - 1) * SSI_IMAGES_PER_PART);
+		}
+		else if(current_tag_part == photoParts + 1){
+			//adding string that shows how many gifs where detected
+			snprintf(pcInsert, iInsertLen, "</div></p></br></br><h2 class = 'count'>%d Gifs were detected.</h2><div><p style = 'text-align: center;'>", getGifAmount());
+		}
+		else if(current_tag_part <= photoParts + 1 + gifParts){
+			//printing gifs
+			insertImagePage(pcInsert, iInsertLen, gif, (current_tag_part - photoParts - 2) * SSI_IMAGES_PER_PART);
+		}
+		else{
+			snprintf(pcInsert, iInsertLen, "</div></p>");
 		}
-		strcat(pcInsert, "</div></p>");
-
 
+		//the handler is called again for the next part until the closing tags are inserted
+		if(current_tag_part <= photoParts + 1 + gifParts){
+			*next_tag_part = current_tag_part + 1;
+		}
 	}
 
 	return strlen(pcInsert);
@@ -0,0 +1,352 @@
+/*!
+ *  \file DMA2D_functions.c
+ *	\details This file contains the DMA2D job queue. A job is started as soon as the DMA2D is free: by addDMA2DJob when the queue was empty,
+ *			 otherwise by the transfer complete interrupt of the previous job. The registers are written directly and only when their value changes,
+ *			 so a job doesn't need HAL_DMA2D_Init and HAL_DMA2D_ConfigLayer. A CLUT is loaded by the DMA2D itself before the job is started,
+ *			 the CLUT transfer complete interrupt then starts the job.
+ *  \remark The queue is changed with interrupts disabled, so jobs can be added from the main loop and from interrupts.
+ */
+#include "DMA2D_functions.h"
+
+static void startJob(const struct dma2dJob* pJob);
+static uint32_t convertColor(uint32_t color, uint8_t dstFormat);
+
+// the jobs are started in the order they were added, the job at queueTail is running as long as queueCount isn't 0
+static struct dma2dJob jobQueue[DMA2D_QUEUE_LENGTH];
+static volatile uint8_t queueHead = 0;
+static volatile uint8_t queueTail = 0;
+static volatile uint8_t queueCount = 0;
+
+// the last values that were written to the configuration registers
+static uint32_t lastFgpfccr = 0;
+static uint32_t lastBgpfccr = 0;
+static uint32_t lastOpfccr = 0;
+static uint32_t lastFgor = 0;
+static uint32_t lastBgor = 0;
+static uint32_t lastOor = 0;
+
+// amount of jobs that ended with a transfer, configuration or CLUT access error
+static volatile uint32_t dma2dErrors = 0;
+// every job gets the next number when it is added, the jobs are done in the same order
+static volatile uint32_t addedJobs = 0;
+static volatile uint32_t doneJobs = 0;
+
+// the CLUT that is loaded in the DMA2D, NULL when it is unknown
+static const uint32_t* pLoadedClut = NULL;
+// 1 while the CLUT of the running job is loaded, the job itself is started when it is done
+static volatile uint8_t clutLoading = 0;
+// control register of the running job, written when its CLUT is loaded
+static uint32_t clutJobControl = 0;
+
+/*!
+ * \brief Writes the registers to the reset value of the DMA2D and enables its interrupt.
+ *
+ * \param void
+ *
+ * \retval void
+ *
+ * \note the DMA2D clock has to be enabled (MX_DMA2D_Init), call it before anything is drawn
+ */
+void initDMA2D(void)
+{
+	DMA2D->FGPFCCR = lastFgpfccr;
+	DMA2D->BGPFCCR = lastBgpfccr;
+	DMA2D->OPFCCR = lastOpfccr;
+	DMA2D->FGOR = lastFgor;
+	DMA2D->BGOR = lastBgor;
+	DMA2D->OOR = lastOor;
+	DMA2D->IFCR = DMA2D_IFCR_CTCIF | DMA2D_IFCR_CTEIF | DMA2D_IFCR_CCEIF | DMA2D_IFCR_CCTCIF | DMA2D_IFCR_CAECIF;
+	HAL_NVIC_SetPriority(DMA2D_IRQn, DMA2D_IRQ_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(DMA2D_IRQn);
+}
+
+/*!
+ * \brief Adds a job to the queue and starts it when the DMA2D is free.
+ *
+ * \param pJob -> the job, it is copied into the queue
+ *
+ * \retval 1 when the job is queued.
+ * \retval 0 when the job has an invalid size or offset.
+ *
+ * \note when the queue is full this waits until the oldest job is done, this also works from an interrupt with a higher priority than the DMA2D interrupt
+ */
+uint8_t addDMA2DJob(const struct dma2dJob* pJob)
+{
+	uint32_t primask;
+
+	if(pJob->width == 0 || pJob->height == 0 || pJob->width > DMA2D_MAX_WIDTH || pJob->srcOffset > DMA2D_MAX_OFFSET || pJob->backgroundOffset > DMA2D_MAX_OFFSET || pJob->dstOffset > DMA2D_MAX_OFFSET
+			|| (pJob->pClut != NULL && (pJob->clutSize == 0 || pJob->clutSize > DMA2D_MAX_CLUT_SIZE)))
+	{
+		return 0;
+	}
+	while(1)
+	{
+		primask = __get_PRIMASK();
+		__disable_irq();
+		if(queueCount < DMA2D_QUEUE_LENGTH)
+		{
+			break;
+		}
+		__set_PRIMASK(primask);
+		serviceDMA2D();
+	}
+	jobQueue[queueHead] = *pJob;
+	queueHead = (queueHead + 1) % DMA2D_QUEUE_LENGTH;
+	queueCount++;
+	addedJobs++;
+	// the DMA2D was free, otherwise the interrupt starts the job
+	if(queueCount == 1)
+	{
+		startJob(&jobQueue[queueTail]);
+	}
+	__set_PRIMASK(primask);
+	return 1;
+}
+
+/*!
+ * \brief Finishes the running job when the DMA2D is done and starts the next one. It is the DMA2D interrupt handler, but it can also be called to poll.
+ *
+ * \param void
+ *
+ * \retval void
+ */
+void serviceDMA2D(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t status;
+	void (*pDone)(void);
+
+	__disable_irq();
+	status = DMA2D->ISR & (DMA2D_ISR_TCIF | DMA2D_ISR_TEIF | DMA2D_ISR_CEIF | DMA2D_ISR_CTCIF | DMA2D_ISR_CAEIF);
+	if(queueCount != 0 && status != 0)
+	{
+		DMA2D->IFCR = status;
+		if(clutLoading)
+		{
+			clutLoading = 0;
+			// the CLUT is loaded, the job itself can start
+			if(status == DMA2D_ISR_CTCIF)
+			{
+				DMA2D->CR = clutJobControl;
+				__set_PRIMASK(primask);
+				return;
+			}
+			// the job isn't started when its CLUT couldn't be loaded
+			pLoadedClut = NULL;
+		}
+		if(status != DMA2D_ISR_TCIF)
+		{
+			dma2dErrors++;
+		}
+		pDone = jobQueue[queueTail].pDone;
+		queueTail = (queueTail + 1) % DMA2D_QUEUE_LENGTH;
+		queueCount--;
+		doneJobs++;
+		if(queueCount != 0)
+		{
+			startJob(&jobQueue[queueTail]);
+		}
+		// the callback runs after the next job is started, so the DMA2D keeps drawing
+		if(pDone != NULL)
+		{
+			pDone();
+		}
+	}
+	__set_PRIMASK(primask);
+}
+
+/*!
+ * \brief Waits until all queued jobs are done.
+ *
+ * \param void
+ *
+ * \retval void
+ *
+ * \note call it before the CPU reads or writes memory that a queued job uses
+ */
+void waitDMA2D(void)
+{
+	while(queueCount != 0)
+	{
+		serviceDMA2D();
+	}
+}
+
+/*!
+ * \brief Returns the number of the job that was added last.
+ *
+ * \param void
+ *
+ * \return the job number, 0 before the first job is added
+ *
+ * \note call it right after addDMA2DJob, from the main loop, to know when the CPU can reuse the memory of the job
+ */
+uint32_t getLastDMA2DJob(void)
+{
+	return addedJobs;
+}
+
+/*!
+ * \brief Checks if a job is done.
+ *
+ * \param job -> the job number (getLastDMA2DJob)
+ *
+ * \retval 1 when the job is done (also when it ended with an error).
+ * \retval 0 when the job is queued or running.
+ */
+uint8_t isDMA2DJobDone(uint32_t job)
+{
+	// the numbers wrap around, a job is done when doneJobs has reached it
+	return ((int32_t)(doneJobs - job) >= 0)? 1 : 0;
+}
+
+/*!
+ * \brief Waits until a job is done, the jobs that were added after it keep running.
+ *
+ * \param job -> the job number (getLastDMA2DJob)
+ *
+ * \retval void
+ */
+void waitDMA2DJob(uint32_t job)
+{
+	while(isDMA2DJobDone(job) == 0)
+	{
+		serviceDMA2D();
+	}
+}
+
+/*!
+ * \brief Returns the amount of jobs that ended with a transfer or configuration error.
+ *
+ * \param void
+ *
+ * \return the amount of failed jobs since startup
+ */
+uint32_t getDMA2DErrors(void)
+{
+	return dma2dErrors;
+}
+
+/*!
+ * \brief Writes the registers of a job and starts the DMA2D, or starts loading the CLUT of the job first.
+ *
+ * \param pJob -> the job that is started
+ *
+ * \retval void
+ *
+ * \note has to be called with interrupts disabled
+ */
+static void startJob(const struct dma2dJob* pJob)
+{
+	uint32_t mode;
+	uint32_t fgpfccr = lastFgpfccr;
+	uint32_t bgpfccr = lastBgpfccr;
+	uint32_t opfccr = (uint32_t)pJob->dstFormat << DMA2D_OPFCCR_CM_Pos;
+	uint32_t fgor = lastFgor;
+	uint32_t bgor = lastBgor;
+
+	if(pJob->type == dma2d_fill)
+	{
+		mode = DMA2D_R2M;
+		DMA2D->OCOLR = convertColor(pJob->color, pJob->dstFormat);
+	}
+	else
+	{
+		mode = (pJob->type == dma2d_blend)? DMA2D_M2M_BLEND : DMA2D_M2M_PFC;
+		fgpfccr = ((uint32_t)pJob->srcFormat << DMA2D_FGPFCCR_CM_Pos) | ((uint32_t)pJob->srcAlpha << DMA2D_FGPFCCR_ALPHA_Pos) | (((pJob->srcAlpha == 0xFF)? DMA2D_NO_MODIF_ALPHA : DMA2D_COMBINE_ALPHA) << DMA2D_FGPFCCR_AM_Pos);
+		fgor = pJob->srcOffset;
+		DMA2D->FGMAR = (uint32_t)pJob->pSrc;
+		if(pJob->type == dma2d_blend)
+		{
+			bgpfccr = (uint32_t)pJob->backgroundFormat << DMA2D_BGPFCCR_CM_Pos;
+			bgor = pJob->backgroundOffset;
+			DMA2D->BGMAR = (uint32_t)pJob->pBackground;
+		}
+		// an A8 or A4 source only holds the alpha, every pixel has the color of the job
+		if(pJob->srcFormat == RAW_FORMAT_A8 || pJob->srcFormat == RAW_FORMAT_A4)
+		{
+			DMA2D->FGCOLR = pJob->color & 0x00FFFFFF;
+		}
+		// ARGB8888 CLUT (CCM 0) of clutSize entries
+		if(pJob->pClut != NULL)
+		{
+			fgpfccr |= (uint32_t)(pJob->clutSize - 1) << DMA2D_FGPFCCR_CS_Pos;
+		}
+	}
+
+	// the configuration of a gif or a text is the same for every job, so these registers are mostly left unchanged
+	if(fgpfccr != lastFgpfccr)
+	{
+		DMA2D->FGPFCCR = fgpfccr;
+		lastFgpfccr = fgpfccr;
+	}
+	if(bgpfccr != lastBgpfccr)
+	{
+		DMA2D->BGPFCCR = bgpfccr;
+		lastBgpfccr = bgpfccr;
+	}
+	if(opfccr != lastOpfccr)
+	{
+		DMA2D->OPFCCR = opfccr;
+		lastOpfccr = opfccr;
+	}
+	if(fgor != lastFgor)
+	{
+		DMA2D->FGOR = fgor;
+		lastFgor = fgor;
+	}
+	if(bgor != lastBgor)
+	{
+		DMA2D->BGOR = bgor;
+		lastBgor = bgor;
+	}
+	if(pJob->dstOffset != lastOor)
+	{
+		DMA2D->OOR = pJob->dstOffset;
+		lastOor = pJob->dstOffset;
+	}
+	DMA2D->OMAR = (uint32_t)pJob->pDst;
+	DMA2D->NLR = ((uint32_t)pJob->width << DMA2D_NLR_PL_Pos) | pJob->height;
+	// the frames of a gif share their CLUT, so it is only loaded when it changes
+	if(pJob->type != dma2d_fill && pJob->pClut != NULL && pJob->pClut != pLoadedClut)
+	{
+		clutJobControl = mode | DMA2D_CR_TCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE | DMA2D_CR_CTCIE | DMA2D_CR_CAEIE | DMA2D_CR_START;
+		clutLoading = 1;
+		pLoadedClut = pJob->pClut;
+		DMA2D->FGCMAR = (uint32_t)pJob->pClut;
+		DMA2D->CR = DMA2D_CR_TCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE | DMA2D_CR_CTCIE | DMA2D_CR_CAEIE;
+		DMA2D->FGPFCCR = fgpfccr | DMA2D_FGPFCCR_START;
+		return;
+	}
+	DMA2D->CR = mode | DMA2D_CR_TCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE | DMA2D_CR_CTCIE | DMA2D_CR_CAEIE | DMA2D_CR_START;
+}
+
+/*!
+ * \brief Converts an ARGB8888 color to the output format of the DMA2D, like HAL_DMA2D_Start does for a register to memory transfer.
+ *
+ * \param color -> ARGB8888 color
+ * \param dstFormat -> output format (RAW_FORMAT_ARGB8888 up to RAW_FORMAT_ARGB4444)
+ *
+ * \return the color in the output format
+ */
+static uint32_t convertColor(uint32_t color, uint8_t dstFormat)
+{
+	uint32_t alpha = (color >> 24) & 0xFF;
+	uint32_t red = (color >> 16) & 0xFF;
+	uint32_t green = (color >> 8) & 0xFF;
+	uint32_t blue = color & 0xFF;
+
+	switch(dstFormat)
+	{
+	case RAW_FORMAT_RGB888:
+		return color & 0x00FFFFFF;
+	case RAW_FORMAT_RGB565:
+		return ((red >> 3) << 11) | ((green >> 2) << 5) | (blue >> 3);
+	case RAW_FORMAT_ARGB1555:
+		return ((alpha >> 7) << 15) | ((red >> 3) << 10) | ((green >> 3) << 5) | (blue >> 3);
+	case RAW_FORMAT_ARGB4444:
+		return ((alpha >> 4) << 12) | ((red >> 4) << 8) | ((green >> 4) << 4) | (blue >> 4);
+	default:
+		return color;
+	}
+}
@@ -0,0 +1,231 @@
+/*!
+ *  \file LAYOUT_functions.c
+ *	\details This file contains the text layout. layoutText reads every byte of the text once: it remembers the last space of the line that is being filled,
+ *			 so when a character doesn't fit anymore the line ends at that space without going back through the text. A word that is longer than a line is
+ *			 broken with a '-'. A newline ('\n', '\r' or "\r\n") always ends a line and a tab is a space. The letters of an ASCII word only have to be counted,
+ *			 so most bytes cost a few instructions.
+ *  \remark The file doesn't use the HAL, so it is also compiled on the host by the benchmark (Benchmark/text_layout_bench.c).
+ */
+#include "LAYOUT_functions.h"
+
+static uint8_t addLine(struct textLayout* pLayout, uint16_t start, uint16_t end, uint16_t chars, uint8_t hyphen);
+
+/*!
+ * \brief Decodes one character of a UTF-8 text.
+ *
+ * \param ppText -> pointer to the first byte of the character, it points to the next character afterwards
+ * \param pEnd -> the end of the text, a character isn't read past it
+ *
+ * \return the code point of the character
+ * \return UTF8_INVALID_CHAR for an invalid, overlong or incomplete sequence, the bytes that belong to it are skipped
+ */
+uint32_t decodeUTF8(const char** ppText, const char* pEnd)
+{
+	const uint8_t* pByte = (const uint8_t*)*ppText;
+	uint32_t character = *pByte++;
+	uint32_t minimum;
+	uint8_t followBytes;
+
+	if(character < 0x80)
+	{
+		*ppText = (const char*)pByte;
+		return character;
+	}
+	// the first byte tells the amount of bytes that follow, every following byte is 10xxxxxx
+	if((character & 0xE0) == 0xC0)
+	{
+		followBytes = 1;
+		character &= 0x1F;
+		minimum = 0x80;
+	}
+	else if((character & 0xF0) == 0xE0)
+	{
+		followBytes = 2;
+		character &= 0x0F;
+		minimum = 0x800;
+	}
+	else if((character & 0xF8) == 0xF0)
+	{
+		followBytes = 3;
+		character &= 0x07;
+		minimum = 0x10000;
+	}
+	else
+	{
+		*ppText = (const char*)pByte;
+		return UTF8_INVALID_CHAR;
+	}
+	for(uint8_t byte = 0; byte < followBytes; byte++)
+	{
+		if(pByte == (const uint8_t*)pEnd || (*pByte & 0xC0) != 0x80)
+		{
+			*ppText = (const char*)pByte;
+			return UTF8_INVALID_CHAR;
+		}
+		character = (character << 6) | (*pByte++ & 0x3F);
+	}
+	*ppText = (const char*)pByte;
+	// a character can only be encoded in the shortest way, surrogates aren't characters
+	if(character < minimum || character > 0x10FFFF || (character >= 0xD800 && character <= 0xDFFF))
+	{
+		return UTF8_INVALID_CHAR;
+	}
+	return character;
+}
+
+/*!
+ * \brief Breaks a UTF-8 text into lines.
+ *
+ * \param pLayout -> filled with the lines, it points into the text, so the text has to stay as long as the layout is used
+ * \param pText -> the text, it doesn't need a '\0'
+ * \param length -> the length of the text in bytes
+ * \param charsOnLine -> the amount of characters that fit on a line, at least 2
+ *
+ * \return the amount of lines, pLayout->truncated is set when the text has more than TEXT_LAYOUT_MAX_LINES lines
+ */
+uint16_t layoutText(struct textLayout* pLayout, const char* pText, uint16_t length, uint16_t charsOnLine)
+{
+	const char* pNext = pText;
+	const char* pEnd = pText + length;
+	// the line that is being filled
+	const char* pLineStart = pText;
+	uint16_t lineChars = 0;
+	// the last character of the line, a word that is longer than a line is broken before it
+	const char* pLastChar = pText;
+	// the last space of the line and the amount of characters before it, NULL when the line has no space
+	const char* pSpace = NULL;
+	uint16_t spaceChars = 0;
+
+	pLayout->pText = pText;
+	pLayout->textLength = length;
+	pLayout->lineAmount = 0;
+	pLayout->truncated = 0;
+	if(charsOnLine < 2)
+	{
+		return 0;
+	}
+	while(pNext < pEnd)
+	{
+		const char* pChar = pNext;
+		// the characters before pFitEnd still fit on the line
+		const char* pFitEnd = (pEnd - pNext > charsOnLine - lineChars)? pNext + (charsOnLine - lineChars) : pEnd;
+		uint32_t character;
+
+		// printable ASCII characters that fit on the line are only counted, the last space is remembered as the place to break the line
+		// without a branch, so the end of every word doesn't cost a mispredicted branch
+		while(pNext < pFitEnd && (uint8_t)(*pNext - ' ') <= ('~' - ' '))
+		{
+			pSpace = (*pNext == ' ')? pNext : pSpace;
+			pNext++;
+		}
+		if(pNext != pChar)
+		{
+			if(pSpace != NULL && pSpace >= pChar)
+			{
+				spaceChars = lineChars + (pSpace - pChar);
+			}
+			lineChars += pNext - pChar;
+			pLastChar = pNext - 1;
+			continue;
+		}
+		character = (uint8_t)*pNext;
+		if(character < 0x80)
+		{
+			pNext++;
+		}
+		else
+		{
+			character = decodeUTF8(&pNext, pEnd);
+		}
+
+		if(character == '\n' || character == '\r')
+		{
+			// "\r\n" is one newline
+			if(character == '\r' && pNext < pEnd && *pNext == '\n')
+			{
+				pNext++;
+			}
+			if(addLine(pLayout, pLineStart - pText, pChar - pText, lineChars, 0) == 0)
+			{
+				return pLayout->lineAmount;
+			}
+			pLineStart = pNext;
+			lineChars = 0;
+			pSpace = NULL;
+			continue;
+		}
+		if(lineChars == charsOnLine)
+		{
+			if(character == ' ' || character == '\t')
+			{
+				// the line is full exactly at a space, the space isn't drawn
+				if(addLine(pLayout, pLineStart - pText, pChar - pText, lineChars, 0) == 0)
+				{
+					return pLayout->lineAmount;
+				}
+				pLineStart = pNext;
+				lineChars = 0;
+				pSpace = NULL;
+				continue;
+			}
+			else if(pSpace != NULL)
+			{
+				// the line ends at its last space and the word after it goes to the next line
+				if(addLine(pLayout, pLineStart - pText, pSpace - pText, spaceChars, 0) == 0)
+				{
+					return pLayout->lineAmount;
+				}
+				pLineStart = pSpace + 1;
+				lineChars -= spaceChars + 1;
+			}
+			else
+			{
+				// a '-' takes the place of the last character, that character goes to the next line
+				if(addLine(pLayout, pLineStart - pText, pLastChar - pText, lineChars - 1, 1) == 0)
+				{
+					return pLayout->lineAmount;
+				}
+				pLineStart = pLastChar;
+				lineChars = 1;
+			}
+			pSpace = NULL;
+		}
+		if(character == ' ' || character == '\t')
+		{
+			pSpace = pChar;
+			spaceChars = lineChars;
+		}
+		pLastChar = pChar;
+		lineChars++;
+	}
+	// a text that ends with a newline has no empty line at the end
+	if(pLineStart < pEnd)
+	{
+		addLine(pLayout, pLineStart - pText, length, lineChars, 0);
+	}
+	return pLayout->lineAmount;
+}
+
+/*!
+ * \brief Adds a line to the layout.
+ *
+ * \param pLayout -> the layout
+ * \param start -> offset of the first byte of the line
+ * \param end -> offset of the first byte after the line
+ * \param chars -> the amount of characters of the line
+ * \param hyphen -> 1 when a '-' is drawn after the line
+ *
+ * \retval 1 when the line is added.
+ * \retval 0 when the layout has no room for the line, it is truncated then.
+ */
+static uint8_t addLine(struct textLayout* pLayout, uint16_t start, uint16_t end, uint16_t chars, uint8_t hyphen)
+{
+	if(pLayout->lineAmount == TEXT_LAYOUT_MAX_LINES)
+	{
+		pLayout->truncated = 1;
+		return 0;
+	}
+	pLayout->lines[pLayout->lineAmount] = (struct textSpan){.start = start, .length = end - start, .chars = chars, .hyphen = hyphen};
+	pLayout->lineAmount++;
+	return 1;
+}
@@ -10,8 +10,9 @@
 
 //declaration of used variables
 
-// error message that will be displayed on the LCD when there is something wrong with the text
-static char errorMessageText[TEXT_BUFFER_LENGTH] = "something went wrong while printing the string (see Serial terminal for more info)";
+// the picture that is shown when something is wrong with an image
+static const struct imageMetaData errorPictureMetaData = {.name = "errorPicture", .data = (void*)ERROR_PICTURE_DATA, .width = ERROR_PICTURE_DATA_X_PIXEL, .height = ERROR_PICTURE_DATA_Y_PIXEL, .num = 1,
+														  .pixelFormat = RAW_FORMAT_ARGB1555, .dataSize = sizeof(ERROR_PICTURE_DATA)};
 
 // timerhandler for hardware timer
 extern TIM_HandleTypeDef htim2;
@@ -25,26 +26,177 @@ extern uint32_t ScreensaverStart;
 // var to store how many chars fit on one line
 uint8_t charsOnLine;
 
-// struct to save picture data that is currently displayed
-struct imageMetaData currentPicture;
+// copy of the text that is shown, the lines of its layout point into it
+static char shownText[TEXT_MAX_LENGTH];
+static struct textLayout shownLayout;
+static uint32_t shownTextColor = LCD_COLOR_WHITE;
+// the pixel line of the text that is at the top of the text window
+static uint16_t textScroll = 0;
+// time (HAL_GetTick) of the next scroll step
+static uint32_t nextScrollTime = 0;
 
-// list of all frames of one gif
-char* frameList[MAX_GIF_FRAMES];
+// struct to save everything the frame scheduler needs to show a gif
+struct gifPlayback
+{
+	// picture data that is currently displayed
+	struct imageMetaData picture;
+	// resolved frames of the gif (data pointer, dimensions and frame time), stored next to each other in the catalog
+	const struct imageMetaData* frames;
+	// the amount of frames of the gif, 0 when no gif is shown
+	uint16_t frameAmount;
+	// the catalog the frames point into, it is acquired as long as the gif is shown
+	struct catalogSnapshot* pCatalog;
+	// version of that catalog, to detect when the file system catalog was rebuilt
+	uint32_t catalogVersion;
+};
+
+// the playback is double buffered: a new playback is filled in the buffer that isn't shown and then published with one pointer write
+// so the frame scheduler always reads a complete playback
+static struct gifPlayback gifPlaybacks[2];
+static struct gifPlayback* volatile pShownPlayback = &gifPlaybacks[0];
+
+// to itterate over all gif frames, only changed by the frame scheduler or when a new gif is started
+uint16_t frameCounter;
+
+// absolute deadline of the next gif frame in frame timer ticks, the deadline of a frame is the deadline of the previous frame plus its frame time
+static uint32_t nextDeadline = 0;
+// deadline and frame time of the frame that is being drawn, frameDone measures the timing error with it
+static volatile uint8_t timedFramePending = 0;
+static uint32_t pendingDeadline = 0;
+static uint32_t pendingFrameTime = 0;
+// timing of the drawn gif frames, the errors are summed in frame timer ticks
+static struct frameStatistics frameStatistics;
+static uint64_t totalErrorTicks = 0;
+
+// the picture area, the area of a transition and the zone of the pictures in the widget layout
+static const struct rawDirtyRect pictureArea = {.x = PICTURE_X, .y = PICTURE_Y, .width = PICTURE_WIDTH, .height = PICTURE_HEIGHT};
+// refreshes of the LCD since startup, counted by the line interrupt, and the refresh the widgets were composed in
+static volatile uint32_t refreshCount = 0;
+static uint32_t composedRefresh = 0;
+
+#if DOUBLE_BUFFER
+// framebuffers of the foreground layer, the LTDC shows one of them and the frames are drawn in the other one
+static const uint32_t layerBuffers[2] = {LCD_FB_START_ADDRESS, LCD_BACK_BUFFER_ADDRESS};
+// index of the buffer that is shown (or will be shown after the pending reload), only changed by frameDone
+static volatile uint8_t shownBuffer = 0;
+// 1 from the moment a frame is queued until its buffer is flipped
+static volatile uint8_t flipPending = 0;
+#if DELTA_FRAMES
+// index of the gif frame each buffer holds, NO_GIF_FRAME when it holds something else, only changed by the main loop
+static uint16_t bufferFrames[2] = {NO_GIF_FRAME, NO_GIF_FRAME};
+#endif
+#endif
+
+#if PICTURE_TRANSITIONS
+// the index getLayerBuffer and startFrame use for the buffer of the new picture of a transition
+#define TRANSITION_BUFFER LCD_BUFFER_AMOUNT
+// drawing: the new picture is drawn in the transition buffer, running: every refresh a step is drawn, finishing: the new picture is copied to the other buffer
+typedef enum {transition_idle, transition_drawing, transition_running, transition_finishing} transitionPhase;
+
+static volatile transitionPhase transitionState = transition_idle;
+// the transition and its time in frame timer ticks, read by the LTDC interrupt
+static transitionType transitionKind = TRANSITION_TYPE;
+static uint32_t transitionTime = TRANSITION_TIME * FRAME_TIMER_TICKS_PER_MS;
+static uint32_t transitionStart = 0;
+// timing of the steps of the last transition, the render times are summed in cycles
+static struct transitionStatistics transitionStatistics;
+static uint32_t totalStepCycles = 0;
+// cycle counter when the step was queued and at the previous line interrupt
+static uint32_t stepStart = 0;
+static uint32_t lastLineCycles = 0;
+// 1 when a transition is done and its timing isn't printed yet
+static volatile uint8_t transitionFinished = 0;
+#endif
 
-// store the amount of frames of the gif
-uint8_t frameAmount;
-// to itterate over all gif frames
-uint8_t frameCounter;
+// the area of the picture half of every buffer that isn't transparent (the pictures and gif frames that were drawn in it), only changed by the main loop
+// and by the steps of a transition, a width of 0 means the whole picture half is transparent. With PICTURE_TRANSITIONS the last one is the transition buffer.
+static struct rawDirtyRect pictureDamage[LCD_BUFFER_AMOUNT + PICTURE_TRANSITIONS];
+// the area of the text window that isn't transparent, it is the same in both buffers
+static struct rawDirtyRect textDamage;
+// the picture that is being scaled, its column tables are too large for the stack
+static struct scaleJob pictureScaler;
+#if LAYER_PICTURES
+// 1 when the background layer shows a picture
+static uint8_t layerPictureShown = 0;
+// the CLUT that is loaded in the background layer
+static const uint32_t* pLayerClut = NULL;
+// the picture the background layer shows, a transition starts from it
+static struct imageMetaData layerPicture;
+#if PICTURE_TRANSITIONS
+// the background layer takes over the new picture of a transition: waiting until both buffers show it, then until the LTDC has loaded the layer
+typedef enum {handoff_none, handoff_waiting, handoff_reloading} layerHandoffPhase;
 
+static layerHandoffPhase layerHandoff = handoff_none;
+static struct imageMetaData handoffPicture;
+#endif
+#endif
 
-/* print one frame/picture to the LCD */
-static void frameToLCD(void* data, uint16_t width, uint16_t height);
-/* sets the time for the timer interrupt routine */
-static void setTimer_ms(uint16_t time_ms);
-/* start timer to receive timer interrupts */
-static void startTimer(void);
-/* stop timer to receive no more timer interrupts */
-static void stopTimer(void);
+#if MEASURE_BLIT_TIME
+// cycle counter when the measured frame was queued
+static volatile uint32_t blitStart = 0;
+// cycles the DMA2D needed to draw the measured frames, written by frameDone (from the DMA2D interrupt)
+static volatile uint32_t blitCycles = 0;
+static volatile uint32_t blitCyclesMax = 0;
+static volatile uint32_t blitFrames = 0;
+#endif
+
+
+/* fill the playback that isn't shown and publish it */
+static uint16_t publishPlayback(struct imageMetaData picture);
+/* print a picture that isn't a gif to the LCD */
+static uint8_t stillPictureToLCD(const struct imageMetaData* pPicture, uint8_t scalable);
+/* print one frame/picture (or an area of it) to the LCD */
+static void frameToLCD(const struct imageMetaData* pPicture, void* data, const struct rawDirtyRect* pArea, uint16_t frameIndex);
+/* scale a picture and print it to the LCD */
+static uint8_t scaledFrameToLCD(const struct imageMetaData* pPicture, uint16_t width, uint16_t height);
+/* wait until a frame can be drawn and prepare the buffer it is drawn in */
+static uint8_t startFrame(const struct rawDirtyRect* pFrameArea, uint16_t frameIndex);
+/* queue a DMA2D job that draws (a part of) a frame in a buffer */
+static void addFrameJob(struct dma2dJob* pJob, uint8_t buffer);
+/* calculates the area of a gif frame that changed since the frame in the back buffer */
+static uint8_t getDeltaArea(const struct gifPlayback* pPlayback, uint16_t frameIndex, struct rawDirtyRect* pArea);
+/* called by the DMA2D queue when a frame is drawn */
+static void frameDone(void);
+/* flips the buffers of the foreground layer in the next vertical blanking */
+static void flipBuffers(void);
+/* checks if a frame can be drawn without waiting */
+static uint8_t frameBufferFree(void);
+/* copy an area of the buffer that is drawn in to the other buffer */
+static void syncBuffers(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+/* draw pixel lines of the text window */
+static void drawTextRows(uint16_t firstRow, uint16_t rowAmount, struct rawDirtyRect* pChanged);
+/* returns the address of a framebuffer of the foreground layer */
+static uint32_t getLayerBuffer(uint8_t buffer);
+/* fills an area of a buffer with a color */
+static void fillArea(uint32_t address, const struct rawDirtyRect* pArea, uint32_t color);
+/* makes an area of a framebuffer of the foreground layer transparent */
+static void fillTransparent(uint8_t buffer, const struct rawDirtyRect* pArea);
+/* makes the picture area of a framebuffer transparent, except for the part that is drawn again */
+static void clearPictureDamage(uint8_t buffer, const struct rawDirtyRect* pKeep);
+/* returns the area two areas have in common */
+static struct rawDirtyRect intersectAreas(const struct rawDirtyRect* pFirst, const struct rawDirtyRect* pSecond);
+/* grows an area until it also holds another area */
+static void addArea(struct rawDirtyRect* pArea, const struct rawDirtyRect* pAdd);
+#if LAYER_PICTURES
+/* show a picture with the background layer */
+static uint8_t showLayerPicture(const struct imageMetaData* pPicture);
+/* load the registers of the background layer for a picture */
+static void loadLayerPicture(const struct imageMetaData* pPicture);
+/* stop showing a picture with the background layer */
+static void hideLayerPicture(void);
+#endif
+#if PICTURE_TRANSITIONS
+/* draw the old picture in the transition buffer and draw the new picture from now on in the transition buffer */
+static void startTransition(void);
+/* start the steps of a transition once the new picture is queued */
+static void runTransition(void);
+/* stop the steps of a transition */
+static void stopTransition(void);
+/* called by the DMA2D queue when a step is drawn */
+static void transitionStepDone(void);
+#endif
+/* returns the time of the free running frame timer */
+static uint32_t getFrameTimer(void);
 
 /*!
  * \brief LCD Initialization for normal operation.
@@ -52,20 +204,39 @@ static void stopTimer(void);
  * \param void
  *
  * \retval void
- *
- *  \remark please make sure there are no words longer then 25 characters in the string.
  */
 void initLCD(void)
 {
+	  // everything is drawn with the DMA2D job queue
+	  initDMA2D();
+	  // the frames are drawn from the SDRAM after they are used once
+	  initFrameCache(FRAME_CACHE_ADDRESS, FRAME_CACHE_SIZE);
+	  // TIM2 runs free over its whole 32 bit range as timebase for the gif frames, no interrupts are needed
+	  __HAL_TIM_SET_PRESCALER(&htim2, FRAME_TIMER_PRESCALER - 1);
+	  __HAL_TIM_SET_AUTORELOAD(&htim2, 0xFFFFFFFF);
+	  HAL_TIM_GenerateEvent(&htim2, TIM_EVENTSOURCE_UPDATE);
+	  HAL_TIM_Base_Start(&htim2);
 	  BSP_LCD_Init();
 	  BSP_LCD_LayerDefaultInit(1, LCD_FB_START_ADDRESS );
 	  BSP_LCD_LayerDefaultInit(0, (LCD_FB_START_ADDRESS+(LCD_WIDTH*LCD_HEIGHT*4 )));
 
 	  BSP_LCD_DisplayOn();
+	  // the line interrupt at the first line of the vertical blanking counts the refreshes and starts the steps of a transition
+	  LTDC->LIPCR = (LTDC->AWCR & LTDC_AWCR_AAH) + 1;
+	  LTDC->ICR = LTDC_ICR_CLIF;
+	  LTDC->IER |= LTDC_IER_LIE;
+	  HAL_NVIC_SetPriority(LTDC_IRQn, LTDC_IRQ_PRIORITY, 0);
+	  HAL_NVIC_EnableIRQ(LTDC_IRQn);
 
+#if LAYER_PICTURES
+	  // the background layer only shows pictures, the background color of the LTDC (white) is shown around them
+	  LTDC->BCCR = LCD_COLOR_WHITE & 0x00FFFFFF;
+	  BSP_LCD_SetLayerVisible(PICTURE_LAYER, DISABLE);
+#else
 	  // background layer is now white
 	  BSP_LCD_SelectLayer(0);
 	  BSP_LCD_Clear(LCD_COLOR_WHITE);
+#endif
 
 
 	  // text and pictures will be displayed on foreground layer
@@ -76,23 +247,42 @@ void initLCD(void)
 
 	  // select proper font
 	  BSP_LCD_SetFont(&Font12);
+	  // the text is drawn by the DMA2D from a glyph atlas of the font
+	  initTextAtlas(&Font12);
 	  // calculate the amount of chars that fit on one line
 	  charsOnLine = ((LCD_WIDTH-11)/2)/Font12.Width;
 
-	  // draw line in the middle of the screen to devide screen in two parts
-	  BSP_LCD_SetTextColor(LCD_COLOR_BLACK);
-	  BSP_LCD_DrawLine(LCD_WIDTH/2-1, 0, LCD_WIDTH/2-1, LCD_HEIGHT);
+	  // the back buffer starts with the same (cleared) content
+	  syncBuffers(0, 0, LCD_WIDTH, LCD_HEIGHT);
+
+	  // the text window and the picture area are drawn by the functions below, the compositor keeps the other widgets out of them
+	  createWidget(widget_zone, "text", 0, TEXT_Y, TEXT_WINDOW_WIDTH, TEXT_WINDOW_HEIGHT, 0);
+	  createWidget(widget_zone, "picture", pictureArea.x, pictureArea.y, pictureArea.width, pictureArea.height, 0);
+	  // line in the middle of the screen to devide screen in two parts, composeLCD draws it
+	  createWidget(widget_fill, "divider", PICTURE_X - DIVIDER_WIDTH, 0, DIVIDER_WIDTH, LCD_HEIGHT, 0);
+	  // the status bar can be changed over TCP, MQTT and the web interface by the names of its widgets, the label is white on black like the text window
+	  createWidget(widget_picture, "icon", 0, STATUS_BAR_Y, STATUS_BAR_HEIGHT, STATUS_BAR_HEIGHT, 0);
+	  createWidget(widget_label, "status", STATUS_BAR_HEIGHT + TEXT_X, STATUS_BAR_Y, PICTURE_X - DIVIDER_WIDTH - STATUS_BAR_HEIGHT - TEXT_X, STATUS_BAR_HEIGHT, 0);
+	  setWidgetColor(findWidget("status", strlen("status")), LCD_COLOR_WHITE, LCD_COLOR_BLACK);
 
 	  // set text and text background color
 	  BSP_LCD_SetTextColor(LCD_COLOR_WHITE);
 	  BSP_LCD_SetBackColor(LCD_COLOR_BLACK);
+
+#if MEASURE_BLIT_TIME || PICTURE_TRANSITIONS
+	  // start the cycle counter, the DWT has to be unlocked on the cortex-M7
+	  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	  DWT->LAR = 0xC5ACCE55;
+	  DWT->CYCCNT = 0;
+	  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
 }
 
 /*!
- * \brief prints text to the LCD.
+ * \brief prints text to the LCD. The text is broken into lines by layoutText, a text that is higher than the text window is scrolled by scrollText.
  *
- * \param textArray -> array containing the string that has to be printed.
- * \param len -> the amount of characters that has to be printed
+ * \param textArray -> array containing the UTF-8 string that has to be printed, a '\n' starts a new line. It is copied, so it can be reused afterwards.
+ * \param len -> the amount of bytes that has to be printed, at most TEXT_MAX_LENGTH bytes are printed
  * \param color -> color the text will be printed in
  *
  *
@@ -101,108 +291,116 @@ void initLCD(void)
  *
  * \note please don't use black text color because the text background is black
  * \note red text color can be used for errors
+ * \remark a word that is longer than a line is broken with a '-'.
  */
-int textToLCD(char textArray[TEXT_BUFFER_LENGTH], int len, uint32_t color)
+int textToLCD(const char *textArray, int len, uint32_t color)
 {
+	uint16_t length = (len > TEXT_MAX_LENGTH)? TEXT_MAX_LENGTH : (uint16_t)len;
+	struct rawDirtyRect changed;
+
 	// check if length is valid
-	if(len > TEXT_BUFFER_LENGTH)
+	if(len < 0)
 	{
-		textToLCD(errorMessageText, strlen(errorMessageText),LCD_COLOR_RED);
-		printf("the string that was going to be displayed is to long in total\r\n");
+		printf("the length of the string that was going to be displayed is negative\r\n");
 		return 0;
 	}
-	// make sure there is a '\0' at the end
-	textArray[len] = '\0';
-	// check if there are any weird characters in the string
-	for(int i = 0 ; i < len; i++)
+	// a text that is too long is cut off before a character, not in the middle of it
+	if(len > TEXT_MAX_LENGTH)
 	{
-		if(textArray[i] < ' ')
+		while(length > 0 && ((uint8_t)textArray[length] & 0xC0) == 0x80)
 		{
-			textToLCD(errorMessageText, strlen(errorMessageText),LCD_COLOR_RED);
-			printf("the string that was going to be displayed contains weird characters\r\n");
-			return 0;
+			length--;
 		}
+		printf("the string that was going to be displayed is to long, only the first %u bytes are displayed\r\n", length);
 	}
 	//light up screen
 	ScreensaverStart = HAL_GetTick() + SCREENSAVER_DELAY;
 	HAL_GPIO_WritePin(LCD_DISP_GPIO_PORT, LCD_DISP_PIN, GPIO_PIN_SET);
 	HAL_GPIO_WritePin(LCD_BL_CTRL_GPIO_PORT, LCD_BL_CTRL_PIN, GPIO_PIN_SET);
-	//clear text
-	clearText();
-	BSP_LCD_SetTextColor(color);
-	// small string to save the line that is going to be printed.
-	// one char longer than max length for '\0'
-	char BufString[charsOnLine+1];
-	// y position of text
-	uint16_t LineCnt = 10;
-	// itterators to loop in text arrays
-	uint16_t Count = 0;
-	uint16_t CountTotal = 0;
-	// var to register if a ' ' was found in the buffer string
-	uint8_t Spacefound = 0;
-	// stay in the loop as long as the '\0' is not found
-	while( textArray[CountTotal] != '\0')
-	{
-		// save chars in the temporary buffer
-		BufString[ Count ] = textArray[CountTotal];
-		if( BufString[ Count ] == ' ')
+#if MEASURE_BLIT_TIME
+	uint32_t textStart = DWT->CYCCNT;
+#endif
+	// the text is kept, the lines are drawn again when it scrolls
+	memcpy(shownText, textArray, length);
+	shownTextColor = color;
+	layoutText(&shownLayout, shownText, length, charsOnLine);
+	if(shownLayout.truncated)
+	{
+		printf("the string that was going to be displayed has more than %u lines, the rest is not displayed\r\n", TEXT_LAYOUT_MAX_LINES);
+	}
+	// a new text starts at the top and waits before it scrolls
+	textScroll = 0;
+	nextScrollTime = HAL_GetTick() + TEXT_SCROLL_PAUSE;
+	// the previous text is overwritten, the whole line is drawn by the DMA2D at once
+	drawTextRows(0, TEXT_WINDOW_HEIGHT, &changed);
+	// the text is also needed in the other buffer, only the area of the previous and the new text is copied
+	syncBuffers(changed.x, changed.y, changed.width, changed.height);
+#if MEASURE_BLIT_TIME
+	// the CPU time of the text, the DMA2D draws it afterwards
+	printf("text of %u bytes in %u lines queued in %lu cycles\r\n", length, shownLayout.lineAmount, DWT->CYCCNT - textStart);
+#endif
+	// return len to indicate all went well
+	return len;
+}
+
+/*!
+ * \brief scrolls a text that is higher than the text window one pixel line every TEXT_SCROLL_INTERVAL ms. The lines that stay visible are moved up
+ * 		  by the DMA2D, only the pixel lines that come into view are drawn. After the last line the text waits and starts again at the top.
+ *
+ * \param void
+ *
+ * \retval void
+ *
+ * \note has to be called from the main loop, not from an interrupt
+ */
+void scrollText(void)
+{
+	uint32_t textHeight = (uint32_t)shownLayout.lineAmount * getTextLineHeight();
+	uint32_t now = HAL_GetTick();
+	uint32_t steps;
+	struct rawDirtyRect changed;
+
+	// a text that fits in the text window doesn't scroll
+	if(textHeight <= TEXT_WINDOW_HEIGHT || (int32_t)(now - nextScrollTime) < 0)
+	{
+		return;
+	}
+	if(textScroll >= textHeight - TEXT_WINDOW_HEIGHT)
+	{
+		// the end was shown during the pause, the text starts again at the top
+		textScroll = 0;
+		nextScrollTime = now + TEXT_SCROLL_PAUSE;
+		drawTextRows(0, TEXT_WINDOW_HEIGHT, &changed);
+	}
+	else
+	{
+		// the steps the main loop was late are done at once, so the speed stays the same
+		steps = (now - nextScrollTime) / TEXT_SCROLL_INTERVAL + 1;
+		if(steps > textHeight - TEXT_WINDOW_HEIGHT - textScroll)
 		{
-			Spacefound = 1;
+			steps = textHeight - TEXT_WINDOW_HEIGHT - textScroll;
 		}
-		// only add one char a time some the while above can detect the '\0'
-		Count ++;
-		CountTotal ++;
-		// if 25 chars were found -> print them
-		if( Count == charsOnLine )
+		textScroll += steps;
+		nextScrollTime = (textScroll == textHeight - TEXT_WINDOW_HEIGHT)? now + TEXT_SCROLL_PAUSE : nextScrollTime + steps * TEXT_SCROLL_INTERVAL;
+		if(steps >= TEXT_WINDOW_HEIGHT || textDamage.width == 0)
 		{
-			// if there was a space in the line -> go back until we find it
-			if(Spacefound == 1)
-			{
-				// going back untill we find a space
-				while( BufString[ ( Count - 1 ) ] != ' ')
-				{
-					// fill the buffer with '\0' and reduce where we were reading in the string
-					BufString[ ( Count - 1 ) ] = '\0';
-					Count --;
-					CountTotal --;
-				}
-			}
-			// put a - at the end of the long word to continue on the next line if there was no space in the line
-			if(Spacefound == 0)
-			{
-				BufString[ ( Count+1 ) ] = '\0';
-				BufString[ ( Count - 1 ) ] = '-';
-				CountTotal -= 1;
-			}
-			// make sure the last char is '\0'
-			BufString[ Count ] = '\0';
-			// if the last char would be a ' ', it does not have to be printed
-			if(BufString[ Count -1 ] == ' ')
-			{
-				BufString[ Count -1 ] = '\0';
-			}
-			// print on the lcd
-			BSP_LCD_DisplayStringAt( 5, LineCnt, ( uint8_t * ) BufString, LEFT_MODE );
-			// go down one line
-			LineCnt += 12;
-			// reset char counter
-			Count = 0;
-			// reset to indicate no space was yet found
-			Spacefound = 0;
+			drawTextRows(0, TEXT_WINDOW_HEIGHT, &changed);
 		}
-	}
-	// print the last chars
-	if( textArray[CountTotal] == '\0')
-	{
-		// the bufstring is still filled with data from above
-		// just add '\0' to the end
-		BufString[ Count ] = '\0';
-		// print the last section
-		BSP_LCD_DisplayStringAt( 5, LineCnt, ( uint8_t * ) BufString, LEFT_MODE );
+		else
+		{
+			// only the columns the text is drawn in are moved, the destination is above the source, so every pixel is read before it is overwritten
+			uint32_t* pWindow = (uint32_t*)WDA_LCD_GetDrawAddress() + (TEXT_Y * LCD_WIDTH) + textDamage.x;
+			struct dma2dJob move = {.type = dma2d_copy, .pSrc = pWindow + (steps * LCD_WIDTH), .srcOffset = LCD_WIDTH - textDamage.width, .srcFormat = RAW_FORMAT_ARGB8888, .srcAlpha = 0xFF,
+									.pDst = pWindow, .dstOffset = LCD_WIDTH - textDamage.width, .dstFormat = RAW_FORMAT_ARGB8888, .width = textDamage.width, .height = TEXT_WINDOW_HEIGHT - steps};
+			struct rawDirtyRect moved = {.x = textDamage.x, .y = TEXT_Y, .width = textDamage.width, .height = TEXT_WINDOW_HEIGHT - steps};
 
+			addDMA2DJob(&move);
+			drawTextRows(TEXT_WINDOW_HEIGHT - steps, steps, &changed);
+			addArea(&changed, &moved);
+		}
 	}
-	// return len to indicate all went well
-	return len;
+	// the text is also needed in the other buffer
+	syncBuffers(changed.x, changed.y, changed.width, changed.height);
 }
 
 /*!
@@ -216,21 +414,30 @@ int textToLCD(char textArray[TEXT_BUFFER_LENGTH], int len, uint32_t color)
  */
 uint8_t pictureToLCD(struct imageMetaData picture)
 {
+	// a picture in ARGB8888 or ARGB1555 can be scaled, so it can be larger than the picture area
+	uint8_t scalable = (picture.frameTime == 0 && picture.compression == RAW_COMPRESSION_NONE && (picture.pixelFormat == RAW_FORMAT_ARGB8888 || picture.pixelFormat == RAW_FORMAT_ARGB1555));
+	uint8_t retVal;
+
 	//light up screen
 	ScreensaverStart = HAL_GetTick() + SCREENSAVER_DELAY;
 	HAL_GPIO_WritePin(LCD_DISP_GPIO_PORT, LCD_DISP_PIN, GPIO_PIN_SET);
 	HAL_GPIO_WritePin(LCD_BL_CTRL_GPIO_PORT, LCD_BL_CTRL_PIN, GPIO_PIN_SET);
+#if PICTURE_TRANSITIONS
+	// the step that is shown stays until the new picture replaces it
+	stopTransition();
+#endif
 
-	// save which picture is printed
-	currentPicture = picture;
 	// check image size
-	if(currentPicture.width > MAX_IMAGE_WIDTH || currentPicture.height > MAX_IMAGE_HEIGHT)
+	if((picture.width > PICTURE_WIDTH || picture.height > PICTURE_HEIGHT) && scalable == 0)
 	{
-		stopTimer();
-		//remove previous picture
-		clearPicture();
-		// print the error picture
-		frameToLCD((void*)ERROR_PICTURE_DATA, ERROR_PICTURE_DATA_X_PIXEL, ERROR_PICTURE_DATA_Y_PIXEL);
+		// no gif is shown anymore
+		picture.frameTime = 0;
+		publishPlayback(picture);
+#if LAYER_PICTURES
+		hideLayerPicture();
+#endif
+		// print the error picture, frameToLCD removes the previous picture around it
+		frameToLCD(&errorPictureMetaData, errorPictureMetaData.data, NULL, NO_GIF_FRAME);
 		printf("something went wrong while printing the picture, it is to big\r\n");
 		return 0;
 	}
@@ -239,168 +446,1357 @@ uint8_t pictureToLCD(struct imageMetaData picture)
 		// indicates it's a regular picture
 		if(picture.frameTime == 0)
 		{
-			// no interrupts needed
-			stopTimer();
-			//remove previous picture
-			clearPicture();
-			// draw picture based on given pointer
-			frameToLCD(currentPicture.data, currentPicture.width, currentPicture.height);
+			// save which picture is printed, this also releases the catalog of a previous gif
+			publishPlayback(picture);
+#if PICTURE_TRANSITIONS
+			// the new picture is drawn in the transition buffer, the steps of the transition show it
+			startTransition();
+#endif
+			retVal = stillPictureToLCD(&picture, scalable);
+#if PICTURE_TRANSITIONS
+			runTransition();
+#endif
+			return retVal;
 		}
 		// it's a gif
 		else
 		{
 			//remove previous picture
 			clearPicture();
-			// store the amount of frames
-			frameAmount = getGifFrames(currentPicture.name, strlen(currentPicture.name), frameList);
-			// start with first frame
+			// start with first frame, it is due immediately
 			frameCounter = 0;
-			// set interrupt interval
-			setTimer_ms(picture.frameTime);
-			// start the timer
-			startTimer();
+			nextDeadline = getFrameTimer();
+			// store the resolved frames, the frame scheduler only plays a gif with frames
+			publishPlayback(picture);
 		}
 		return 1;
 	}
 }
 
 /*!
- * \brief print one frame/picture to the LCD.
+ * \brief resolves the frames of the shown gif again when the file system catalog was rebuilt.
+ * 		  The gif keeps running on the new catalog and the old catalog is released, so the file system can rebuild it again.
  *
- * \param data -> pointer to data
- * \param width -> width of the picture
- * \param height -> height of the picture
+ * \param void
  *
  * \retval void
  *
+ * \note has to be called from the main loop, not from an interrupt
  */
-static void frameToLCD(void* data, uint16_t width, uint16_t height)
+void refreshPicture(void)
 {
-	// wait for vsync
-	while(!(hltdc.Instance->CDSR & 1<<2));
-	// draw frame/image
-	WDA_LCD_DrawBitmap((uint16_t*)data, (LCD_WIDTH/2) +  ( ( (LCD_WIDTH/2) - width ) / 2 ) , ( LCD_HEIGHT - height ) / 2, width, height, LTDC_PIXEL_FORMAT_ARGB1555);
+	struct gifPlayback* pShown = pShownPlayback;
+
+	// only a gif uses the catalog while it is shown
+	if(pShown->pCatalog != NULL && pShown->catalogVersion != getCatalogVersion())
+	{
+		// the deadlines keep running, the frame scheduler switches to the new frames at its next frame
+		// when the gif doesn't exist anymore in the new catalog, it has no frames and the scheduler stops
+		if(publishPlayback(pShown->picture) == 0)
+		{
+			clearPicture();
+		}
+#if DOUBLE_BUFFER && DELTA_FRAMES
+		// the frames of the new catalog can be different, so the next frame is drawn completely
+		bufferFrames[0] = NO_GIF_FRAME;
+		bufferFrames[1] = NO_GIF_FRAME;
+#endif
+	}
 }
+
 /*!
- * \brief clears previous text of the LCD.
+ * \brief draws the gif frame that is due. Every frame has an absolute deadline on the free running frame timer: the deadline of the previous frame plus
+ * 		  the frame time of the previous frame, so every frame keeps its own delay and the timing doesn't drift when the main loop is late.
+ * 		  Frames whose time is already over when the main loop gets to them are dropped, so the gif stays in time.
  *
  * \param void
  *
  * \retval void
  *
+ * \note has to be called from the main loop, not from an interrupt
  */
-void clearText(void)
+void scheduleFrames(void)
+{
+	const struct gifPlayback* pPlayback = pShownPlayback;
+	const struct imageMetaData* pFrame;
+	struct rawDirtyRect area;
+	void* data;
+	uint32_t now = getFrameTimer();
+	uint32_t frameTime;
+	uint16_t skipped = 0;
+
+	// the frame stays due until the previous frame is flipped, so the main loop never waits for the LCD
+	if(pPlayback->frameAmount == 0 || (int32_t)(now - nextDeadline) < 0 || frameBufferFree() == 0)
+	{
+		return;
+	}
+	// a refreshed gif can have less frames than before
+	frameCounter %= pPlayback->frameAmount;
+	// skip the frames that should already be replaced by the next one, at most one whole loop of the gif
+	while(skipped < pPlayback->frameAmount && (int32_t)(now - (nextDeadline + pPlayback->frames[frameCounter].frameTime * FRAME_TIMER_TICKS_PER_MS)) >= 0)
+	{
+		nextDeadline += pPlayback->frames[frameCounter].frameTime * FRAME_TIMER_TICKS_PER_MS;
+		frameCounter = (frameCounter + 1) % pPlayback->frameAmount;
+		skipped++;
+	}
+	// more than a whole loop behind (or frames without a frame time), the timing starts again from now
+	if(skipped == pPlayback->frameAmount)
+	{
+		nextDeadline = now;
+	}
+	frameTime = pPlayback->frames[frameCounter].frameTime * FRAME_TIMER_TICKS_PER_MS;
+	pFrame = &pPlayback->frames[frameCounter];
+	// the frame is normally cached ahead, it is only copied or decoded here after dropped frames or when the cache is too small for the gif
+	data = getCachedFrame(pFrame);
+
+	__disable_irq();
+	frameStatistics.droppedFrames += skipped + ((data == NULL)? 1 : 0);
+	__enable_irq();
+	// a frame that can't be decoded is dropped
+	if(data != NULL)
+	{
+		pendingDeadline = nextDeadline;
+		pendingFrameTime = frameTime;
+		timedFramePending = 1;
+		// print current frame, the frame data is already resolved so no file system lookup is needed
+		// only the area that changed since the frame in the back buffer is copied when it is known
+		frameToLCD(pFrame, data, getDeltaArea(pPlayback, frameCounter, &area)? &area : NULL, frameCounter);
+	}
+	// the next frame is due when the time of this frame is over, back to the first frame after the last one
+	nextDeadline += frameTime;
+	frameCounter = (frameCounter + 1) % pPlayback->frameAmount;
+	// the next frames are copied or decoded while this one waits for its flip
+	for(uint16_t ahead = 0; ahead < FRAME_CACHE_PREFETCH && ahead < pPlayback->frameAmount; ahead++)
+	{
+		prefetchFrame(&pPlayback->frames[(frameCounter + ahead) % pPlayback->frameAmount]);
+	}
+}
+
+/*!
+ * \brief returns the timing of the gif frames since startup.
+ *
+ * \param pStatistics -> struct that is filled with the amount of drawn, late and dropped frames and the timing errors
+ *
+ * \retval void
+ */
+void getFrameStatistics(struct frameStatistics* pStatistics)
 {
-	// switch to transparent to overwrite text with 'invisible' plane
-	BSP_LCD_SetTextColor( LCD_COLOR_TRANSPARENT );
-	// fill left screen half with plane
-	BSP_LCD_FillRect( 0, 0 , LCD_WIDTH/2-1, LCD_HEIGHT );
+	// frameDone writes the statistics from the DMA2D interrupt
+	__disable_irq();
+	*pStatistics = frameStatistics;
+	pStatistics->averageError_us = (frameStatistics.drawnFrames != 0)? (uint32_t)((totalErrorTicks * 1000) / ((uint64_t)frameStatistics.drawnFrames * FRAME_TIMER_TICKS_PER_MS)) : 0;
+	__enable_irq();
 }
 
+#if PICTURE_TRANSITIONS
 /*!
- * \brief clears previous picture of the LCD.
+ * \brief chooses the transition that replaces a picture with the next picture (not a gif), the transition that is running keeps going.
+ *
+ * \param type -> transition_none shows the next picture at once
+ * \param time_ms -> the time of the whole transition in ms, every refresh of the LCD shows a step of it
+ *
+ * \retval void
+ */
+void setTransition(transitionType type, uint16_t time_ms)
+{
+	// the LTDC interrupt reads them
+	__disable_irq();
+	transitionKind = type;
+	transitionTime = (uint32_t)time_ms * FRAME_TIMER_TICKS_PER_MS;
+	__enable_irq();
+}
+
+/*!
+ * \brief returns the timing of the steps of the last (or the running) transition. A step that takes longer than refreshPeriod_us shows up as a missed refresh.
+ *
+ * \param pStatistics -> struct that is filled with the amount of steps, the render times and the refresh period
+ *
+ * \retval void
+ */
+void getTransitionStatistics(struct transitionStatistics* pStatistics)
+{
+	// the interrupts write the statistics
+	__disable_irq();
+	*pStatistics = transitionStatistics;
+	pStatistics->averageStep_us = (transitionStatistics.steps != 0)? (totalStepCycles / transitionStatistics.steps) / (SystemCoreClock / 1000000) : 0;
+	__enable_irq();
+}
+
+#endif
+
+/*!
+ * \brief lets the background layer take over the new picture of a finished transition, so the LTDC reads it from its data again like a picture without transition.
+ * 		  The layer is loaded while both buffers of the foreground layer still show the picture, their picture area is only cleared once the LTDC shows the layer.
+ * 		  A picture the LTDC can't read (compressed, scaled, ...) stays in the foreground layer.
  *
  * \param void
  *
  * \retval void
  *
+ * \note has to be called from the main loop, not from an interrupt
  */
-void clearPicture(void)
+void finishTransition(void)
 {
-	// switch to transparent to overwrite previous picture with 'invisible' plane
-	BSP_LCD_SetTextColor( LCD_COLOR_TRANSPARENT );
-	// fill right screen half with plane
-	BSP_LCD_FillRect( (LCD_WIDTH/2), 0 , LCD_WIDTH/2, LCD_HEIGHT );
+#if PICTURE_TRANSITIONS && LAYER_PICTURES
+	// the last step is flipped and the finishing copy is queued once the transition is idle, the DMA2D draws the jobs in order
+	if(layerHandoff == handoff_waiting && transitionState == transition_idle)
+	{
+		loadLayerPicture(&handoffPicture);
+		layerHandoff = handoff_reloading;
+	}
+	// the reload of the layer is done when the LTDC clears the request, a reload that is requested later (a flip) only makes it wait longer
+	else if(layerHandoff == handoff_reloading && !(hltdc.Instance->SRCR & LTDC_SRCR_VBR))
+	{
+		for(uint8_t buffer = 0; buffer < LCD_BUFFER_AMOUNT; buffer++)
+		{
+			clearPictureDamage(buffer, NULL);
+		}
+		layerHandoff = handoff_none;
+	}
+#endif
 }
 
 /*!
- * \brief reads status of onboard blue button
+ * \brief repaints the widgets that changed since the last call and copies the repainted areas to the other buffer. The widgets are composed at most once
+ * 		  per refresh of the LCD, so a caller that changes a widget many times per refresh doesn't make the DMA2D draw it many times.
  *
  * \param void
  *
- *  \retval 1 when blue button is pushed
- *  \retval 0 when blue button is released
+ * \retval void
  *
+ * \note has to be called from the main loop, not from an interrupt
  */
-uint8_t readButton(void)
+void composeLCD(void)
 {
-	// read input register
-	if(GPIOI->IDR & GPIO_PIN_11)
+	struct rawDirtyRect areas[WIDGET_MAX_AREAS];
+	uint8_t areaAmount;
+
+	if(refreshCount == composedRefresh || widgetsDirty() == 0)
+	{
+		return;
+	}
+	composedRefresh = refreshCount;
+	areaAmount = composeWidgets(areas);
+	for(uint8_t area = 0; area < areaAmount; area++)
+	{
+		syncBuffers(areas[area].x, areas[area].y, areas[area].width, areas[area].height);
+	}
+}
+
+/*!
+ * \brief counts the refreshes of the LCD and starts the next step of a transition, it is the LTDC interrupt handler. The line interrupt is at the first line of the vertical blanking,
+ * 		  the reload of the previous step was just done then, so the back buffer is free. The DMA2D draws the step in the back buffer and the buffers are flipped in the next vertical blanking.
+ * 		  When the previous step isn't drawn yet, this refresh doesn't get a new step.
+ *
+ * \param void
+ *
+ * \retval void
+ */
+void serviceLTDC(void)
+{
+#if PICTURE_TRANSITIONS
+	uint32_t now = DWT->CYCCNT;
+	struct dma2dJob jobs[TRANSITION_MAX_JOBS];
+	uint32_t offset;
+	uint8_t jobAmount;
+	uint8_t buffer;
+	uint16_t progress;
+#endif
+
+	LTDC->ICR = LTDC_ICR_CLIF;
+	refreshCount++;
+#if PICTURE_TRANSITIONS
+	if(lastLineCycles != 0)
+	{
+		transitionStatistics.refreshPeriod_us = (now - lastLineCycles) / (SystemCoreClock / 1000000);
+	}
+	lastLineCycles = now;
+	if(transitionState != transition_running && transitionState != transition_finishing)
+	{
+		return;
+	}
+	if(frameBufferFree() == 0)
+	{
+		transitionStatistics.missedRefreshes++;
+		return;
+	}
+	buffer = shownBuffer ^ 1;
+	// the last step shows the new picture completely, finishing copies it to the other buffer as well without a flip
+	progress = (transitionState == transition_running)? getTransitionProgress(getFrameTimer() - transitionStart, transitionTime) : TRANSITION_PROGRESS_END;
+	offset = (pictureArea.y * LCD_WIDTH) + pictureArea.x;
+	jobAmount = getTransitionJobs(transitionKind, progress, (const uint32_t*)TRANSITION_FROM_ADDRESS + offset, (const uint32_t*)TRANSITION_TO_ADDRESS + offset,
+								  (uint32_t*)layerBuffers[buffer] + offset, pictureArea.width, pictureArea.height, LCD_WIDTH, jobs);
+	if(transitionState == transition_running)
+	{
+		jobs[jobAmount - 1].pDone = transitionStepDone;
+		flipPending = 1;
+		stepStart = DWT->CYCCNT;
+	}
+	for(uint8_t job = 0; job < jobAmount; job++)
+	{
+		addDMA2DJob(&jobs[job]);
+	}
+	// the steps cover the whole picture half
+	pictureDamage[buffer] = pictureArea;
+#if DELTA_FRAMES
+	bufferFrames[buffer] = NO_GIF_FRAME;
+#endif
+	if(transitionState == transition_finishing)
+	{
+		// both buffers show the new picture
+		transitionState = transition_idle;
+		transitionFinished = 1;
+	}
+	else if(progress == TRANSITION_PROGRESS_END)
+	{
+		transitionState = transition_finishing;
+	}
+#endif
+}
+
+/*!
+ * \brief prints a picture that isn't a gif. A picture that doesn't fit in the picture area is scaled, otherwise the background layer shows it or
+ * 		  it is drawn in the foreground layer (from the frame cache).
+ *
+ * \param pPicture -> struct with the picture data
+ * \param scalable -> 1 when the picture can be scaled: uncompressed ARGB8888 or ARGB1555
+ *
+ * \retval 1 when the picture is printed.
+ * \retval 0 when the error picture is printed instead.
+ */
+static uint8_t stillPictureToLCD(const struct imageMetaData* pPicture, uint8_t scalable)
+{
+	uint16_t width;
+	uint16_t height;
+	void* data;
+
+	// a picture that is larger than the picture area is scaled down, with SCALE_PICTURES a smaller picture is scaled up until it touches its sides
+	fitImageSize(pPicture->width, pPicture->height, PICTURE_WIDTH, PICTURE_HEIGHT, &width, &height);
+	if(scalable && (width < pPicture->width || height < pPicture->height || (SCALE_PICTURES && (width != pPicture->width || height != pPicture->height))))
 	{
+#if LAYER_PICTURES
+		hideLayerPicture();
+#endif
+		if(scaledFrameToLCD(pPicture, width, height) == 0)
+		{
+			frameToLCD(&errorPictureMetaData, errorPictureMetaData.data, NULL, NO_GIF_FRAME);
+			printf("something went wrong while scaling the picture\r\n");
+			return 0;
+		}
 		return 1;
 	}
-	else
+#if LAYER_PICTURES
+	// the LTDC shows the picture data itself, showing another picture only changes some registers
+	if(showLayerPicture(pPicture) == 1)
+	{
+		return 1;
+	}
+#endif
+	// the picture is copied into the frame cache, a compressed picture is decoded
+	data = getCachedFrame(pPicture);
+#if LAYER_PICTURES
+	hideLayerPicture();
+#endif
+	// frameToLCD only removes the part of the previous picture that the new picture doesn't cover
+	if(data == NULL)
 	{
+		frameToLCD(&errorPictureMetaData, errorPictureMetaData.data, NULL, NO_GIF_FRAME);
+		printf("something went wrong while decoding the picture\r\n");
 		return 0;
 	}
+	// draw picture based on given pointer
+	frameToLCD(pPicture, data, NULL, NO_GIF_FRAME);
+	return 1;
+}
+
+/*!
+ * \brief fills the playback that isn't shown with the picture and publishes it to the frame scheduler.
+ *
+ * \param picture -> struct with picture data, the frames are resolved when it is a gif (frameTime != 0)
+ *
+ * \return the amount of frames of the gif, 0 when it is a regular picture or the gif has no frames
+ *
+ * \note the previous playback isn't used anymore after the pointer write because the frame scheduler runs in the main loop as well
+ */
+static uint16_t publishPlayback(struct imageMetaData picture)
+{
+	struct gifPlayback* pShown = pShownPlayback;
+	struct gifPlayback* pNext = (pShown == &gifPlaybacks[0])? &gifPlaybacks[1] : &gifPlaybacks[0];
+
+	pNext->picture = picture;
+	pNext->frames = NULL;
+	pNext->frameAmount = 0;
+	pNext->pCatalog = NULL;
+	pNext->catalogVersion = getCatalogVersion();
+	// the frames point into the catalog, so it is acquired as long as the gif is shown
+	if(picture.frameTime != 0)
+	{
+		pNext->pCatalog = acquireCatalog();
+		pNext->frameAmount = getGifFrameData(picture.name, strlen(picture.name), &pNext->frames);
+	}
+	// all writes to the playback have to be finished before it is published
+	__DMB();
+	pShownPlayback = pNext;
+
+	// the catalog of the previous gif can be rebuilt now
+	releaseCatalog(pShown->pCatalog);
+	pShown->pCatalog = NULL;
+	return pNext->frameAmount;
 }
 
 /*!
- * \brief sets the time for the timer interrupt routine
+ * \brief print one frame/picture (or an area of it) to the LCD.
  *
- * \param time_ms time in ms for the interrupt routine
+ * \param pPicture -> struct with the picture data: size, pixel format (RAW_FORMAT_xxx, equal to the DMA2D input color mode) and CLUT
+ * \param data -> pointer to the pixels, the picture data itself or the frame cache slot it is copied or decoded in
+ * \param pArea -> area of the picture that is copied, NULL to copy the whole picture
+ * \param frameIndex -> index of the gif frame, NO_GIF_FRAME for a picture
  *
  * \retval void
  *
  */
-static void setTimer_ms(uint16_t time_ms)
+static void frameToLCD(const struct imageMetaData* pPicture, void* data, const struct rawDirtyRect* pArea, uint16_t frameIndex)
+{
+	uint16_t width = pPicture->width;
+	uint16_t x = PICTURE_X + ( ( PICTURE_WIDTH - width ) / 2 );
+	uint16_t y = PICTURE_Y + ( ( PICTURE_HEIGHT - pPicture->height ) / 2 );
+	uint8_t bitsPerPixel = getRawBitsPerPixel(pPicture->pixelFormat);
+	struct rawDirtyRect area = (pArea != NULL)? *pArea : (struct rawDirtyRect){.x = 0, .y = 0, .width = width, .height = pPicture->height};
+	// the whole frame on the LCD
+	struct rawDirtyRect frameArea = {.x = x, .y = y, .width = width, .height = pPicture->height};
+	uint8_t buffer;
+
+	// the pixels of a 4 bit format are stored in pairs, so the area starts and ends at a pair
+	if(bitsPerPixel < 8)
+	{
+		uint16_t right = (area.x + area.width + 1) & ~1u;
+		area.x &= ~1u;
+		area.width = right - area.x;
+	}
+	// the area is copied the same way as WDA_LCD_DrawPartOfBitmap does it: the rest of every picture line and LCD line is skipped
+	// the DMA2D converts a CLUT format to ARGB8888 with the CLUT of the picture
+	struct dma2dJob job = {.type = dma2d_copy, .pSrc = (uint8_t*)data + (((uint32_t)area.y * width + area.x) * bitsPerPixel) / 8, .srcOffset = width - area.width, .srcFormat = pPicture->pixelFormat, .srcAlpha = 0xFF,
+						   .pClut = pPicture->clut, .clutSize = pPicture->clutSize, .dstOffset = LCD_WIDTH - area.width, .dstFormat = RAW_FORMAT_ARGB8888, .width = area.width, .height = area.height, .pDone = frameDone};
+
+	buffer = startFrame(&frameArea, frameIndex);
+	job.pDst = (uint32_t*)getLayerBuffer(buffer) + ((y + area.y) * LCD_WIDTH) + x + area.x;
+	// draw frame/image, the DMA2D interrupt calls frameDone when it is drawn
+	addFrameJob(&job, buffer);
+	area.x += x;
+	area.y += y;
+	addArea(&pictureDamage[buffer], &area);
+	// the frame cache doesn't reuse the slot of the frame before it is drawn
+	setFrameCacheJob(data, getLastDMA2DJob());
+}
+
+/*!
+ * \brief scales a picture and prints it in the middle of the picture area. The CPU scales SCALE_STRIP_ROWS rows at a time in a strip of the scale buffer
+ * 		  and the DMA2D copies the strip to the LCD (and converts ARGB1555 to ARGB8888) while the CPU scales the next strip.
+ *
+ * \param pPicture -> struct with the picture data, uncompressed ARGB8888 or ARGB1555
+ * \param width -> width of the scaled picture, at most MAX_IMAGE_WIDTH
+ * \param height -> height of the scaled picture, at most MAX_IMAGE_HEIGHT
+ *
+ * \retval 1 when the picture is printed.
+ * \retval 0 when the picture can't be scaled, nothing is printed.
+ *
+ * \note the DMA2D interrupt calls frameDone when the last strip is drawn
+ */
+static uint8_t scaledFrameToLCD(const struct imageMetaData* pPicture, uint16_t width, uint16_t height)
+{
+	uint16_t x = PICTURE_X + ( ( PICTURE_WIDTH - width ) / 2 );
+	uint16_t y = PICTURE_Y + ( ( PICTURE_HEIGHT - height ) / 2 );
+	struct rawDirtyRect frameArea = {.x = x, .y = y, .width = width, .height = height};
+	// the last DMA2D job that reads each strip
+	uint32_t stripJobs[SCALE_STRIPS];
+	uint16_t row = 0;
+	uint16_t rows;
+	uint8_t strip = 0;
+	uint8_t buffer;
+#if MEASURE_BLIT_TIME
+	uint32_t scaleCycles = 0;
+	uint32_t scaleStart;
+#endif
+
+	if(width > MAX_IMAGE_WIDTH || height > MAX_IMAGE_HEIGHT
+			|| initScaleJob(&pictureScaler, pPicture->data, pPicture->width, pPicture->height, pPicture->pixelFormat, width, height, SCALE_FILTER) == 0)
+	{
+		return 0;
+	}
+	buffer = startFrame(&frameArea, NO_GIF_FRAME);
+	for(uint8_t index = 0; index < SCALE_STRIPS; index++)
+	{
+		stripJobs[index] = getLastDMA2DJob();
+	}
+	while(row < height)
+	{
+		void* pStrip = (uint8_t*)SCALE_BUFFER_ADDRESS + (strip * SCALE_STRIP_SIZE);
+
+		// the DMA2D has to be done with the strip before the CPU writes it again
+		waitDMA2DJob(stripJobs[strip]);
+#if MEASURE_BLIT_TIME
+		scaleStart = DWT->CYCCNT;
+#endif
+		rows = scaleRows(&pictureScaler, pStrip, SCALE_STRIP_ROWS);
+#if MEASURE_BLIT_TIME
+		scaleCycles += DWT->CYCCNT - scaleStart;
+#endif
+		struct dma2dJob job = {.type = dma2d_copy, .pSrc = pStrip, .srcOffset = 0, .srcFormat = pPicture->pixelFormat, .srcAlpha = 0xFF,
+							   .pDst = (uint32_t*)getLayerBuffer(buffer) + ((y + row) * LCD_WIDTH) + x, .dstOffset = LCD_WIDTH - width, .dstFormat = RAW_FORMAT_ARGB8888,
+							   .width = width, .height = rows, .pDone = (row + rows == height)? frameDone : NULL};
+
+		addFrameJob(&job, buffer);
+		stripJobs[strip] = getLastDMA2DJob();
+		row += rows;
+		strip = (strip + 1) % SCALE_STRIPS;
+	}
+	addArea(&pictureDamage[buffer], &frameArea);
+#if MEASURE_BLIT_TIME
+	printf("picture scaled from %ux%u to %ux%u in %lu cycles, %lu cycles per output megapixel\r\n", pPicture->width, pPicture->height, width, height,
+			scaleCycles, (uint32_t)(((uint64_t)scaleCycles * 1000000) / ((uint32_t)width * height)));
+#endif
+	return 1;
+}
+
+/*!
+ * \brief waits until a frame can be drawn and prepares the buffer it is drawn in: the part of the previous picture or gif frame in the buffer
+ * 		  that the frame doesn't cover is cleared.
+ *
+ * \param pFrameArea -> the area of the whole frame on the LCD
+ * \param frameIndex -> index of the gif frame, NO_GIF_FRAME for a picture
+ *
+ * \return the index of the buffer the frame has to be drawn in
+ *
+ * \note the last DMA2D job of the frame has to call frameDone
+ */
+static uint8_t startFrame(const struct rawDirtyRect* pFrameArea, uint16_t frameIndex)
 {
-	// set reload register
-	htim2.Instance->ARR = (time_ms * 2) - 1;
+	uint8_t buffer = 0;
+
+#if PICTURE_TRANSITIONS
+	// the new picture of a transition is drawn over the white of the transition buffer, the steps of the transition show it
+	if(transitionState == transition_drawing)
+	{
+		return TRANSITION_BUFFER;
+	}
+#endif
+#if DOUBLE_BUFFER
+	// the back buffer is scanned out until the previous frame is drawn and flipped, the frame scheduler only draws when it is free
+	while(frameBufferFree() == 0)
+	{
+		// finishes the frame job when the DMA2D interrupt can't run
+		serviceDMA2D();
+	}
+	flipPending = 1;
+	buffer = shownBuffer ^ 1;
+	// the previous picture or gif frame in the buffer is only removed where the frame doesn't cover it, this resets bufferFrames when it is removed
+	clearPictureDamage(buffer, pFrameArea);
+#if DELTA_FRAMES
+	bufferFrames[buffer] = frameIndex;
+#endif
+#else
+	(void)frameIndex;
+	// wait for vsync
+	while(!(hltdc.Instance->CDSR & 1<<2));
+	clearPictureDamage(buffer, pFrameArea);
+#endif
+#if MEASURE_BLIT_TIME
+	// measured from queueing the frame until the DMA2D is done, not the wait for vsync
+	blitStart = DWT->CYCCNT;
+#endif
+	return buffer;
 }
 
 /*!
- * \brief timer interrupt callback
+ * \brief queues a DMA2D job that draws (a part of) a frame in the buffer startFrame returned.
  *
- * \param
- *  htim timer that generated the interrupt
+ * \param pJob -> the copy that draws the frame, it is changed into a blend for the transition buffer
+ * \param buffer -> index of the buffer the job draws in
  *
  * \retval void
+ */
+static void addFrameJob(struct dma2dJob* pJob, uint8_t buffer)
+{
+#if PICTURE_TRANSITIONS
+	if(buffer == TRANSITION_BUFFER)
+	{
+		// the transition buffer has no transparent background, the frame is blended over the white like the LTDC does it
+		// the steps of the transition flip the buffers, not the frame
+		pJob->type = dma2d_blend;
+		pJob->pBackground = pJob->pDst;
+		pJob->backgroundOffset = pJob->dstOffset;
+		pJob->backgroundFormat = RAW_FORMAT_ARGB8888;
+		pJob->pDone = NULL;
+	}
+#else
+	(void)buffer;
+#endif
+	addDMA2DJob(pJob);
+}
+
+/*!
+ * \brief calculates the area of a gif frame that has to be copied to the back buffer: the union of the dirty rectangles of the frames after the frame
+ * 		  the back buffer holds, up to the frame that is drawn. Both buffers are drawn in turns, so this is at least the dirty rectangle of the frame and
+ * 		  of the frame before it, and the dropped frames are included as well.
+ *
+ * \param pPlayback -> the gif that is shown
+ * \param frameIndex -> index of the frame that is drawn
+ * \param pArea -> filled with the area, relative to the frame
+ *
+ * \retval 1 when only pArea has to be copied.
+ * \retval 0 when the whole frame has to be copied.
  *
+ * \note the back buffer has to be free (frameBufferFree)
  */
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim)
+static uint8_t getDeltaArea(const struct gifPlayback* pPlayback, uint16_t frameIndex, struct rawDirtyRect* pArea)
 {
-	// check if interrupt came from right timer
-	if(htim == &htim2)
+#if DOUBLE_BUFFER && DELTA_FRAMES
+	const struct imageMetaData* pFrame = &pPlayback->frames[frameIndex];
+	uint16_t heldFrame = bufferFrames[shownBuffer ^ 1];
+	uint16_t left = pFrame->width;
+	uint16_t top = pFrame->height;
+	uint16_t right = 0;
+	uint16_t bottom = 0;
+
+	// the back buffer holds a picture, a cleared area or a frame of another size
+	if(heldFrame >= pPlayback->frameAmount || pPlayback->frames[heldFrame].width != pFrame->width || pPlayback->frames[heldFrame].height != pFrame->height)
+	{
+		return 0;
+	}
+	// the frames after the held frame up to the drawn frame, the dropped frames included
+	while(heldFrame != frameIndex)
 	{
-		// get image data and place it in local struct
-		getRawImageMetaData(frameList[frameCounter], strlen(frameList[frameCounter]), &currentPicture);
-		// print current frame
-		frameToLCD(currentPicture.data, currentPicture.width, currentPicture.height);
-		// increase framecounter
-		frameCounter++;
-		// resetcounter if it was last frame
-		if(frameCounter == frameAmount)
+		heldFrame = (heldFrame + 1) % pPlayback->frameAmount;
+		const struct imageMetaData* pDelta = &pPlayback->frames[heldFrame];
+		const struct rawDirtyRect* pDirty = &pDelta->dirty;
+
+		if(pDelta->width != pFrame->width || pDelta->height != pFrame->height)
 		{
-			frameCounter = 0;
+			return 0;
+		}
+		if(pDirty->width != 0 && pDirty->height != 0)
+		{
+			left = (pDirty->x < left)? pDirty->x : left;
+			top = (pDirty->y < top)? pDirty->y : top;
+			right = (pDirty->x + pDirty->width > right)? pDirty->x + pDirty->width : right;
+			bottom = (pDirty->y + pDirty->height > bottom)? pDirty->y + pDirty->height : bottom;
 		}
 	}
+	// nothing changed, one pixel is copied anyway so the frame is still flipped (and timed) by frameDone
+	if(right == 0)
+	{
+		left = 0;
+		top = 0;
+		right = 1;
+		bottom = 1;
+	}
+	*pArea = (struct rawDirtyRect){.x = left, .y = top, .width = right - left, .height = bottom - top};
+	return 1;
+#else
+	(void)pPlayback;
+	(void)frameIndex;
+	(void)pArea;
+	return 0;
+#endif
+}
+
+/*!
+ * \brief checks if a frame can be drawn without waiting: the previous frame is drawn and its buffer is flipped.
+ *
+ * \param void
+ *
+ * \retval 1 when the back buffer can be drawn in.
+ * \retval 0 when the previous frame is still being drawn or shown.
+ *
+ */
+static uint8_t frameBufferFree(void)
+{
+#if DOUBLE_BUFFER
+	if(flipPending || (hltdc.Instance->SRCR & LTDC_SRCR_VBR))
+	{
+		return 0;
+	}
+#endif
+	return 1;
 }
 
 /*!
- * \brief start timer to receive timer interrupts
+ * \brief called by the DMA2D queue (with interrupts disabled) when a frame is drawn, flips the buffers of the foreground layer.
  *
  * \param void
  *
  * \retval void
  *
  */
-static void startTimer(void)
+static void frameDone(void)
 {
-	// start timer
-	HAL_TIM_Base_Start_IT(&htim2);
+	// the timing error of a gif frame is measured when it is drawn
+	if(timedFramePending)
+	{
+		uint32_t errorTicks = getFrameTimer() - pendingDeadline;
+
+		timedFramePending = 0;
+		totalErrorTicks += errorTicks;
+		frameStatistics.drawnFrames++;
+		frameStatistics.lastError_us = (uint32_t)(((uint64_t)errorTicks * 1000) / FRAME_TIMER_TICKS_PER_MS);
+		frameStatistics.maxError_us = (frameStatistics.lastError_us > frameStatistics.maxError_us)? frameStatistics.lastError_us : frameStatistics.maxError_us;
+		// drawn after more than half of its frame time
+		if(errorTicks * 2 > pendingFrameTime)
+		{
+			frameStatistics.lateFrames++;
+		}
+	}
+#if MEASURE_BLIT_TIME
+	uint32_t cycles = DWT->CYCCNT - blitStart;
+	blitCycles += cycles;
+	blitCyclesMax = (cycles > blitCyclesMax)? cycles : blitCyclesMax;
+	blitFrames++;
+#endif
+	flipBuffers();
 }
 
 /*!
- * \brief stop timer to receive no more timer interrupts
+ * \brief shows the back buffer of the foreground layer from the next vertical blanking on, called with interrupts disabled.
  *
  * \param void
  *
  * \retval void
  *
  */
-static void stopTimer(void)
+static void flipBuffers(void)
+{
+#if DOUBLE_BUFFER
+	uint8_t backBuffer = shownBuffer ^ 1;
+	// BSP_LCD_SetLayerAddress_NoReload also changes the address the BSP draws in, the main loop can be drawing text in the other buffer
+	uint32_t drawAddress = WDA_LCD_GetDrawAddress();
+
+	// the LTDC loads the new address in the next vertical blanking, so the frame is never shown half drawn
+	BSP_LCD_SetLayerAddress_NoReload(1, layerBuffers[backBuffer]);
+	BSP_LCD_Reload(LCD_RELOAD_VERTICAL_BLANKING);
+	WDA_LCD_SetDrawAddress(drawAddress);
+	shownBuffer = backBuffer;
+	flipPending = 0;
+#endif
+}
+
+/*!
+ * \brief copies an area of the buffer the BSP draws in to the other buffer of the foreground layer,
+ * 		  so text and cleared areas don't disappear when the buffers are flipped.
+ *
+ * \param x -> x position of the area
+ * \param y -> y position of the area
+ * \param width -> width of the area
+ * \param height -> height of the area
+ *
+ * \retval void
+ *
+ * \note the frames are drawn in the whole picture area, so only what is drawn with the BSP functions has to be copied
+ */
+static void syncBuffers(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+#if DOUBLE_BUFFER
+	// frameDone restores the draw address when it flips, so it is the same during the whole copy
+	uint32_t drawAddress = WDA_LCD_GetDrawAddress();
+	uint32_t otherAddress = (drawAddress == layerBuffers[0])? layerBuffers[1] : layerBuffers[0];
+
+	if(width == 0 || height == 0)
+	{
+		return;
+	}
+	WDA_LCD_SetDrawAddress(otherAddress);
+	WDA_LCD_DrawPartOfBitmap((uint32_t*)drawAddress + (y * LCD_WIDTH) + x, x, y, width, height, RAW_FORMAT_ARGB8888, LCD_WIDTH);
+	WDA_LCD_SetDrawAddress(drawAddress);
+#endif
+}
+
+/*!
+ * \brief draws pixel lines of the text window with the lines of the shown text that are (partly) in them, textScroll is the pixel line of the text
+ * 		  at the top of the window.
+ *
+ * \param firstRow -> the first pixel line that is drawn, 0 is the top of the text window
+ * \param rowAmount -> the amount of pixel lines
+ * \param pChanged -> filled with the area of the LCD that was cleared or drawn in, the area that has to be copied to the other buffer
+ *
+ * \retval void
+ *
+ */
+static void drawTextRows(uint16_t firstRow, uint16_t rowAmount, struct rawDirtyRect* pChanged)
+{
+	uint16_t lineHeight = getTextLineHeight();
+	// the pixel lines of the text that are drawn
+	uint32_t top = textScroll + firstRow;
+	uint32_t bottom = top + rowAmount;
+	struct rawDirtyRect rows = {.x = 0, .y = TEXT_Y + firstRow, .width = TEXT_WINDOW_WIDTH, .height = rowAmount};
+	// only the part of the rows that the previous text was drawn in is cleared, drawTextLinePart fills the character cells with the background color
+	struct rawDirtyRect cleared = intersectAreas(&textDamage, &rows);
+	struct rawDirtyRect drawn = {0};
+
+	if(cleared.width != 0)
+	{
+		BSP_LCD_SetTextColor(LCD_COLOR_TRANSPARENT);
+		BSP_LCD_FillRect(cleared.x, cleared.y, cleared.width, cleared.height);
+	}
+	// the damage above and below the rows stays
+	if(cleared.width == textDamage.width && cleared.height == textDamage.height)
+	{
+		textDamage = (struct rawDirtyRect){0};
+	}
+	*pChanged = cleared;
+	if(lineHeight == 0)
+	{
+		return;
+	}
+	for(uint32_t line = top / lineHeight; line < shownLayout.lineAmount && line * lineHeight < bottom; line++)
+	{
+		const struct textSpan* pSpan = &shownLayout.lines[line];
+		// the part of the line that is in the rows
+		uint32_t lineTop = line * lineHeight;
+		uint16_t firstLineRow = (top > lineTop)? top - lineTop : 0;
+		uint16_t endLineRow = (bottom < lineTop + lineHeight)? bottom - lineTop : lineHeight;
+		uint16_t y = TEXT_Y + (lineTop + firstLineRow - textScroll);
+		uint16_t width = drawTextLinePart(TEXT_X, y, shownText + pSpan->start, pSpan->length, firstLineRow, endLineRow - firstLineRow, shownTextColor, BSP_LCD_GetBackColor());
+
+		// put a - at the end of a long word that continues on the next line
+		if(pSpan->hyphen)
+		{
+			width += drawTextLinePart(TEXT_X + width, y, "-", 1, firstLineRow, endLineRow - firstLineRow, shownTextColor, BSP_LCD_GetBackColor());
+		}
+		drawn = (struct rawDirtyRect){.x = TEXT_X, .y = y, .width = width, .height = endLineRow - firstLineRow};
+		addArea(&textDamage, &drawn);
+		addArea(pChanged, &drawn);
+	}
+}
+
+#if MEASURE_BLIT_TIME
+/*!
+ * \brief prints the average and maximum blit time once BLIT_TIME_FRAMES frames were drawn, and starts a new measurement.
+ * 		  Compare the result of a gif before and after makefsdata -layout to see the effect of the QSPI layout.
+ * 		  The frame cache counters and the timing of the gif frames (drawn, late, dropped and the timing error) are printed with it.
+ * 		  The render time of the steps is printed after every transition, the maximum has to stay below the refresh period.
+ *
+ * \param void
+ *
+ * \retval void
+ *
+ * \note has to be called from the main loop, not from an interrupt
+ */
+void printBlitTime(void)
+{
+	uint32_t cycles;
+	uint32_t cyclesMax;
+	uint32_t frames;
+	struct frameCacheStatistics cache;
+	struct frameStatistics timing;
+
+	if(blitFrames >= BLIT_TIME_FRAMES)
+	{
+		// the DMA2D interrupt also writes the counters, so they are copied and reset without interrupts
+		__disable_irq();
+		cycles = blitCycles;
+		cyclesMax = blitCyclesMax;
+		frames = blitFrames;
+		blitCycles = 0;
+		blitCyclesMax = 0;
+		blitFrames = 0;
+		__enable_irq();
+		printf("blit time over %lu frames: avg %lu cycles (%lu us), max %lu cycles (%lu us)\r\n", frames, cycles / frames, (cycles / frames) / (SystemCoreClock / 1000000), cyclesMax, cyclesMax / (SystemCoreClock / 1000000));
+		// the frame cache is only used from the main loop
+		getFrameCacheStatistics(&cache);
+		printf("frame cache: %lu hits, %lu misses, %lu prefetches, %lu evictions, %u/%u slots, fill avg %lu cycles (%lu us), max %lu cycles (%lu us)\r\n", cache.hits, cache.misses, cache.prefetches, cache.evictions,
+				cache.usedSlots, cache.slotAmount, cache.averageFillCycles, cache.averageFillCycles / (SystemCoreClock / 1000000), cache.maxFillCycles, cache.maxFillCycles / (SystemCoreClock / 1000000));
+		// the timing of the gif frames since startup
+		getFrameStatistics(&timing);
+		printf("gif frames: %lu drawn, %lu late, %lu dropped, timing error avg %lu us, max %lu us, last %lu us\r\n", timing.drawnFrames, timing.lateFrames, timing.droppedFrames,
+				timing.averageError_us, timing.maxError_us, timing.lastError_us);
+	}
+#if PICTURE_TRANSITIONS
+	if(transitionFinished)
+	{
+		struct transitionStatistics transition;
+
+		transitionFinished = 0;
+		getTransitionStatistics(&transition);
+		printf("transition: %lu steps, render avg %lu us, max %lu us, refresh period %lu us, %lu refreshes without a new step\r\n", transition.steps, transition.averageStep_us,
+				transition.maxStep_us, transition.refreshPeriod_us, transition.missedRefreshes);
+	}
+#endif
+}
+#endif
+/*!
+ * \brief clears previous text of the LCD.
+ *
+ * \param void
+ *
+ * \retval void
+ *
+ */
+void clearText(void)
+{
+	// the text doesn't scroll anymore
+	shownLayout.lineAmount = 0;
+	// overwrite the area of the text with the 'invisible' plane, in both buffers
+	for(uint8_t buffer = 0; buffer < LCD_BUFFER_AMOUNT; buffer++)
+	{
+		fillTransparent(buffer, &textDamage);
+	}
+	textDamage = (struct rawDirtyRect){0};
+}
+
+/*!
+ * \brief clears previous picture of the LCD.
+ *
+ * \param void
+ *
+ * \retval void
+ *
+ */
+void clearPicture(void)
+{
+#if PICTURE_TRANSITIONS
+	stopTransition();
+#endif
+#if LAYER_PICTURES
+	hideLayerPicture();
+#endif
+	// overwrite the previous pictures with the 'invisible' plane, only where they were drawn
+	for(uint8_t buffer = 0; buffer < LCD_BUFFER_AMOUNT; buffer++)
+	{
+		clearPictureDamage(buffer, NULL);
+	}
+}
+
+/*!
+ * \brief returns the address of a framebuffer of the foreground layer.
+ *
+ * \param buffer -> index of the buffer, smaller than LCD_BUFFER_AMOUNT, or TRANSITION_BUFFER
+ *
+ * \return the address of the buffer
+ *
+ */
+static uint32_t getLayerBuffer(uint8_t buffer)
+{
+#if PICTURE_TRANSITIONS
+	if(buffer == TRANSITION_BUFFER)
+	{
+		return TRANSITION_TO_ADDRESS;
+	}
+#endif
+#if DOUBLE_BUFFER
+	return layerBuffers[buffer];
+#else
+	(void)buffer;
+	return WDA_LCD_GetDrawAddress();
+#endif
+}
+
+/*!
+ * \brief makes an area of a framebuffer of the foreground layer transparent with a DMA2D fill.
+ *
+ * \param buffer -> index of the buffer, smaller than LCD_BUFFER_AMOUNT
+ * \param pArea -> the area on the LCD, nothing is filled when it is empty
+ *
+ * \retval void
+ *
+ */
+static void fillTransparent(uint8_t buffer, const struct rawDirtyRect* pArea)
+{
+	fillArea(getLayerBuffer(buffer), pArea, LCD_COLOR_TRANSPARENT);
+}
+
+/*!
+ * \brief fills an area of a buffer of the size of the LCD with a color with a DMA2D fill.
+ *
+ * \param address -> address of the buffer, ARGB8888
+ * \param pArea -> the area on the LCD, nothing is filled when it is empty
+ * \param color -> ARGB8888 color
+ *
+ * \retval void
+ *
+ */
+static void fillArea(uint32_t address, const struct rawDirtyRect* pArea, uint32_t color)
+{
+	if(pArea->width != 0 && pArea->height != 0)
+	{
+		struct dma2dJob fill = {.type = dma2d_fill, .pDst = (uint32_t*)address + (pArea->y * LCD_WIDTH) + pArea->x, .dstOffset = LCD_WIDTH - pArea->width,
+								.dstFormat = RAW_FORMAT_ARGB8888, .width = pArea->width, .height = pArea->height, .color = color};
+
+		addDMA2DJob(&fill);
+	}
+}
+
+/*!
+ * \brief makes the area of a framebuffer that a picture or gif frame was drawn in transparent, except for the part that is drawn again.
+ * 		  The area that stays is cut out of the damage, the rest is filled with at most 4 DMA2D fills: above, below, left and right of it.
+ *
+ * \param buffer -> index of the buffer, smaller than LCD_BUFFER_AMOUNT
+ * \param pKeep -> the area that the next frame overwrites completely, NULL to clear everything
+ *
+ * \retval void
+ *
+ * \note a picture that is as large as the previous one or larger doesn't clear anything
+ */
+static void clearPictureDamage(uint8_t buffer, const struct rawDirtyRect* pKeep)
+{
+	struct rawDirtyRect damage = pictureDamage[buffer];
+	struct rawDirtyRect keep = (pKeep != NULL)? intersectAreas(&damage, pKeep) : (struct rawDirtyRect){0};
+
+	if(damage.width == 0 || (keep.width == damage.width && keep.height == damage.height))
+	{
+		return;
+	}
+	if(keep.width == 0)
+	{
+		fillTransparent(buffer, &damage);
+	}
+	else
+	{
+		struct rawDirtyRect parts[4] = {
+				{.x = damage.x, .y = damage.y, .width = damage.width, .height = keep.y - damage.y},
+				{.x = damage.x, .y = keep.y + keep.height, .width = damage.width, .height = (damage.y + damage.height) - (keep.y + keep.height)},
+				{.x = damage.x, .y = keep.y, .width = keep.x - damage.x, .height = keep.height},
+				{.x = keep.x + keep.width, .y = keep.y, .width = (damage.x + damage.width) - (keep.x + keep.width), .height = keep.height}};
+
+		for(uint8_t part = 0; part < 4; part++)
+		{
+			fillTransparent(buffer, &parts[part]);
+		}
+	}
+	pictureDamage[buffer] = keep;
+#if DOUBLE_BUFFER && DELTA_FRAMES
+	// the buffer doesn't hold the whole gif frame anymore, so the next frame is drawn completely
+	bufferFrames[buffer] = NO_GIF_FRAME;
+#endif
+}
+
+/*!
+ * \brief returns the area two areas have in common.
+ *
+ * \param pFirst -> the first area
+ * \param pSecond -> the second area
+ *
+ * \return the area that is in both, its width and height are 0 when they don't overlap
+ *
+ */
+static struct rawDirtyRect intersectAreas(const struct rawDirtyRect* pFirst, const struct rawDirtyRect* pSecond)
+{
+	uint16_t left = (pFirst->x > pSecond->x)? pFirst->x : pSecond->x;
+	uint16_t top = (pFirst->y > pSecond->y)? pFirst->y : pSecond->y;
+	uint16_t right = (pFirst->x + pFirst->width < pSecond->x + pSecond->width)? pFirst->x + pFirst->width : pSecond->x + pSecond->width;
+	uint16_t bottom = (pFirst->y + pFirst->height < pSecond->y + pSecond->height)? pFirst->y + pFirst->height : pSecond->y + pSecond->height;
+
+	if(pFirst->width == 0 || pFirst->height == 0 || pSecond->width == 0 || pSecond->height == 0 || right <= left || bottom <= top)
+	{
+		return (struct rawDirtyRect){0};
+	}
+	return (struct rawDirtyRect){.x = left, .y = top, .width = right - left, .height = bottom - top};
+}
+
+/*!
+ * \brief grows an area until it also holds another area, so both can be copied or cleared with one DMA2D job.
+ *
+ * \param pArea -> the area that grows, an empty area becomes the other area
+ * \param pAdd -> the area that is added, nothing happens when it is empty
+ *
+ * \retval void
+ *
+ */
+static void addArea(struct rawDirtyRect* pArea, const struct rawDirtyRect* pAdd)
+{
+	uint16_t right;
+	uint16_t bottom;
+
+	if(pAdd->width == 0 || pAdd->height == 0)
+	{
+		return;
+	}
+	if(pArea->width == 0 || pArea->height == 0)
+	{
+		*pArea = *pAdd;
+		return;
+	}
+	right = (pArea->x + pArea->width > pAdd->x + pAdd->width)? pArea->x + pArea->width : pAdd->x + pAdd->width;
+	bottom = (pArea->y + pArea->height > pAdd->y + pAdd->height)? pArea->y + pArea->height : pAdd->y + pAdd->height;
+	pArea->x = (pArea->x < pAdd->x)? pArea->x : pAdd->x;
+	pArea->y = (pArea->y < pAdd->y)? pArea->y : pAdd->y;
+	pArea->width = right - pArea->x;
+	pArea->height = bottom - pArea->y;
+}
+
+#if LAYER_PICTURES
+/*!
+ * \brief shows a picture with the background layer: the layer gets a window of the size of the picture and the LTDC reads the picture data itself,
+ * 		  from the QSPI or wherever it is. The registers are loaded in the next vertical blanking, so nothing is copied and the main loop doesn't wait.
+ *
+ * \param pPicture -> struct with the picture data
+ *
+ * \retval 1 when the background layer shows the picture.
+ * \retval 0 when the LTDC can't read the picture (compressed, a format the LTDC doesn't have or a CLUT with transparent colors),
+ * 			 it has to be drawn in the foreground layer then. Also 0 when a transition draws the picture, finishTransition lets the layer take it over afterwards.
+ *
+ * \note the text and the gifs stay in the foreground layer above it, its picture area is cleared when something was drawn in it
+ */
+static uint8_t showLayerPicture(const struct imageMetaData* pPicture)
+{
+	// the pixel formats of the LTDC are RAW_FORMAT_ARGB8888 up to RAW_FORMAT_L8 (the same values), only L8 needs a CLUT
+	if(pPicture->compression != RAW_COMPRESSION_NONE || pPicture->pixelFormat > RAW_FORMAT_L8 || ((uintptr_t)pPicture->data % sizeof(uint32_t)) != 0
+			|| (pPicture->pixelFormat == RAW_FORMAT_L8 && pPicture->clut == NULL))
+	{
+		return 0;
+	}
+	// the CLUT of the LTDC has no alpha, so a transparent color would be drawn as a color
+	for(uint16_t index = 0; pPicture->pixelFormat == RAW_FORMAT_L8 && index < pPicture->clutSize; index++)
+	{
+		if((pPicture->clut[index] >> 24) != 0xFF)
+		{
+			return 0;
+		}
+	}
+#if PICTURE_TRANSITIONS
+	// the new picture of a transition is drawn in the transition buffer for the steps, the background layer takes it over when both buffers show it (finishTransition)
+	if(transitionState == transition_drawing)
+	{
+		handoffPicture = *pPicture;
+		layerHandoff = handoff_waiting;
+		return 0;
+	}
+#endif
+	// the gif frame or picture of the foreground layer would cover the picture
+	for(uint8_t buffer = 0; buffer < LCD_BUFFER_AMOUNT; buffer++)
+	{
+		clearPictureDamage(buffer, NULL);
+	}
+	loadLayerPicture(pPicture);
+	return 1;
+}
+
+/*!
+ * \brief loads the registers of the background layer for a picture, the LTDC shows it from the next vertical blanking on.
+ *
+ * \param pPicture -> struct with the picture data, the LTDC has to be able to read it (see showLayerPicture)
+ *
+ * \retval void
+ *
+ * \note the foreground layer isn't changed, whatever it shows in the picture area stays above the picture
+ */
+static void loadLayerPicture(const struct imageMetaData* pPicture)
+{
+	uint16_t x = PICTURE_X + ( ( PICTURE_WIDTH - pPicture->width ) / 2 );
+	uint16_t y = PICTURE_Y + ( ( PICTURE_HEIGHT - pPicture->height ) / 2 );
+
+	// the HAL of the LTDC is locked while the registers are written, frameDone also writes them from the DMA2D interrupt
+	__disable_irq();
+	if(pPicture->pixelFormat == RAW_FORMAT_L8 && pPicture->clut != pLayerClut)
+	{
+		// the CLUT can only be written while the LTDC doesn't read it: during the vertical synchronization, the interrupts can run between the reads of the status
+		while(!(hltdc.Instance->CDSR & LTDC_CDSR_VSYNCS))
+		{
+			__enable_irq();
+			__disable_irq();
+		}
+		WDA_LCD_SetLayerPicture(PICTURE_LAYER, pPicture->data, x, y, pPicture->width, pPicture->height, pPicture->pixelFormat);
+		WDA_LCD_SetLayerCLUT(PICTURE_LAYER, pPicture->clut, pPicture->clutSize);
+		pLayerClut = pPicture->clut;
+		// still in the vertical synchronization, so the new picture and its CLUT are shown at the same time
+		BSP_LCD_Reload(LCD_RELOAD_IMMEDIATE);
+	}
+	else
+	{
+		WDA_LCD_SetLayerPicture(PICTURE_LAYER, pPicture->data, x, y, pPicture->width, pPicture->height, pPicture->pixelFormat);
+		BSP_LCD_Reload(LCD_RELOAD_VERTICAL_BLANKING);
+	}
+	__enable_irq();
+	layerPicture = *pPicture;
+	layerPictureShown = 1;
+}
+
+/*!
+ * \brief stops showing a picture with the background layer, the background color of the LTDC is shown instead from the next vertical blanking on.
+ *
+ * \param void
+ *
+ * \retval void
+ *
+ */
+static void hideLayerPicture(void)
+{
+#if PICTURE_TRANSITIONS
+	// the old picture stays until the first step of the transition covers it
+	if(transitionState == transition_drawing)
+	{
+		return;
+	}
+#endif
+	if(layerPictureShown)
+	{
+		__disable_irq();
+		BSP_LCD_SetLayerVisible_NoReload(PICTURE_LAYER, DISABLE);
+		BSP_LCD_Reload(LCD_RELOAD_VERTICAL_BLANKING);
+		__enable_irq();
+		layerPictureShown = 0;
+	}
+}
+#endif
+
+#if PICTURE_TRANSITIONS
+/*!
+ * \brief draws what the LCD shows in the picture half in the old picture buffer of a transition: the white background, the picture of the background layer
+ * 		  and the foreground layer over it, so the steps can cover the picture half. The new picture is drawn in the transition buffer from now on, over white.
+ *
+ * \param void
+ *
+ * \retval void
+ *
+ * \note nothing happens when the transition is transition_none, the new picture is shown at once then
+ */
+static void startTransition(void)
+{
+	struct rawDirtyRect shown;
+
+	if(transitionKind == transition_none)
+	{
+		return;
+	}
+	// the buffer that is shown doesn't change anymore when the previous frame (or step) is flipped
+	while(frameBufferFree() == 0)
+	{
+		serviceDMA2D();
+	}
+	fillArea(TRANSITION_FROM_ADDRESS, &pictureArea, LCD_COLOR_WHITE);
+#if LAYER_PICTURES
+	if(layerPictureShown)
+	{
+		uint16_t x = PICTURE_X + ( ( PICTURE_WIDTH - layerPicture.width ) / 2 );
+		uint16_t y = PICTURE_Y + ( ( PICTURE_HEIGHT - layerPicture.height ) / 2 );
+		uint32_t* pDst = (uint32_t*)TRANSITION_FROM_ADDRESS + (y * LCD_WIDTH) + x;
+		struct dma2dJob layer = {.type = dma2d_blend, .pSrc = layerPicture.data, .srcOffset = 0, .srcFormat = layerPicture.pixelFormat, .srcAlpha = 0xFF,
+								 .pClut = layerPicture.clut, .clutSize = layerPicture.clutSize, .pBackground = pDst, .backgroundOffset = LCD_WIDTH - layerPicture.width,
+								 .backgroundFormat = RAW_FORMAT_ARGB8888, .pDst = pDst, .dstOffset = LCD_WIDTH - layerPicture.width, .dstFormat = RAW_FORMAT_ARGB8888,
+								 .width = layerPicture.width, .height = layerPicture.height};
+
+		addDMA2DJob(&layer);
+	}
+#endif
+	// only the damaged part of the foreground layer isn't transparent
+	shown = pictureDamage[shownBuffer];
+	if(shown.width != 0 && shown.height != 0)
+	{
+		uint32_t offset = (shown.y * LCD_WIDTH) + shown.x;
+		struct dma2dJob foreground = {.type = dma2d_blend, .pSrc = (uint32_t*)layerBuffers[shownBuffer] + offset, .srcOffset = LCD_WIDTH - shown.width, .srcFormat = RAW_FORMAT_ARGB8888,
+									  .srcAlpha = 0xFF, .pBackground = (uint32_t*)TRANSITION_FROM_ADDRESS + offset, .backgroundOffset = LCD_WIDTH - shown.width,
+									  .backgroundFormat = RAW_FORMAT_ARGB8888, .pDst = (uint32_t*)TRANSITION_FROM_ADDRESS + offset, .dstOffset = LCD_WIDTH - shown.width,
+									  .dstFormat = RAW_FORMAT_ARGB8888, .width = shown.width, .height = shown.height};
+
+		addDMA2DJob(&foreground);
+	}
+	fillArea(TRANSITION_TO_ADDRESS, &pictureArea, LCD_COLOR_WHITE);
+	pictureDamage[TRANSITION_BUFFER] = (struct rawDirtyRect){0};
+	transitionState = transition_drawing;
+}
+
+/*!
+ * \brief starts the steps of a transition once the new picture is queued, the LTDC line interrupt draws a step every refresh from now on.
+ *
+ * \param void
+ *
+ * \retval void
+ *
+ * \note the DMA2D draws the jobs in order, so the first step reads the old and new picture after they are drawn
+ */
+static void runTransition(void)
+{
+	if(transitionState != transition_drawing)
+	{
+		return;
+	}
+	__disable_irq();
+	transitionStatistics = (struct transitionStatistics){0};
+	totalStepCycles = 0;
+	lastLineCycles = 0;
+	transitionStart = getFrameTimer();
+	transitionState = transition_running;
+	__enable_irq();
+}
+
+/*!
+ * \brief stops the steps of a transition, the step that is drawn is still flipped and stays shown. The picture damage of the steps is the whole picture half,
+ * 		  so the next picture or clearPicture removes it.
+ *
+ * \param void
+ *
+ * \retval void
+ */
+static void stopTransition(void)
+{
+	__disable_irq();
+	transitionState = transition_idle;
+	__enable_irq();
+#if LAYER_PICTURES
+	// the picture that would be taken over isn't the new picture anymore
+	layerHandoff = handoff_none;
+#endif
+}
+
+/*!
+ * \brief called by the DMA2D queue (with interrupts disabled) when a step of a transition is drawn, measures its render time and flips the buffers.
+ *
+ * \param void
+ *
+ * \retval void
+ *
+ */
+static void transitionStepDone(void)
+{
+	uint32_t cycles = DWT->CYCCNT - stepStart;
+	uint32_t step_us = cycles / (SystemCoreClock / 1000000);
+
+	totalStepCycles += cycles;
+	transitionStatistics.steps++;
+	transitionStatistics.lastStep_us = step_us;
+	transitionStatistics.maxStep_us = (step_us > transitionStatistics.maxStep_us)? step_us : transitionStatistics.maxStep_us;
+#if LAYER_PICTURES
+	// the step covers the whole picture half, the background layer is hidden in the same vertical blanking as the flip
+	if(layerPictureShown)
+	{
+		BSP_LCD_SetLayerVisible_NoReload(PICTURE_LAYER, DISABLE);
+		layerPictureShown = 0;
+	}
+#endif
+	flipBuffers();
+}
+#endif
+
+/*!
+ * \brief reads status of onboard blue button
+ *
+ * \param void
+ *
+ *  \retval 1 when blue button is pushed
+ *  \retval 0 when blue button is released
+ *
+ */
+uint8_t readButton(void)
+{
+	// read input register
+	if(GPIOI->IDR & GPIO_PIN_11)
+	{
+		return 1;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+/*!
+ * \brief returns the time of the free running frame timer (TIM2)
+ *
+ * \param void
+ *
+ * \return the counter of TIM2, FRAME_TIMER_TICKS_PER_MS ticks per ms
+ *
+ * \note the counter wraps around, so times are compared with (int32_t)(a - b)
+ */
+static uint32_t getFrameTimer(void)
 {
-	// stop timer
-	HAL_TIM_Base_Stop_IT(&htim2);
+	return htim2.Instance->CNT;
 }
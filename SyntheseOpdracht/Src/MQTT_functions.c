@@ -2,7 +2,8 @@
 
 
 static int inpub_id;
-static enum data_types {Text, Img, Gif, Empty};
+static enum data_types {Text, Img, Gif, Widget, Empty};
+static err_t mqtt_publish_list(mqtt_client_t *client, const char *topic, fileExtension extType, void *arg);
 
 void mqtt_do_connect(mqtt_client_t *client)
 {
@@ -40,7 +41,7 @@ void mqtt_incoming_publish_cb(void *arg, const char *topic, u32_t tot_len)
 {
   printf("Incoming publish at topic %s with total length %u\n\r", topic, (unsigned int)tot_len);
 
-  //check if topic = 1 of the 3 send topics
+  //check if topic = 1 of the 4 send topics
   if(strncmp(topic, "sendText", strlen("sendText")) == 0)
   {
 	  inpub_id = Text;
@@ -53,6 +54,10 @@ void mqtt_incoming_publish_cb(void *arg, const char *topic, u32_t tot_len)
   {
 	  inpub_id = Gif;
   }
+  else if(strncmp(topic, "sendWidget", strlen("sendWidget")) == 0)
+  {
+	  inpub_id = Widget;
+  }
   else
   {
 	  inpub_id = Empty;
@@ -63,11 +68,7 @@ void mqtt_incoming_data_cb(void *arg, const u8_t *data, u16_t len, u8_t flags)
 {
   printf("Incoming publish payload with length %d, flags %u\n\r", len, (unsigned int)flags);
 
-  char*	imageList[getImageAmount()];
-  char 	name[getLargestNameLength()];
-  getImageList(imageList, png, a_z);
-  char* gifList[getGifAmount()];
-  getImageList(gifList, gif, a_z);
+  u16_t nameLength = len;
   struct imageMetaData buf = {.data = NULL, .name = NULL, .num = 0, .frameTime = 0, .height = 0, .width = 0};
 
   if(flags & MQTT_DATA_FLAG_LAST)
@@ -86,43 +87,36 @@ void mqtt_incoming_data_cb(void *arg, const u8_t *data, u16_t len, u8_t flags)
 
 	  else if(inpub_id == Img)
 	  {
-		  //If inpub_id = img then start sending the requested image to lcd
-		  uint8_t i = 0;
-		  while(i < getImageAmount())
+		  //If inpub_id = img then look the requested image up by name and send it to lcd
+		  //trailing whitespace or newlines of the payload are not part of the name
+		  while(nameLength > 0 && (data[nameLength - 1] == ' ' || data[nameLength - 1] == '\r' || data[nameLength - 1] == '\n'))
+		  {
+			  nameLength--;
+		  }
+		  if(findImageByName((char*)data, nameLength, png, &buf) == 1)
 		  {
-			  extractNameOutOfPath(imageList[i], strlen(imageList[i]), name[i], no_ext, lower);
-			  if(strncmp(data, name[i], strlen(name[i])) == 0)
-			  {
-				  getRawImageMetaData(imageList[i], strlen(imageList[i]), &buf);
-				  pictureToLCD(buf);
-				  break;
-			  }
-			  else
-			  {
-				  i++;
-			  }
+			  pictureToLCD(buf);
 		  }
 	  }
 
 	  else if(inpub_id == Gif)
 	  {
-		 //If inpub_id = Gif then start sending the requested gif to lcd
-		 uint8_t j = 0;
-		 while(j < getGifAmount())
+		 //If inpub_id = Gif then look the requested gif up by name and send it to lcd
+		 while(nameLength > 0 && (data[nameLength - 1] == ' ' || data[nameLength - 1] == '\r' || data[nameLength - 1] == '\n'))
 		 {
-			  extractNameOutOfPath(gifList[j], strlen(gifList[j]), name[j], no_ext, lower);
-			  if(strncmp(data, name[j], strlen(name[j])) == 0)
-			  {
-				  getRawImageMetaData(gifList[j], strlen(gifList[j]), &buf);
-				  pictureToLCD(buf);
-				  break;
-			  }
-			  else
-			  {
-				  j++;
-			  }
+			  nameLength--;
+		 }
+		 if(findImageByName((char*)data, nameLength, gif, &buf) == 1)
+		 {
+			  pictureToLCD(buf);
 		 }
 	  }
+
+	  else if(inpub_id == Widget)
+	  {
+		  //If inpub_id = Widget then the payload is the name of a widget and its new content, the main loop repaints it
+		  widgetCommand((const char*)data, len);
+	  }
   }
 }
 
@@ -162,38 +156,48 @@ void mqtt_pub_request_cb(void *arg, err_t result)
 void mqtt_do_publish(mqtt_client_t *client, void *arg)
 {
   err_t err;
-  u8_t qos = 0; /* 0 1 or 2, see MQTT specification */
-  u8_t retain = 0; /* No don't retain such crappy payload... */
-  char* imageList[getImageAmount()];
-  char* gifList[getImageAmount()];
-  char name[getLargestNameLength()];
-  getImageList(imageList, png, a_z);
-  getImageList(gifList, gif, a_z);
-  char fullImageList[250] = " ";
-  char fullGifList[250] = " ";
-
-  for(uint8_t i = 0; i < getImageAmount(); i++)
-  	{
-	  //extracting the names and putting them in 1 list so i can sent them with 1 publish
-	  extractNameOutOfPath(imageList[i], strlen(imageList[i]), name, ext, lower);
-	  strncat(fullImageList, name, strlen(*imageList));
-	  strncat(fullImageList, "\n\r", 5);
-  	}
-
-  err = mqtt_publish(client, "showImageList", fullImageList, strlen(fullImageList), qos, retain, mqtt_pub_request_cb, arg);
-
-  for(uint8_t j = 0; j < getGifAmount(); j++)
-  	{
-	  //extracting the names and putting them in 1 list so i can sent them with 1 publish
-	  extractNameOutOfPath(gifList[j], strlen(gifList[j]), name, ext, lower);
-	  strncat(fullGifList, name, strlen(*gifList));
-	  strncat(fullGifList, "\n\r", 5);
-  	}
 
-  err = mqtt_publish(client, "showGifList", fullGifList, strlen(fullGifList), qos, retain, mqtt_pub_request_cb, arg);
+  err = mqtt_publish_list(client, "showImageList", png, arg);
+  if(err == ERR_OK)
+  {
+	  err = mqtt_publish_list(client, "showGifList", gif, arg);
+  }
 
   if(err != ERR_OK) {
     printf("Publish err: %d\n\r", err);
   }
 }
 
+/* Publishes the names of all images or gifs on topic. The names are read from the catalog with a cursor and
+   published in pages of MQTT_LIST_PAGE_LENGTH bytes, so the list is not limited by the size of one buffer */
+static err_t mqtt_publish_list(mqtt_client_t *client, const char *topic, fileExtension extType, void *arg)
+{
+  err_t err = ERR_OK;
+  u8_t qos = 0; /* 0 1 or 2, see MQTT specification */
+  u8_t retain = 0; /* No don't retain such crappy payload... */
+  struct imageCursor cursor;
+  char* imagePath;
+  char name[MAX_PATH_LENGTH];
+  char fullList[MQTT_LIST_PAGE_LENGTH] = " ";
+
+  openImageCursor(&cursor, extType, a_z, NULL, 0);
+  while((imagePath = getNextImage(&cursor)) != NULL && err == ERR_OK)
+  {
+	  //extracting the names and putting them in 1 list so i can sent them with 1 publish
+	  extractNameOutOfPath(imagePath, strlen(imagePath), name, ext, lower);
+	  //when the name doesn't fit in the list anymore, the list is published and a new page is started
+	  if(strlen(fullList) + strlen(name) + strlen("\n\r") >= sizeof(fullList))
+	  {
+		  err = mqtt_publish(client, topic, fullList, strlen(fullList), qos, retain, mqtt_pub_request_cb, arg);
+		  strcpy(fullList, " ");
+	  }
+	  strncat(fullList, name, sizeof(fullList) - strlen(fullList) - 1);
+	  strncat(fullList, "\n\r", sizeof(fullList) - strlen(fullList) - 1);
+  }
+
+  if(err == ERR_OK)
+  {
+	  err = mqtt_publish(client, topic, fullList, strlen(fullList), qos, retain, mqtt_pub_request_cb, arg);
+  }
+  return err;
+}
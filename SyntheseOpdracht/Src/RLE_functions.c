@@ -0,0 +1,169 @@
+/*!
+ *  \file RLE_functions.c
+ *	\details This file contains the decoder of RAW_COMPRESSION_RLE16. The stream consists of 16 bit tokens, so every packet is halfword aligned:
+ *			 runs are written as pixel pairs with word stores and literals are copied with word loads and stores, also when the source and the
+ *			 destination have a different halfword alignment.
+ *  \remark The SDRAM is device memory (no MPU region), so the decoder never does an unaligned word access.
+ */
+#include "RLE_functions.h"
+
+static void fillPixels(uint16_t* pDst, uint16_t pixel, uint32_t count);
+static void copyPixels(uint16_t* pDst, const uint16_t* pSrc, uint32_t count);
+
+/*!
+ * \brief Decodes a RAW_COMPRESSION_RLE16 stream.
+ *
+ * \param pSrc -> the compressed data, halfword aligned
+ * \param srcSize -> the size of the compressed data in bytes
+ * \param pDst -> the decoded pixels, halfword aligned
+ * \param pixelAmount -> the amount of pixels of the frame (width * height)
+ *
+ * \retval 1 when the stream is decoded and it contained exactly pixelAmount pixels.
+ * \retval 0 when the stream is invalid, nothing is written outside pDst[0 .. pixelAmount-1].
+ */
+uint8_t decodeRLE16(const void* pSrc, uint32_t srcSize, uint16_t* pDst, uint32_t pixelAmount)
+{
+	const uint16_t* pIn = (const uint16_t*)pSrc;
+	const uint16_t* pInEnd = pIn + (srcSize / sizeof(uint16_t));
+	uint16_t* pOut = pDst;
+	uint16_t* pOutEnd = pDst + pixelAmount;
+
+	while(pIn < pInEnd)
+	{
+		uint32_t token = *pIn++;
+		uint32_t count = (token & RLE16_COUNT_MASK) + 1;
+
+		// a packet never writes past the frame or reads past the stream
+		if(count > (uint32_t)(pOutEnd - pOut))
+		{
+			return 0;
+		}
+		if(token & RLE16_RUN_FLAG)
+		{
+			if(pIn == pInEnd)
+			{
+				return 0;
+			}
+			fillPixels(pOut, *pIn++, count);
+		}
+		else
+		{
+			if(count > (uint32_t)(pInEnd - pIn))
+			{
+				return 0;
+			}
+			copyPixels(pOut, pIn, count);
+			pIn += count;
+		}
+		pOut += count;
+	}
+	return (pOut == pOutEnd)? 1 : 0;
+}
+
+/*!
+ * \brief Writes the same pixel count times.
+ *
+ * \param pDst -> the first pixel that is written
+ * \param pixel -> the pixel
+ * \param count -> the amount of pixels
+ *
+ * \retval void
+ */
+static void fillPixels(uint16_t* pDst, uint16_t pixel, uint32_t count)
+{
+	uint32_t pair = pixel | ((uint32_t)pixel << 16);
+	uint32_t* pWords;
+
+	// one pixel first when the destination isn't word aligned
+	if(((uintptr_t)pDst & 2) != 0)
+	{
+		*pDst++ = pixel;
+		count--;
+	}
+	pWords = (uint32_t*)pDst;
+	// 8 pixels per loop, the stores are combined into bursts to the SDRAM
+	while(count >= 8)
+	{
+		pWords[0] = pair;
+		pWords[1] = pair;
+		pWords[2] = pair;
+		pWords[3] = pair;
+		pWords += 4;
+		count -= 8;
+	}
+	while(count >= 2)
+	{
+		*pWords++ = pair;
+		count -= 2;
+	}
+	if(count != 0)
+	{
+		*(uint16_t*)pWords = pixel;
+	}
+}
+
+/*!
+ * \brief Copies count pixels.
+ *
+ * \param pDst -> the first pixel that is written
+ * \param pSrc -> the first pixel that is read
+ * \param count -> the amount of pixels
+ *
+ * \retval void
+ *
+ * \note memcpy copies byte per byte when the source and the destination have a different alignment, this copies words
+ */
+static void copyPixels(uint16_t* pDst, const uint16_t* pSrc, uint32_t count)
+{
+	uint32_t* pWords;
+	const uint32_t* pSrcWords;
+
+	if(((uintptr_t)pDst & 2) != 0 && count != 0)
+	{
+		*pDst++ = *pSrc++;
+		count--;
+	}
+	pWords = (uint32_t*)pDst;
+	if(((uintptr_t)pSrc & 2) == 0)
+	{
+		pSrcWords = (const uint32_t*)pSrc;
+		while(count >= 8)
+		{
+			pWords[0] = pSrcWords[0];
+			pWords[1] = pSrcWords[1];
+			pWords[2] = pSrcWords[2];
+			pWords[3] = pSrcWords[3];
+			pWords += 4;
+			pSrcWords += 4;
+			count -= 8;
+		}
+		while(count >= 2)
+		{
+			*pWords++ = *pSrcWords++;
+			count -= 2;
+		}
+		pSrc = (const uint16_t*)pSrcWords;
+	}
+	else
+	{
+		// the word before pSrc holds the first pixel in its upper half, every output word is made of the halves of two source words
+		// the loop stops one pair early, so it never reads the word after the last pixel
+		pSrcWords = (const uint32_t*)(pSrc - 1);
+		uint32_t previous = *pSrcWords++;
+		while(count >= 3)
+		{
+			uint32_t next = *pSrcWords++;
+			*pWords++ = (previous >> 16) | (next << 16);
+			previous = next;
+			count -= 2;
+		}
+		// the next pixel is the upper half of the last word that was read
+		pSrc = (const uint16_t*)pSrcWords - 1;
+	}
+	pDst = (uint16_t*)pWords;
+	while(count != 0)
+	{
+		*pDst++ = *pSrc++;
+		count--;
+	}
+}
@@ -0,0 +1,339 @@
+/*!
+ *  \file SCALE_functions.c
+ *	\details This file contains the image scaler. initScaleJob calculates the source column of every scaled column once, scaleRows calculates the next rows
+ *			 of the scaled image, so a large image can be streamed through a buffer of a few rows. The nearest filter copies the nearest source pixel,
+ *			 the bilinear filter weighs the 4 source pixels around the center of a scaled pixel.
+ *			 The bilinear filter weighs 2 channels with one multiply: UXTB16 (DSP extension of the cortex-M7) puts 2 bytes of a pixel in the 2 halfwords of
+ *			 a word and the products of 2 channels fit in their halfword. An ARGB1555 pixel is spread so its 3 colors are 6 bits apart, one multiply weighs all 3.
+ *  \remark The file doesn't use the HAL, so it is also compiled on the host by the benchmark (Benchmark/scale_bench.c), with C versions of the DSP instructions.
+ */
+#include "SCALE_functions.h"
+
+#if defined(__ARM_FEATURE_DSP)
+/*!
+ * \brief returns byte 0 and 2 of a word in the 2 halfwords (the blue and red channel of an ARGB8888 pixel).
+ */
+static inline uint32_t getEvenBytes(uint32_t value)
+{
+	return __UXTB16(value);
+}
+
+/*!
+ * \brief returns byte 1 and 3 of a word in the 2 halfwords (the green and alpha channel of an ARGB8888 pixel), one UXTB16 with rotation.
+ */
+static inline uint32_t getOddBytes(uint32_t value)
+{
+	uint32_t result;
+
+	__ASM ("uxtb16 %0, %1, ror #8" : "=r" (result) : "r" (value));
+	return result;
+}
+
+/*!
+ * \brief returns a word with 2 pixels of 16 bit, the first pixel in the low halfword.
+ */
+static inline uint32_t packPixels(uint32_t first, uint32_t second)
+{
+	return __PKHBT(first, second, 16);
+}
+#else
+static inline uint32_t getEvenBytes(uint32_t value)
+{
+	return value & 0x00FF00FFu;
+}
+
+static inline uint32_t getOddBytes(uint32_t value)
+{
+	return (value >> 8) & 0x00FF00FFu;
+}
+
+static inline uint32_t packPixels(uint32_t first, uint32_t second)
+{
+	return (first & 0xFFFFu) | (second << 16);
+}
+#endif
+
+// the colors of an ARGB1555 pixel spread over a word: blue in bit 0-4, red in bit 10-14 and green in bit 21-25
+#define ARGB1555_SPREAD_MASK 0x03E07C1Fu
+
+static void getSourceLine(scaleFilter filter, int32_t position, uint16_t size, uint16_t* pIndex, uint16_t* pWeight);
+static void scaleNearestARGB8888(const struct scaleJob* pJob, const uint32_t* pRow, uint32_t* pDst);
+static void scaleNearestARGB1555(const struct scaleJob* pJob, const uint16_t* pRow, uint16_t* pDst);
+static void scaleBilinearARGB8888(const struct scaleJob* pJob, const uint32_t* pTop, const uint32_t* pBottom, uint32_t weight, uint32_t* pDst);
+static void scaleBilinearARGB1555(const struct scaleJob* pJob, const uint16_t* pTop, const uint16_t* pBottom, uint32_t weight, uint16_t* pDst);
+
+/*!
+ * \brief Prepares the scaling of an image: the source column of every scaled column is calculated.
+ *
+ * \param pJob -> the job, it is filled
+ * \param pSrc -> the pixels of the image, without line offset, aligned to the size of a pixel
+ * \param srcWidth -> width of the image, smaller than 32768
+ * \param srcHeight -> height of the image, smaller than 32768
+ * \param pixelFormat -> RAW_FORMAT_ARGB8888 or RAW_FORMAT_ARGB1555
+ * \param dstWidth -> width of the scaled image, at most SCALE_MAX_WIDTH
+ * \param dstHeight -> height of the scaled image
+ * \param filter -> scale_nearest or scale_bilinear
+ *
+ * \retval 1 when the image can be scaled.
+ * \retval 0 when a size or the pixel format is invalid.
+ */
+uint8_t initScaleJob(struct scaleJob* pJob, const void* pSrc, uint16_t srcWidth, uint16_t srcHeight, uint8_t pixelFormat, uint16_t dstWidth, uint16_t dstHeight, scaleFilter filter)
+{
+	int32_t xStep;
+	int32_t xStart;
+
+	if(pSrc == NULL || srcWidth == 0 || srcWidth > 0x7FFF || srcHeight == 0 || srcHeight > 0x7FFF || dstWidth == 0 || dstWidth > SCALE_MAX_WIDTH || dstHeight == 0
+			|| (pixelFormat != RAW_FORMAT_ARGB8888 && pixelFormat != RAW_FORMAT_ARGB1555))
+	{
+		return 0;
+	}
+	pJob->pSrc = pSrc;
+	pJob->srcWidth = srcWidth;
+	pJob->srcHeight = srcHeight;
+	pJob->pixelFormat = pixelFormat;
+	pJob->filter = filter;
+	pJob->dstWidth = dstWidth;
+	pJob->dstHeight = dstHeight;
+	pJob->nextRow = 0;
+	// the center of scaled pixel n is at (n + 0.5) * step in the source, the bilinear filter weighs the pixels whose centers are around it
+	xStep = ((uint32_t)srcWidth << 16) / dstWidth;
+	xStart = xStep / 2 - ((filter == scale_bilinear)? 0x8000 : 0);
+	pJob->yStep = ((uint32_t)srcHeight << 16) / dstHeight;
+	pJob->yStart = pJob->yStep / 2 - ((filter == scale_bilinear)? 0x8000 : 0);
+	for(uint16_t x = 0; x < dstWidth; x++)
+	{
+		getSourceLine(filter, xStart + (int32_t)x * xStep, srcWidth, &pJob->columns[x], &pJob->weights[x]);
+	}
+	return 1;
+}
+
+/*!
+ * \brief Scales the next rows of an image.
+ *
+ * \param pJob -> the job (initScaleJob)
+ * \param pDst -> the rows are written here, in the pixel format of the image and without line offset. It has to be aligned to the size of a pixel.
+ * \param rowAmount -> the maximum amount of rows
+ *
+ * \return the amount of rows that were written, 0 when the whole image is scaled
+ */
+uint16_t scaleRows(struct scaleJob* pJob, void* pDst, uint16_t rowAmount)
+{
+	uint16_t rows = 0;
+	uint16_t line;
+	uint16_t weight;
+
+	while(rows < rowAmount && pJob->nextRow < pJob->dstHeight)
+	{
+		getSourceLine(pJob->filter, pJob->yStart + (int32_t)pJob->nextRow * pJob->yStep, pJob->srcHeight, &line, &weight);
+		if(pJob->pixelFormat == RAW_FORMAT_ARGB8888)
+		{
+			const uint32_t* pTop = (const uint32_t*)pJob->pSrc + (uint32_t)line * pJob->srcWidth;
+
+			if(pJob->filter == scale_bilinear)
+			{
+				// the last line is only read when the image has one line, its weight is 0 then
+				scaleBilinearARGB8888(pJob, pTop, pTop + ((pJob->srcHeight > 1)? pJob->srcWidth : 0), weight, pDst);
+			}
+			else
+			{
+				scaleNearestARGB8888(pJob, pTop, pDst);
+			}
+			pDst = (uint32_t*)pDst + pJob->dstWidth;
+		}
+		else
+		{
+			const uint16_t* pTop = (const uint16_t*)pJob->pSrc + (uint32_t)line * pJob->srcWidth;
+
+			if(pJob->filter == scale_bilinear)
+			{
+				scaleBilinearARGB1555(pJob, pTop, pTop + ((pJob->srcHeight > 1)? pJob->srcWidth : 0), weight, pDst);
+			}
+			else
+			{
+				scaleNearestARGB1555(pJob, pTop, pDst);
+			}
+			pDst = (uint16_t*)pDst + pJob->dstWidth;
+		}
+		pJob->nextRow++;
+		rows++;
+	}
+	return rows;
+}
+
+/*!
+ * \brief Calculates the largest size with the same aspect ratio as an image that fits in an area.
+ *
+ * \param width -> width of the image
+ * \param height -> height of the image
+ * \param maxWidth -> width of the area
+ * \param maxHeight -> height of the area
+ * \param pWidth -> filled with the width of the scaled image
+ * \param pHeight -> filled with the height of the scaled image
+ *
+ * \return void
+ *
+ * \note an image that touches both sides of the area in one direction keeps its size
+ */
+void fitImageSize(uint16_t width, uint16_t height, uint16_t maxWidth, uint16_t maxHeight, uint16_t* pWidth, uint16_t* pHeight)
+{
+	if(width == 0 || height == 0)
+	{
+		*pWidth = width;
+		*pHeight = height;
+		return;
+	}
+	// the side that reaches the side of the area first decides the scale
+	if((uint32_t)width * maxHeight >= (uint32_t)height * maxWidth)
+	{
+		*pWidth = maxWidth;
+		*pHeight = ((uint32_t)height * maxWidth + width / 2) / width;
+	}
+	else
+	{
+		*pHeight = maxHeight;
+		*pWidth = ((uint32_t)width * maxHeight + height / 2) / height;
+	}
+	*pWidth = (*pWidth == 0)? 1 : *pWidth;
+	*pHeight = (*pHeight == 0)? 1 : *pHeight;
+}
+
+/*!
+ * \brief Calculates the source line (row or column) of a scaled line.
+ *
+ * \param filter -> the filter of the job
+ * \param position -> the position in the source, 16.16 fixed point
+ * \param size -> the amount of source lines
+ * \param pIndex -> filled with the nearest source line, or the first of the 2 lines that are weighed
+ * \param pWeight -> filled with the weight of the line after it (0 up to 256), 0 for the nearest filter
+ *
+ * \return void
+ *
+ * \note a position outside the image is moved to the border, so the line after the first line always exists when the image has more than one line
+ */
+static void getSourceLine(scaleFilter filter, int32_t position, uint16_t size, uint16_t* pIndex, uint16_t* pWeight)
+{
+	int32_t last = ((int32_t)size - 1) << 16;
+
+	position = (position < 0)? 0 : (position > last)? last : position;
+	*pIndex = position >> 16;
+	*pWeight = 0;
+	if(filter == scale_bilinear)
+	{
+		*pWeight = (position >> 8) & 0xFF;
+		// the last line is the line after the line before it with the whole weight
+		if(*pIndex == size - 1 && size > 1)
+		{
+			(*pIndex)--;
+			*pWeight = 256;
+		}
+	}
+}
+
+/*!
+ * \brief Scales a row of an ARGB8888 image with the nearest filter.
+ */
+static void scaleNearestARGB8888(const struct scaleJob* pJob, const uint32_t* pRow, uint32_t* pDst)
+{
+	for(uint16_t x = 0; x < pJob->dstWidth; x++)
+	{
+		pDst[x] = pRow[pJob->columns[x]];
+	}
+}
+
+/*!
+ * \brief Scales a row of an ARGB1555 image with the nearest filter, 2 pixels are written with one store.
+ */
+static void scaleNearestARGB1555(const struct scaleJob* pJob, const uint16_t* pRow, uint16_t* pDst)
+{
+	uint16_t x = 0;
+
+	// a row of an odd width can start in the middle of a word
+	if(((uintptr_t)pDst % sizeof(uint32_t)) != 0)
+	{
+		pDst[x] = pRow[pJob->columns[x]];
+		x++;
+	}
+	for(; x + 1 < pJob->dstWidth; x += 2)
+	{
+		*(uint32_t*)&pDst[x] = packPixels(pRow[pJob->columns[x]], pRow[pJob->columns[x + 1]]);
+	}
+	if(x < pJob->dstWidth)
+	{
+		pDst[x] = pRow[pJob->columns[x]];
+	}
+}
+
+/*!
+ * \brief Scales a row of an ARGB8888 image with the bilinear filter.
+ *
+ * \param pJob -> the job
+ * \param pTop -> the source row above the center of the scaled row
+ * \param pBottom -> the source row below it
+ * \param weight -> the weight of the bottom row, 0 up to 256
+ * \param pDst -> the scaled row
+ *
+ * \return void
+ *
+ * \note every channel is weighed as (a * (256 - w) + b * w) / 256 in the rows and then in the columns, rounded down
+ */
+static void scaleBilinearARGB8888(const struct scaleJob* pJob, const uint32_t* pTop, const uint32_t* pBottom, uint32_t weight, uint32_t* pDst)
+{
+	// the column after the last column is only read when the image has one column, its weight is 0 then
+	uint16_t next = (pJob->srcWidth > 1)? 1 : 0;
+	uint32_t topWeight = 256 - weight;
+
+	for(uint16_t x = 0; x < pJob->dstWidth; x++)
+	{
+		const uint32_t* pTopLeft = pTop + pJob->columns[x];
+		const uint32_t* pBottomLeft = pBottom + pJob->columns[x];
+		uint32_t right = pJob->weights[x];
+		uint32_t left = 256 - right;
+		// blue and red, green and alpha are in the 2 halfwords, a weighed channel is at most 255 * 256 so it stays in its halfword
+		uint32_t topBR = getEvenBytes(pTopLeft[0]) * left + getEvenBytes(pTopLeft[next]) * right;
+		uint32_t topGA = getOddBytes(pTopLeft[0]) * left + getOddBytes(pTopLeft[next]) * right;
+		uint32_t bottomBR = getEvenBytes(pBottomLeft[0]) * left + getEvenBytes(pBottomLeft[next]) * right;
+		uint32_t bottomGA = getOddBytes(pBottomLeft[0]) * left + getOddBytes(pBottomLeft[next]) * right;
+		// the high byte of a halfword is the channel divided by 256
+		uint32_t br = getOddBytes(topBR) * topWeight + getOddBytes(bottomBR) * weight;
+		uint32_t ga = getOddBytes(topGA) * topWeight + getOddBytes(bottomGA) * weight;
+
+		pDst[x] = getOddBytes(br) | (ga & 0xFF00FF00u);
+	}
+}
+
+/*!
+ * \brief Scales a row of an ARGB1555 image with the bilinear filter.
+ *
+ * \param pJob -> the job
+ * \param pTop -> the source row above the center of the scaled row
+ * \param pBottom -> the source row below it
+ * \param weight -> the weight of the bottom row, 0 up to 256
+ * \param pDst -> the scaled row
+ *
+ * \return void
+ *
+ * \note the 5 bit colors are weighed with 5 bit weights (a * (32 - w) + b * w) / 32, first in the rows and then in the columns, rounded down.
+ * 		 The alpha bit is the bit of the nearest source pixel.
+ */
+static void scaleBilinearARGB1555(const struct scaleJob* pJob, const uint16_t* pTop, const uint16_t* pBottom, uint32_t weight, uint16_t* pDst)
+{
+	uint16_t next = (pJob->srcWidth > 1)? 1 : 0;
+	uint32_t bottomWeight = weight >> 3;
+	uint32_t topWeight = 32 - bottomWeight;
+	const uint16_t* pNearest = (weight >= 128)? pBottom : pTop;
+
+	for(uint16_t x = 0; x < pJob->dstWidth; x++)
+	{
+		uint16_t column = pJob->columns[x];
+		uint32_t right = pJob->weights[x] >> 3;
+		uint32_t left = 32 - right;
+		// a weighed color is at most 31 * 32, so it stays in its 10 bits
+		uint32_t top = (((pTop[column] | ((uint32_t)pTop[column] << 16)) & ARGB1555_SPREAD_MASK) * left
+						+ ((pTop[column + next] | ((uint32_t)pTop[column + next] << 16)) & ARGB1555_SPREAD_MASK) * right) >> 5;
+		uint32_t bottom = (((pBottom[column] | ((uint32_t)pBottom[column] << 16)) & ARGB1555_SPREAD_MASK) * left
+						   + ((pBottom[column + next] | ((uint32_t)pBottom[column + next] << 16)) & ARGB1555_SPREAD_MASK) * right) >> 5;
+		uint32_t color = (((top & ARGB1555_SPREAD_MASK) * topWeight + (bottom & ARGB1555_SPREAD_MASK) * bottomWeight) >> 5) & ARGB1555_SPREAD_MASK;
+
+		pDst[x] = (color & 0x7C1Fu) | ((color >> 16) & 0x03E0u) | (pNearest[column + ((pJob->weights[x] >= 128)? next : 0)] & 0x8000u);
+	}
+}
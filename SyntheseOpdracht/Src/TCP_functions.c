@@ -11,10 +11,15 @@
 
 
 /*variables are globals, need to persist between different commands to remember the list given by 'l' command, to be able to choose an image to display by the number command*/
-char** image_list;
+/*the list is read straight from the sorted catalog of the file system API: first all images, then all gifs. Only the streaming position is stored, not the list itself*/
+uint8_t image_list_generated = 0;
+struct imageCursor list_cursor;
+fileExtension list_extension;
+int list_number;
+uint8_t list_streaming = 0;
 
 char welcome_message_tcp[]="Welcome to the image picker program for our group project.\r\n";
-char welcome_message_tcp_commands[]="Send '\x1b[32;40ml\x1b[39;49m' to list all possible images.\r\nThen send a number to display the corresponding image.\r\nSend '\x1b[35;40mt\x1b[39;49m' followed by a space or comma, then your text to display that text.\r\nSend '\x1b[33;40mc\x1b[39;49m' to clear the screen.\r\nSend '\x1b[36;40mh\x1b[39;49m' to display a list of commands.\r\n";
+char welcome_message_tcp_commands[]="Send '\x1b[32;40ml\x1b[39;49m' to list all possible images.\r\nThen send a number to display the corresponding image.\r\nSend '\x1b[35;40mt\x1b[39;49m' followed by a space or comma, then your text to display that text.\r\nSend '\x1b[34;40mw\x1b[39;49m' followed by a space or comma, a widget name and its new content to update that widget.\r\nSend '\x1b[33;40mc\x1b[39;49m' to clear the screen.\r\nSend '\x1b[36;40mh\x1b[39;49m' to display a list of commands.\r\n";
 
 /*Regex patterns*/
 char* regexImage ="^\\d+[,\\s]*$";
@@ -22,6 +27,7 @@ char* regexHelp="^[hH]\\s*$";
 char* regexList="^[lL]\\s*$";
 char* regexText="^[tT][,\\s+].*$";
 char* regexClear="^[cC]\\s*$";
+char* regexWidget="^[wW][,\\s+].*$";
 
 /*!
  * \brief This function initializes TCP functionality & listens at port 64000 by default. Has to be called to correctly handle TCP commands
@@ -81,10 +87,66 @@ err_t handle_incoming_connection(void* arg, struct tcp_pcb *tpcb, err_t err){
  * \return returns error code
  */
 err_t succesful_send(void *arg, struct tcp_pcb *tpcb, u16_t len){
-	/*succesfully sent data, nothing needs to be done*/
+	/*succesfully sent data, room in the send buffer is freed so the next pages of the image list can be sent*/
+	if(list_streaming){
+		send_image_list_pages(tpcb);
+	}
 	return ERR_OK;
 }
 
+/*!
+ * \brief Sends the next pages of the image list (started by the 'l' command) for as long as they fit in the tcp send buffer. The rest of the list is sent from succesful_send, once the client has acknowledged the previous pages.
+ *
+ * \param tpcb -> the tcp_pcb (tcp protocol block) on which the list is sent.
+ *
+ * \return void
+ */
+void send_image_list_pages(struct tcp_pcb *tpcb){
+	/*every page holds IMAGE_LIST_PAGE_SIZE lines of the form '#x: name\r\n'*/
+	char page_text[IMAGE_LIST_PAGE_SIZE*(MAX_PATH_LENGTH+10)];
+	char image_name[MAX_PATH_LENGTH];
+	char* page[IMAGE_LIST_PAGE_SIZE];
+	struct imageCursor page_start;
+	int page_number;
+	int amount_page;
+	int tot_len;
+	int i;
+
+	while(list_streaming){
+		/*remembering the start of the page, so the page can be sent again when the send buffer is full*/
+		page_start = list_cursor;
+		page_number = list_number;
+		amount_page = getImagePage(&list_cursor, page, IMAGE_LIST_PAGE_SIZE);
+
+		/*all images are sent, continue with the gifs*/
+		if(amount_page == 0 && list_extension == png){
+			list_extension = gif;
+			openImageCursor(&list_cursor, gif, a_z, NULL, 0);
+			continue;
+		}
+		if(amount_page == 0){
+			list_streaming = 0;
+			break;
+		}
+
+		tot_len=0;
+		for(i=0; i< amount_page; i++){
+			/*extracting every name, 'adding' it to the string to later print*/
+			extractNameOutOfPath(page[i],strlen(page[i]),image_name,ext,lower);
+			tot_len+=snprintf(&page_text[tot_len],sizeof(page_text)-tot_len,"#%d: %s\r\n",list_number,image_name);
+			list_number++;
+		}
+
+		/*the send buffer is full, the page is sent again after the next successful send*/
+		if(tcp_sndbuf(tpcb) < tot_len || tcp_write(tpcb,page_text,tot_len,TCP_WRITE_FLAG_COPY) != ERR_OK){
+			list_cursor = page_start;
+			list_number = page_number;
+			break;
+		}
+	}
+	tcp_output(tpcb);
+}
+
 /*!
  *
  * \brief Callback function which is called when receiving a message. This reads the pbuf and stores it in a string, so the pbuf can be freed as quick as possible. Afterwards, the data is processes with the function handle_command
@@ -99,29 +161,29 @@ err_t succesful_send(void *arg, struct tcp_pcb *tpcb, u16_t len){
 
 err_t handle_incoming_message(void *arg, struct tcp_pcb *tpcb,struct pbuf *pbuf, err_t err){
 	/*write data to pbuf and depending from what is received do different actions*/
-	char data[TEXT_BUFFER_LENGTH];
-	int pbuf_len = pbuf->tot_len;
+	/*static: a text can be TEXT_MAX_LENGTH bytes, which doesn't fit on the stack, and the callbacks of lwIP don't interrupt each other*/
+	static char data[TEXT_MAX_LENGTH+1];
+	int data_len;
 
 
 	if(pbuf!=NULL){
-		for(int i=0;i<(pbuf->len);i++){
-			data[i] = ((char*)(pbuf->payload))[i];
-		}
+		/*the whole chain of pbufs is copied, a longer message is cut off like textToLCD does*/
+		data_len = pbuf_copy_partial(pbuf,data,(pbuf->tot_len < TEXT_MAX_LENGTH)? pbuf->tot_len : TEXT_MAX_LENGTH,0);
 
 		/* Making sure data is a null-terminated string*/
-		data[pbuf->len]='\0';
+		data[data_len]='\0';
 
 		/*handle the command*/
-		handle_command(data,pbuf_len,tpcb);
+		handle_command(data,data_len,tpcb);
 
-		tcp_recved(tpcb,pbuf->len);
+		tcp_recved(tpcb,pbuf->tot_len);
 		pbuf_free(pbuf);
 	}
 
 	/* If pbuf is empty, means connection is closed*/
 	else{
-		free(image_list);
-		image_list=NULL;
+		image_list_generated=0;
+		list_streaming=0;
 		tcp_close(tpcb);
 	}
 	return ERR_OK;
@@ -129,10 +191,10 @@ err_t handle_incoming_message(void *arg, struct tcp_pcb *tpcb,struct pbuf *pbuf,
 
 /*!
  *
- * \brief Handles the actions which need to be performed depending of the incoming message via tcp. Currently implemented are following commands: 'l', 't', and any number of max 2 digits
+ * \brief Handles the actions which need to be performed depending of the incoming message via tcp. Currently implemented are following commands: 'l', 't', 'w', and any number of max 2 digits
  *
  * \param command -> the message received over tcp, of which the contents are checked
- * \param command_length -> the length of the message, used because it command is not null-byte terminated per se
+ * \param command_length -> the length of the message, used because it command is not null-byte terminated per se. The buffer of command needs one byte more for the null-byte.
  * \param tpcb -> the tcp pcb (tcp protocol block) over which the message has been received, and which is used to send data back to for some commands.
  *
  * \return returns the error code
@@ -143,56 +205,37 @@ err_t handle_incoming_message(void *arg, struct tcp_pcb *tpcb,struct pbuf *pbuf,
 
 int handle_command(char* command,int command_length,struct tcp_pcb *tpcb){
 	int image_number;
-	int longest_name = getLargestNameLength();
 	int amount_total=getImageAmount()+getGifAmount();
+	struct imageCursor select_cursor;
+	char* image_path;
 	struct imageMetaData buf = {.data = NULL, .name = NULL, .num = 0, .frameTime = 0, .height = 0, .width = 0};
 	int match_length;
 
 	/*making sure command is a null-terminated string*/
 	command[command_length]='\0';
 
-	/* Checking if it's the first creation of the image list.
-	 * If it doesn't exist yet, create it with malloc
-	 */
-	if(image_list==NULL){
-		image_list = (char**)malloc(amount_total*sizeof(char*));
-	}
-
 	int err_code = 0;
-	int i;
 
 	if(re_match(regexList,command, &match_length) != -1){
 
-		/*variables to 'build' the list string*/
-		char imagelisttext[1000];
-		char temp_text[longest_name+10];
-		int tot_len=0;
-
-		/*list of all images + gifs*/
-		char image_name[longest_name];
-
-		int amount_images = getImageList(image_list,png,a_z);
-		getImageList(image_list+amount_images,gif,a_z);
-
-		for(i=0; i< amount_total; i++){
-
-			/*extracting every name, 'adding' it to the string to later print*/
-			extractNameOutOfPath(image_list[i],strlen(image_list[i]),image_name,ext,lower);
-
-			/* 6 is added for extra overhead of #x: \r\n*/
-			snprintf(temp_text,strlen(image_list[i])+6,"#%d: %s\r\n",i,image_name);
-			strncpy(&imagelisttext[tot_len],temp_text,strlen(image_list[i])+6);
-			tot_len+=strlen(image_list[i])+6;
-		}
-		tcp_write(tpcb,imagelisttext,tot_len,0);
-
-		/*Making sure it's a null-terminated string*/
-		imagelisttext[tot_len+2]='\0';
-		tcp_output(tpcb);
+		/*list of all images + gifs, sent page by page so the list can be as long as the catalog*/
+		list_extension = png;
+		list_number = 0;
+		openImageCursor(&list_cursor, png, a_z, NULL, 0);
+		list_streaming = 1;
+		image_list_generated = 1;
+		send_image_list_pages(tpcb);
 
 
 	}else if(re_match(regexText,command, &match_length) != -1){
 		textToLCD(command+2,strlen(command)-2,LCD_COLOR_RED);
+	}else if(re_match(regexWidget,command, &match_length) != -1){
+		/*the widget is repainted by the main loop*/
+		if(widgetCommand(command+2,strlen(command)-2) == 0){
+			char errortext4[60]="No widget with that name or content\r\n";
+			tcp_write(tpcb,errortext4,strlen(errortext4),0);
+			tcp_output(tpcb);
+		}
 	}else if(re_match(regexHelp,command, &match_length) != -1){
 		tcp_write(tpcb,welcome_message_tcp_commands,strlen(welcome_message_tcp_commands), 0);
 		tcp_output(tpcb);
@@ -200,12 +243,21 @@ int handle_command(char* command,int command_length,struct tcp_pcb *tpcb){
 		clearPicture();
 		clearText();
 	}else if(re_match(regexImage,command, &match_length) != -1){
-		if(image_list != NULL){
+		if(image_list_generated){
 			image_number = atoi(command);
 			printf("image #%d\r\n", image_number);
 
 			if(image_number < amount_total){
-				getRawImageMetaData((image_list[image_number]),strlen(image_list[image_number]),&buf);
+				/*the numbers of the list start with the images, followed by the gifs*/
+				if(image_number < getImageAmount()){
+					openImageCursor(&select_cursor, png, a_z, NULL, 0);
+					seekImageCursor(&select_cursor, image_number);
+				}else{
+					openImageCursor(&select_cursor, gif, a_z, NULL, 0);
+					seekImageCursor(&select_cursor, image_number-getImageAmount());
+				}
+				image_path = getNextImage(&select_cursor);
+				getRawImageMetaData(image_path,strlen(image_path),&buf);
 				pictureToLCD(buf);
 			}else{
 				/*no image with that number exists*/
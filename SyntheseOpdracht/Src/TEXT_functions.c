@@ -0,0 +1,213 @@
+/*!
+ *  \file TEXT_functions.c
+ *	\details This file contains the text renderer. initTextAtlas expands every character of a font (1 bit per pixel, see DrawChar of the BSP) into an A8 glyph
+ *			 of Width x Height bytes, 0x00 or 0xFF. drawTextLine copies the glyph lines of a whole line of text next to each other in a line buffer and queues two
+ *			 DMA2D jobs: a fill with the background color and a blend of the A8 line with the text color, so a line costs the same as one character.
+ *			 The text is UTF-8 (see LAYOUT_functions.c), drawTextLinePart only draws some pixel lines of a line of text, so a scrolling text can be drawn at any position.
+ *  \remark The result is the same as BSP_LCD_DisplayStringAt for opaque colors: every pixel of a character cell gets the text color or the background color.
+ */
+#include "TEXT_functions.h"
+
+static uint8_t glyphAtlas[TEXT_ATLAS_SIZE];
+static uint8_t lineBuffers[TEXT_LINE_BUFFERS][TEXT_LINE_MAX_WIDTH * TEXT_LINE_MAX_HEIGHT];
+// the DMA2D job that reads each line buffer, the buffer is only filled again when it is done
+static uint32_t lineJobs[TEXT_LINE_BUFFERS] = {0};
+static uint8_t nextLineBuffer = 0;
+// size of the glyphs in the atlas, 0 when there is no atlas
+static uint16_t glyphWidth = 0;
+static uint16_t glyphHeight = 0;
+// the ASCII letter that is drawn for the Latin-1 characters 0xC0 up to 0xFF (the accented letters)
+static const char latinLetters[64 + 1] = "AAAAAAACEEEEIIIIDNOOOOOxOUUUUY?saaaaaaaceeeeiiiidnooooo?ouuuuy?y";
+
+static uint8_t getGlyph(uint32_t character);
+
+/*!
+ * \brief Expands a font into the glyph atlas.
+ *
+ * \param pFont -> the font, one of the fonts of the BSP
+ *
+ * \retval 1 when the atlas holds the font.
+ * \retval 0 when the font doesn't fit in the atlas or a line buffer, drawTextLine draws nothing then.
+ */
+uint8_t initTextAtlas(const sFONT* pFont)
+{
+	uint16_t bytesPerLine = (pFont->Width + 7) / 8;
+
+	// the line buffers can still be read by the DMA2D
+	waitDMA2D();
+	glyphWidth = 0;
+	glyphHeight = 0;
+	if((uint32_t)TEXT_CHAR_AMOUNT * pFont->Width * pFont->Height > TEXT_ATLAS_SIZE || pFont->Height > TEXT_LINE_MAX_HEIGHT || bytesPerLine > 3)
+	{
+		return 0;
+	}
+	for(uint16_t glyph = 0; glyph < TEXT_CHAR_AMOUNT; glyph++)
+	{
+		const uint8_t* pBits = &pFont->table[glyph * pFont->Height * bytesPerLine];
+		uint8_t* pGlyph = &glyphAtlas[glyph * pFont->Width * pFont->Height];
+
+		for(uint16_t line = 0; line < pFont->Height; line++)
+		{
+			uint32_t bits = 0;
+
+			// the bits of a line are stored MSB first, padded to whole bytes
+			for(uint16_t byte = 0; byte < bytesPerLine; byte++)
+			{
+				bits = (bits << 8) | pBits[line * bytesPerLine + byte];
+			}
+			for(uint16_t column = 0; column < pFont->Width; column++)
+			{
+				pGlyph[line * pFont->Width + column] = (bits & (1UL << (bytesPerLine * 8 - 1 - column)))? 0xFF : 0x00;
+			}
+		}
+	}
+	glyphWidth = pFont->Width;
+	glyphHeight = pFont->Height;
+	return 1;
+}
+
+/*!
+ * \brief Draws a line of text in the framebuffer the BSP draws in, with the font of the atlas.
+ *
+ * \param x -> x position of the first character
+ * \param y -> y position of the top of the line
+ * \param pText -> the UTF-8 characters, a character that isn't in the atlas is drawn as TEXT_UNKNOWN_CHAR
+ * \param length -> the amount of bytes
+ * \param textColor -> ARGB8888 color of the characters
+ * \param backColor -> ARGB8888 color of the rest of the character cells
+ *
+ * \return the width of the line in pixels, the characters that don't fit on the layer are left out like BSP_LCD_DisplayStringAt does
+ *
+ * \note the DMA2D draws the line after the jobs that are queued already, the function doesn't wait for it
+ */
+uint16_t drawTextLine(uint16_t x, uint16_t y, const char* pText, uint16_t length, uint32_t textColor, uint32_t backColor)
+{
+	return drawTextLinePart(x, y, pText, length, 0, glyphHeight, textColor, backColor);
+}
+
+/*!
+ * \brief Draws some pixel lines of a line of text, for a line that is partly outside the text area (e.g. while the text scrolls).
+ *
+ * \param x -> x position of the first character
+ * \param y -> y position of the first pixel line that is drawn
+ * \param pText -> the UTF-8 characters (see drawTextLine)
+ * \param length -> the amount of bytes
+ * \param firstRow -> the first pixel line of the characters that is drawn, 0 is the top
+ * \param rowAmount -> the amount of pixel lines that are drawn
+ * \param textColor -> ARGB8888 color of the characters
+ * \param backColor -> ARGB8888 color of the rest of the character cells
+ *
+ * \return the width of the line in pixels, 0 when nothing is drawn
+ */
+uint16_t drawTextLinePart(uint16_t x, uint16_t y, const char* pText, uint16_t length, uint16_t firstRow, uint16_t rowAmount, uint32_t textColor, uint32_t backColor)
+{
+	uint32_t layerWidth = BSP_LCD_GetXSize();
+	const char* pNext = pText;
+	const char* pEnd = pText + length;
+	uint8_t glyphs[TEXT_LINE_MAX_WIDTH];
+	uint16_t maxChars;
+	uint16_t charAmount = 0;
+	uint16_t width;
+	uint8_t* pLine = lineBuffers[nextLineBuffer];
+	uint32_t* pDst;
+
+	if(glyphWidth == 0 || x >= layerWidth || firstRow >= glyphHeight)
+	{
+		return 0;
+	}
+	if(rowAmount > glyphHeight - firstRow)
+	{
+		rowAmount = glyphHeight - firstRow;
+	}
+	if(rowAmount == 0 || y + rowAmount > BSP_LCD_GetYSize())
+	{
+		return 0;
+	}
+	maxChars = (layerWidth - x) / glyphWidth;
+	if(maxChars > TEXT_LINE_MAX_WIDTH / glyphWidth)
+	{
+		maxChars = TEXT_LINE_MAX_WIDTH / glyphWidth;
+	}
+	while(pNext < pEnd && charAmount < maxChars)
+	{
+		glyphs[charAmount++] = getGlyph(decodeUTF8(&pNext, pEnd));
+	}
+	if(charAmount == 0)
+	{
+		return 0;
+	}
+	width = charAmount * glyphWidth;
+
+	// the buffer is filled while the DMA2D can still draw the previous line from the other one
+	waitDMA2DJob(lineJobs[nextLineBuffer]);
+	for(uint16_t index = 0; index < charAmount; index++)
+	{
+		const uint8_t* pGlyph = &glyphAtlas[glyphs[index] * glyphWidth * glyphHeight];
+
+		for(uint16_t row = 0; row < rowAmount; row++)
+		{
+			memcpy(&pLine[row * width + index * glyphWidth], &pGlyph[(firstRow + row) * glyphWidth], glyphWidth);
+		}
+	}
+
+	pDst = (uint32_t*)WDA_LCD_GetDrawAddress() + (y * layerWidth) + x;
+	struct dma2dJob fill = {.type = dma2d_fill, .pDst = pDst, .dstOffset = layerWidth - width, .dstFormat = RAW_FORMAT_ARGB8888, .width = width, .height = rowAmount, .color = backColor};
+	// the background is the framebuffer itself, so the characters are blended on the filled cells
+	struct dma2dJob blend = {.type = dma2d_blend, .pSrc = pLine, .srcFormat = RAW_FORMAT_A8, .srcAlpha = (textColor >> 24) & 0xFF, .pBackground = pDst,
+							 .backgroundOffset = layerWidth - width, .backgroundFormat = RAW_FORMAT_ARGB8888, .pDst = pDst, .dstOffset = layerWidth - width,
+							 .dstFormat = RAW_FORMAT_ARGB8888, .width = width, .height = rowAmount, .color = textColor};
+	addDMA2DJob(&fill);
+	addDMA2DJob(&blend);
+	lineJobs[nextLineBuffer] = getLastDMA2DJob();
+	nextLineBuffer = (nextLineBuffer + 1) % TEXT_LINE_BUFFERS;
+	return width;
+}
+
+/*!
+ * \brief Returns the height of a line of text.
+ *
+ * \param void
+ *
+ * \return the height of the font of the atlas in pixels, 0 when there is no atlas
+ */
+uint16_t getTextLineHeight(void)
+{
+	return glyphHeight;
+}
+
+/*!
+ * \brief Returns the width of a character, the fonts of the BSP are monospaced.
+ *
+ * \param void
+ *
+ * \return the width of the font of the atlas in pixels, 0 when there is no atlas
+ */
+uint16_t getTextCharWidth(void)
+{
+	return glyphWidth;
+}
+
+/*!
+ * \brief Returns the glyph of a character.
+ *
+ * \param character -> the code point
+ *
+ * \return the index of the glyph in the atlas
+ */
+static uint8_t getGlyph(uint32_t character)
+{
+	// a tab is drawn as a space
+	if(character == '\t')
+	{
+		character = ' ';
+	}
+	else if(character >= 0xC0 && character <= 0xFF)
+	{
+		character = (uint8_t)latinLetters[character - 0xC0];
+	}
+	if(character < TEXT_FIRST_CHAR || character > TEXT_LAST_CHAR)
+	{
+		character = TEXT_UNKNOWN_CHAR;
+	}
+	return character - TEXT_FIRST_CHAR;
+}
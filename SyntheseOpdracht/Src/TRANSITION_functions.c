@@ -0,0 +1,123 @@
+/*!
+ *  \file TRANSITION_functions.c
+ *	\details This file contains the steps of the picture transitions. getTransitionProgress turns the time since the start of a transition into its progress,
+ *			 getTransitionJobs turns the progress into the DMA2D jobs that draw the step: the old and the new picture are mixed into a framebuffer by the DMA2D,
+ *			 the CPU only fills in a few job structs.
+ *  \remark The old picture, the new picture and the framebuffer have the same line length, so one area is at the same offset in all three.
+ */
+#include "TRANSITION_functions.h"
+
+/*!
+ * \brief Calculates the progress of a transition. It starts and ends slowly (smoothstep), so a wipe or slide doesn't start and stop with a jump.
+ *
+ * \param elapsed -> time since the start of the transition
+ * \param duration -> time of the whole transition, in the same unit
+ *
+ * \return the progress from 0 up to TRANSITION_PROGRESS_END, TRANSITION_PROGRESS_END when the transition is done
+ */
+uint16_t getTransitionProgress(uint32_t elapsed, uint32_t duration)
+{
+	uint32_t linear;
+
+	if(elapsed >= duration)
+	{
+		return TRANSITION_PROGRESS_END;
+	}
+	linear = (uint32_t)(((uint64_t)elapsed * TRANSITION_PROGRESS_END) / duration);
+	// 3t^2 - 2t^3 with t = linear / 256
+	return (uint16_t)((linear * linear * (3 * TRANSITION_PROGRESS_END - 2 * linear)) / ((uint32_t)TRANSITION_PROGRESS_END * TRANSITION_PROGRESS_END));
+}
+
+/*!
+ * \brief Fills in the DMA2D jobs that draw one step of a transition. The pictures are ARGB8888 and opaque, the last step copies the new picture.
+ *
+ * \param type -> the kind of transition
+ * \param progress -> progress of the step (getTransitionProgress)
+ * \param pFrom -> the first pixel of the old picture
+ * \param pTo -> the first pixel of the new picture
+ * \param pDst -> the first pixel of the area in the framebuffer
+ * \param width -> width of the area
+ * \param height -> height of the area
+ * \param lineLength -> amount of pixels of a line of the pictures and the framebuffer
+ * \param pJobs -> array of TRANSITION_MAX_JOBS jobs, filled with the jobs of the step
+ *
+ * \return the amount of jobs, the jobs have no pDone function
+ */
+uint8_t getTransitionJobs(transitionType type, uint16_t progress, const uint32_t* pFrom, const uint32_t* pTo, uint32_t* pDst, uint16_t width, uint16_t height, uint16_t lineLength, struct dma2dJob* pJobs)
+{
+	// columns of the area that show the new picture
+	uint16_t newColumns = ((uint32_t)width * progress) / TRANSITION_PROGRESS_END;
+	struct dma2dJob copy = {.type = dma2d_copy, .srcFormat = RAW_FORMAT_ARGB8888, .srcAlpha = 0xFF, .dstFormat = RAW_FORMAT_ARGB8888, .height = height};
+	uint8_t jobs = 0;
+
+	if(progress >= TRANSITION_PROGRESS_END || type == transition_none)
+	{
+		pJobs[0] = copy;
+		pJobs[0].pSrc = pTo;
+		pJobs[0].srcOffset = lineLength - width;
+		pJobs[0].pDst = pDst;
+		pJobs[0].dstOffset = lineLength - width;
+		pJobs[0].width = width;
+		return 1;
+	}
+	switch(type)
+	{
+	case transition_crossfade:
+		// the new picture is the foreground, its alpha is multiplied with the progress and the old picture shows through
+		pJobs[0] = (struct dma2dJob){.type = dma2d_blend, .pSrc = pTo, .srcOffset = lineLength - width, .srcFormat = RAW_FORMAT_ARGB8888, .srcAlpha = (progress * 0xFF) / TRANSITION_PROGRESS_END,
+									 .pBackground = pFrom, .backgroundOffset = lineLength - width, .backgroundFormat = RAW_FORMAT_ARGB8888,
+									 .pDst = pDst, .dstOffset = lineLength - width, .dstFormat = RAW_FORMAT_ARGB8888, .width = width, .height = height};
+		jobs = 1;
+		break;
+	case transition_wipe:
+		// the new picture on the left, the old picture stays on the right
+		if(newColumns != 0)
+		{
+			pJobs[jobs] = copy;
+			pJobs[jobs].pSrc = pTo;
+			pJobs[jobs].pDst = pDst;
+			pJobs[jobs].width = newColumns;
+			jobs++;
+		}
+		if(newColumns != width)
+		{
+			pJobs[jobs] = copy;
+			pJobs[jobs].pSrc = pFrom + newColumns;
+			pJobs[jobs].pDst = pDst + newColumns;
+			pJobs[jobs].width = width - newColumns;
+			jobs++;
+		}
+		break;
+	case transition_slide:
+		// the right part of the old picture moves to the left, the left part of the new picture comes in on the right
+		if(newColumns != width)
+		{
+			pJobs[jobs] = copy;
+			pJobs[jobs].pSrc = pFrom + newColumns;
+			pJobs[jobs].pDst = pDst;
+			pJobs[jobs].width = width - newColumns;
+			jobs++;
+		}
+		if(newColumns != 0)
+		{
+			pJobs[jobs] = copy;
+			pJobs[jobs].pSrc = pTo;
+			pJobs[jobs].pDst = pDst + (width - newColumns);
+			pJobs[jobs].width = newColumns;
+			jobs++;
+		}
+		break;
+	default:
+		break;
+	}
+	// the copies skip the rest of every line
+	for(uint8_t job = 0; job < jobs; job++)
+	{
+		if(pJobs[job].type == dma2d_copy)
+		{
+			pJobs[job].srcOffset = lineLength - pJobs[job].width;
+			pJobs[job].dstOffset = lineLength - pJobs[job].width;
+		}
+	}
+	return jobs;
+}
@@ -0,0 +1,679 @@
+/*!
+ *  \file WIDGET_functions.c
+ *	\details This file contains the widget compositor. The widgets are kept in a table, a function that changes a widget only changes the table and marks it dirty.
+ *			 composeWidgets repaints the old and the new area of every dirty widget: the areas are made transparent and every widget that overlaps them is drawn
+ *			 again by the DMA2D in z-order. A widget that is drawn again is drawn completely, so the widgets that overlap it are drawn again as well.
+ *  \remark The widgets are drawn in the framebuffer the BSP draws in, the functions have to be called from the main loop (not from an interrupt).
+ */
+#include "WIDGET_functions.h"
+
+/* checks if two areas have pixels in common */
+static uint8_t areasOverlap(const struct rawDirtyRect* pFirst, const struct rawDirtyRect* pSecond);
+/* checks if an area can be used by a widget: on the LCD and, unless it is a zone, outside the zones */
+static uint8_t checkWidgetArea(uint8_t widget, widgetType type, const struct rawDirtyRect* pArea);
+/* adds an area to the areas that are repainted */
+static void addRepaintArea(struct rawDirtyRect* pAreas, uint8_t* pAmount, const struct rawDirtyRect* pArea);
+/* draws a widget in the framebuffer the BSP draws in */
+static void drawWidget(const struct widget* pWidget);
+/* draws the picture of a picture widget */
+static void drawWidgetPicture(const struct widget* pWidget);
+/* fills an area of the framebuffer the BSP draws in with a color */
+static void fillWidgetArea(const struct rawDirtyRect* pArea, uint32_t color);
+/* checks if a widget can be changed */
+static uint8_t isWidget(uint8_t widget);
+
+static struct widget widgets[WIDGET_MAX_AMOUNT];
+
+/*!
+ * \brief Adds a widget to the layout, it is drawn by the next composeWidgets.
+ *
+ * \param type -> the kind of widget, a zone is an area the LCD functions draw in themselves
+ * \param pName -> the name of the widget (null terminated, at most WIDGET_NAME_LENGTH-1 characters), updateWidget finds the widget with it
+ * \param x -> x position of the area
+ * \param y -> y position of the area
+ * \param width -> width of the area
+ * \param height -> height of the area
+ * \param z -> the widget is drawn over the widgets with a lower z
+ *
+ * \return the handle of the widget
+ * \retval NO_WIDGET when the table is full, the name is too long or used already or the area is off the LCD or overlaps a zone
+ *
+ * \note a fill is black, a label has white text on a transparent background and a picture widget has no picture until they are changed
+ */
+uint8_t createWidget(widgetType type, const char* pName, uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t z)
+{
+	struct rawDirtyRect area = {.x = x, .y = y, .width = width, .height = height};
+	uint8_t widget;
+
+	if(strlen(pName) >= WIDGET_NAME_LENGTH || findWidget(pName, strlen(pName)) != NO_WIDGET || checkWidgetArea(NO_WIDGET, type, &area) == 0)
+	{
+		return NO_WIDGET;
+	}
+	// a deleted widget is only reused once its area is repainted
+	for(widget = 0; widget < WIDGET_MAX_AMOUNT && (widgets[widget].used || widgets[widget].dirty); widget++);
+	if(widget == WIDGET_MAX_AMOUNT)
+	{
+		printf("no widget left for %s\r\n", pName);
+		return NO_WIDGET;
+	}
+	widgets[widget] = (struct widget){.used = 1, .visible = 1, .dirty = (type != widget_zone), .z = z, .type = type, .area = area,
+									  .color = (type == widget_label)? LCD_COLOR_WHITE : LCD_COLOR_BLACK, .backColor = LCD_COLOR_TRANSPARENT};
+	strcpy(widgets[widget].name, pName);
+	return widget;
+}
+
+/*!
+ * \brief Removes a widget from the layout, the next composeWidgets repaints its area without it.
+ *
+ * \param widget -> handle of the widget
+ *
+ * \retval 1 when the widget is removed.
+ * \retval 0 when there is no such widget.
+ */
+uint8_t deleteWidget(uint8_t widget)
+{
+	if(isWidget(widget) == 0)
+	{
+		return 0;
+	}
+	widgets[widget].used = 0;
+	widgets[widget].visible = 0;
+	// a zone is never painted, so there is nothing to repaint
+	widgets[widget].dirty = (widgets[widget].type != widget_zone);
+	return 1;
+}
+
+/*!
+ * \brief Finds a widget by its name.
+ *
+ * \param pName -> the name, it doesn't have to be null terminated
+ * \param nameLength -> the length of the name
+ *
+ * \return the handle of the widget
+ * \retval NO_WIDGET when no widget has that name
+ */
+uint8_t findWidget(const char* pName, uint16_t nameLength)
+{
+	for(uint8_t widget = 0; widget < WIDGET_MAX_AMOUNT; widget++)
+	{
+		if(widgets[widget].used && nameLength < WIDGET_NAME_LENGTH && strncmp(widgets[widget].name, pName, nameLength) == 0 && widgets[widget].name[nameLength] == '\0')
+		{
+			return widget;
+		}
+	}
+	return NO_WIDGET;
+}
+
+/*!
+ * \brief Moves a widget or changes its size.
+ *
+ * \param widget -> handle of the widget, not a zone
+ * \param x -> x position of the new area
+ * \param y -> y position of the new area
+ * \param width -> width of the new area
+ * \param height -> height of the new area
+ *
+ * \retval 1 when the widget is moved.
+ * \retval 0 when there is no such widget or the area is off the LCD or overlaps a zone.
+ */
+uint8_t moveWidget(uint8_t widget, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+	struct rawDirtyRect area = {.x = x, .y = y, .width = width, .height = height};
+
+	if(isWidget(widget) == 0 || widgets[widget].type == widget_zone || checkWidgetArea(widget, widgets[widget].type, &area) == 0)
+	{
+		return 0;
+	}
+	// the old area stays in shownArea, so it is repainted as well
+	widgets[widget].area = area;
+	widgets[widget].dirty = 1;
+	return 1;
+}
+
+/*!
+ * \brief Changes the z-order of a widget.
+ *
+ * \param widget -> handle of the widget
+ * \param z -> the widget is drawn over the widgets with a lower z
+ *
+ * \retval 1 when the order is changed.
+ * \retval 0 when there is no such widget.
+ */
+uint8_t setWidgetOrder(uint8_t widget, uint8_t z)
+{
+	if(isWidget(widget) == 0)
+	{
+		return 0;
+	}
+	if(widgets[widget].z != z)
+	{
+		widgets[widget].z = z;
+		widgets[widget].dirty = (widgets[widget].type != widget_zone);
+	}
+	return 1;
+}
+
+/*!
+ * \brief Shows or hides a widget, a hidden widget keeps its content.
+ *
+ * \param widget -> handle of the widget
+ * \param visible -> 1 to show the widget, 0 to hide it
+ *
+ * \retval 1 when the widget is changed.
+ * \retval 0 when there is no such widget.
+ */
+uint8_t setWidgetVisible(uint8_t widget, uint8_t visible)
+{
+	if(isWidget(widget) == 0)
+	{
+		return 0;
+	}
+	if(widgets[widget].visible != visible)
+	{
+		widgets[widget].visible = visible;
+		widgets[widget].dirty = (widgets[widget].type != widget_zone);
+	}
+	return 1;
+}
+
+/*!
+ * \brief Changes the colors of a widget.
+ *
+ * \param widget -> handle of the widget
+ * \param color -> ARGB8888 color of a fill, of the text of a label or of a picture in the A8 or A4 format
+ * \param backColor -> ARGB8888 color of the area of a label or picture, a label replaces the widgets under it with this color,
+ * 						a picture with a transparent backColor (LCD_COLOR_TRANSPARENT) is blended over the widgets under it
+ *
+ * \retval 1 when the colors are changed.
+ * \retval 0 when there is no such widget.
+ */
+uint8_t setWidgetColor(uint8_t widget, uint32_t color, uint32_t backColor)
+{
+	if(isWidget(widget) == 0)
+	{
+		return 0;
+	}
+	if(widgets[widget].color != color || widgets[widget].backColor != backColor)
+	{
+		widgets[widget].color = color;
+		widgets[widget].backColor = backColor;
+		widgets[widget].dirty = (widgets[widget].type != widget_zone);
+	}
+	return 1;
+}
+
+/*!
+ * \brief Changes the text of a label, the text that doesn't fit in the width of the label is cut off.
+ *
+ * \param widget -> handle of the label
+ * \param pText -> the UTF-8 text, one line, it is copied
+ * \param length -> the amount of bytes, at most WIDGET_TEXT_LENGTH are kept
+ *
+ * \retval 1 when the text is changed.
+ * \retval 0 when there is no such label.
+ */
+uint8_t setWidgetText(uint8_t widget, const char* pText, uint16_t length)
+{
+	if(isWidget(widget) == 0 || widgets[widget].type != widget_label)
+	{
+		return 0;
+	}
+	length = (length > WIDGET_TEXT_LENGTH)? WIDGET_TEXT_LENGTH : length;
+	// the same text isn't drawn again
+	if(widgets[widget].textLength != length || memcmp(widgets[widget].text, pText, length) != 0)
+	{
+		memcpy(widgets[widget].text, pText, length);
+		widgets[widget].textLength = length;
+		widgets[widget].dirty = 1;
+	}
+	return 1;
+}
+
+/*!
+ * \brief Changes the picture of a picture widget. The picture is centered in the widget, the part that doesn't fit is cut off.
+ *
+ * \param widget -> handle of the picture widget
+ * \param pPicture -> the picture (not a gif), it is copied. NULL to remove the picture.
+ *
+ * \retval 1 when the picture is changed.
+ * \retval 0 when there is no such picture widget or the picture is a gif.
+ */
+uint8_t setWidgetPicture(uint8_t widget, const struct imageMetaData* pPicture)
+{
+	if(isWidget(widget) == 0 || widgets[widget].type != widget_picture || (pPicture != NULL && pPicture->frameTime != 0))
+	{
+		return 0;
+	}
+	if(pPicture == NULL)
+	{
+		widgets[widget].picture = (struct imageMetaData){0};
+	}
+	else
+	{
+		widgets[widget].picture = *pPicture;
+		// the name points into the catalog, it can be rebuilt while the widget shows the picture
+		widgets[widget].picture.name = NULL;
+	}
+	widgets[widget].dirty = 1;
+	return 1;
+}
+
+/*!
+ * \brief Changes the content of a widget by its name, for the TCP, MQTT and web interface: the text of a label, the name of the picture of a picture widget
+ * 		  or the hexadecimal color of a fill (RRGGBB or AARRGGBB, a '#' in front is allowed).
+ *
+ * \param pName -> the name of the widget
+ * \param nameLength -> the length of the name
+ * \param pContent -> the new content, an empty content removes the picture of a picture widget
+ * \param contentLength -> the length of the content
+ *
+ * \retval 1 when the widget is changed.
+ * \retval 0 when there is no such widget, it is a zone, the picture doesn't exist or the color isn't hexadecimal.
+ */
+uint8_t updateWidget(const char* pName, uint16_t nameLength, const char* pContent, uint16_t contentLength)
+{
+	uint8_t widget = findWidget(pName, nameLength);
+	struct imageMetaData picture;
+	char color[9] = {0};
+	char* pEnd;
+	uint32_t value;
+
+	if(widget == NO_WIDGET)
+	{
+		printf("no widget %.*s\r\n", nameLength, pName);
+		return 0;
+	}
+	switch(widgets[widget].type)
+	{
+	case widget_label:
+		return setWidgetText(widget, pContent, contentLength);
+	case widget_picture:
+		if(contentLength == 0)
+		{
+			return setWidgetPicture(widget, NULL);
+		}
+		if(findImageByName((char*)pContent, contentLength, png, &picture) == 0)
+		{
+			printf("no picture %.*s for widget %s\r\n", contentLength, pContent, widgets[widget].name);
+			return 0;
+		}
+		return setWidgetPicture(widget, &picture);
+	case widget_fill:
+		if(contentLength != 0 && pContent[0] == '#')
+		{
+			pContent++;
+			contentLength--;
+		}
+		if(contentLength != 6 && contentLength != 8)
+		{
+			return 0;
+		}
+		memcpy(color, pContent, contentLength);
+		value = strtoul(color, &pEnd, 16);
+		if(*pEnd != '\0')
+		{
+			return 0;
+		}
+		// a color without alpha is opaque
+		return setWidgetColor(widget, (contentLength == 6)? (value | 0xFF000000) : value, widgets[widget].backColor);
+	default:
+		return 0;
+	}
+}
+
+/*!
+ * \brief Handles a widget command: the name of the widget, a space or a comma and the new content (see updateWidget).
+ *
+ * \param pCommand -> the command, it doesn't have to be null terminated, a "\r\n" at the end is ignored
+ * \param length -> the length of the command
+ *
+ * \retval 1 when the widget is changed.
+ * \retval 0 when the command has no name or the widget can't be changed.
+ */
+uint8_t widgetCommand(const char* pCommand, uint16_t length)
+{
+	uint16_t nameLength = 0;
+
+	while(length != 0 && (pCommand[length - 1] == '\r' || pCommand[length - 1] == '\n'))
+	{
+		length--;
+	}
+	while(nameLength < length && pCommand[nameLength] != ' ' && pCommand[nameLength] != ',')
+	{
+		nameLength++;
+	}
+	if(nameLength == 0)
+	{
+		return 0;
+	}
+	// the separator isn't part of the content
+	return updateWidget(pCommand, nameLength, pCommand + nameLength + ((nameLength < length)? 1 : 0), length - nameLength - ((nameLength < length)? 1 : 0));
+}
+
+/*!
+ * \brief Checks if a widget changed since the last composeWidgets.
+ *
+ * \param void
+ *
+ * \retval 1 when a widget has to be repainted.
+ * \retval 0 when the LCD shows every widget as it is.
+ */
+uint8_t widgetsDirty(void)
+{
+	for(uint8_t widget = 0; widget < WIDGET_MAX_AMOUNT; widget++)
+	{
+		if(widgets[widget].dirty)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*!
+ * \brief Repaints the widgets that changed in the framebuffer the BSP draws in. The old and new areas of the dirty widgets are made transparent and
+ * 		  the widgets that overlap them are drawn again from the lowest to the highest z, until no drawn widget overlaps a widget that isn't drawn.
+ *
+ * \param pAreas -> array of WIDGET_MAX_AREAS areas, filled with the areas of the LCD that are repainted
+ *
+ * \return the amount of areas, 0 when nothing changed
+ *
+ * \note the DMA2D draws the widgets after the jobs that are queued already, the function doesn't wait for it
+ */
+uint8_t composeWidgets(struct rawDirtyRect* pAreas)
+{
+	// 1 for the widgets that are drawn again
+	uint8_t redraw[WIDGET_MAX_AMOUNT] = {0};
+	uint8_t areaAmount = 0;
+	uint8_t added = 1;
+	uint8_t next;
+
+	for(uint8_t widget = 0; widget < WIDGET_MAX_AMOUNT; widget++)
+	{
+		if(widgets[widget].dirty)
+		{
+			addRepaintArea(pAreas, &areaAmount, &widgets[widget].shownArea);
+			if(widgets[widget].used && widgets[widget].visible)
+			{
+				addRepaintArea(pAreas, &areaAmount, &widgets[widget].area);
+				redraw[widget] = 1;
+			}
+		}
+	}
+	// a widget that overlaps a repainted area is drawn again completely, so its whole area is repainted as well
+	while(added)
+	{
+		added = 0;
+		for(uint8_t widget = 0; widget < WIDGET_MAX_AMOUNT; widget++)
+		{
+			if(redraw[widget] || widgets[widget].used == 0 || widgets[widget].visible == 0 || widgets[widget].type == widget_zone)
+			{
+				continue;
+			}
+			for(uint8_t area = 0; area < areaAmount && redraw[widget] == 0; area++)
+			{
+				if(areasOverlap(&widgets[widget].area, &pAreas[area]))
+				{
+					addRepaintArea(pAreas, &areaAmount, &widgets[widget].area);
+					redraw[widget] = 1;
+					added = 1;
+				}
+			}
+		}
+	}
+	for(uint8_t area = 0; area < areaAmount; area++)
+	{
+		fillWidgetArea(&pAreas[area], LCD_COLOR_TRANSPARENT);
+	}
+	// the widgets are drawn from the lowest z up, widgets with the same z in the order of the table
+	do
+	{
+		next = NO_WIDGET;
+		for(uint8_t widget = 0; widget < WIDGET_MAX_AMOUNT; widget++)
+		{
+			if(redraw[widget] && (next == NO_WIDGET || widgets[widget].z < widgets[next].z))
+			{
+				next = widget;
+			}
+		}
+		if(next != NO_WIDGET)
+		{
+			drawWidget(&widgets[next]);
+			redraw[next] = 0;
+		}
+	}
+	while(next != NO_WIDGET);
+	for(uint8_t widget = 0; widget < WIDGET_MAX_AMOUNT; widget++)
+	{
+		if(widgets[widget].dirty)
+		{
+			widgets[widget].shownArea = (widgets[widget].used && widgets[widget].visible)? widgets[widget].area : (struct rawDirtyRect){0};
+			widgets[widget].dirty = 0;
+		}
+	}
+	return areaAmount;
+}
+
+/*!
+ * \brief Checks if two areas have pixels in common.
+ *
+ * \param pFirst -> the first area
+ * \param pSecond -> the second area
+ *
+ * \retval 1 when they overlap.
+ * \retval 0 when they don't overlap or one of them is empty.
+ */
+static uint8_t areasOverlap(const struct rawDirtyRect* pFirst, const struct rawDirtyRect* pSecond)
+{
+	return (pFirst->width != 0 && pFirst->height != 0 && pSecond->width != 0 && pSecond->height != 0
+			&& pFirst->x < pSecond->x + pSecond->width && pSecond->x < pFirst->x + pFirst->width
+			&& pFirst->y < pSecond->y + pSecond->height && pSecond->y < pFirst->y + pFirst->height);
+}
+
+/*!
+ * \brief Checks if an area can be used by a widget: it isn't empty and lies on the LCD. A zone can't overlap a widget that isn't a zone and the other way around,
+ * 		  so the compositor never paints over what the LCD functions draw.
+ *
+ * \param widget -> handle of the widget that gets the area, NO_WIDGET for a new widget
+ * \param type -> the kind of the widget
+ * \param pArea -> the area
+ *
+ * \retval 1 when the area can be used.
+ * \retval 0 when it can't.
+ */
+static uint8_t checkWidgetArea(uint8_t widget, widgetType type, const struct rawDirtyRect* pArea)
+{
+	if(pArea->width == 0 || pArea->height == 0 || (uint32_t)pArea->x + pArea->width > BSP_LCD_GetXSize() || (uint32_t)pArea->y + pArea->height > BSP_LCD_GetYSize())
+	{
+		return 0;
+	}
+	for(uint8_t other = 0; other < WIDGET_MAX_AMOUNT; other++)
+	{
+		if(other != widget && widgets[other].used && (widgets[other].type == widget_zone) != (type == widget_zone) && areasOverlap(&widgets[other].area, pArea))
+		{
+			printf("widget area %u,%u %ux%u overlaps %s\r\n", pArea->x, pArea->y, pArea->width, pArea->height, widgets[other].name);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*!
+ * \brief Adds an area to the areas that are repainted, an empty area or an area that lies within one of them is left out.
+ *
+ * \param pAreas -> array of WIDGET_MAX_AREAS areas
+ * \param pAmount -> the amount of areas in the array, it is incremented when the area is added
+ * \param pArea -> the area
+ *
+ * \retval void
+ *
+ * \note every widget adds at most its old and its new area, so the array doesn't overflow
+ */
+static void addRepaintArea(struct rawDirtyRect* pAreas, uint8_t* pAmount, const struct rawDirtyRect* pArea)
+{
+	if(pArea->width == 0 || pArea->height == 0 || *pAmount >= WIDGET_MAX_AREAS)
+	{
+		return;
+	}
+	for(uint8_t area = 0; area < *pAmount; area++)
+	{
+		if(pArea->x >= pAreas[area].x && pArea->y >= pAreas[area].y && pArea->x + pArea->width <= pAreas[area].x + pAreas[area].width
+				&& pArea->y + pArea->height <= pAreas[area].y + pAreas[area].height)
+		{
+			return;
+		}
+	}
+	pAreas[(*pAmount)++] = *pArea;
+}
+
+/*!
+ * \brief Draws a widget in the framebuffer the BSP draws in. A fill or label replaces what is under it, a picture is blended over its background color
+ * 		  and the widgets under it.
+ *
+ * \param pWidget -> the widget
+ *
+ * \retval void
+ */
+static void drawWidget(const struct widget* pWidget)
+{
+	uint16_t charWidth = getTextCharWidth();
+	uint16_t lineHeight = getTextLineHeight();
+	uint16_t maxChars;
+	uint16_t firstRow = 0;
+	uint16_t y = pWidget->area.y;
+	const char* pEnd = pWidget->text;
+
+	switch(pWidget->type)
+	{
+	case widget_fill:
+		fillWidgetArea(&pWidget->area, pWidget->color);
+		break;
+	case widget_label:
+		fillWidgetArea(&pWidget->area, pWidget->backColor);
+		if(charWidth == 0 || pWidget->textLength == 0)
+		{
+			break;
+		}
+		// the characters that don't fit in the width are cut off
+		maxChars = pWidget->area.width / charWidth;
+		for(uint16_t character = 0; character < maxChars && pEnd < pWidget->text + pWidget->textLength; character++)
+		{
+			decodeUTF8(&pEnd, pWidget->text + pWidget->textLength);
+		}
+		// the line is centered vertically, the middle rows are drawn when the label is lower than the line
+		if(pWidget->area.height >= lineHeight)
+		{
+			y += (pWidget->area.height - lineHeight) / 2;
+		}
+		else
+		{
+			firstRow = (lineHeight - pWidget->area.height) / 2;
+		}
+		drawTextLinePart(pWidget->area.x, y, pWidget->text, pEnd - pWidget->text, firstRow, pWidget->area.height, pWidget->color, pWidget->backColor);
+		break;
+	case widget_picture:
+		if(pWidget->backColor >> 24)
+		{
+			fillWidgetArea(&pWidget->area, pWidget->backColor);
+		}
+		drawWidgetPicture(pWidget);
+		break;
+	default:
+		break;
+	}
+}
+
+/*!
+ * \brief Draws the picture of a picture widget centered in its area, the part that doesn't fit is cut off. A compressed picture is drawn from the frame cache.
+ *
+ * \param pWidget -> the picture widget
+ *
+ * \retval void
+ */
+static void drawWidgetPicture(const struct widget* pWidget)
+{
+	const struct imageMetaData* pPicture = &pWidget->picture;
+	uint32_t layerWidth = BSP_LCD_GetXSize();
+	uint8_t bitsPerPixel = getRawBitsPerPixel(pPicture->pixelFormat);
+	struct rawDirtyRect source = {.width = pPicture->width, .height = pPicture->height};
+	uint16_t x = pWidget->area.x;
+	uint16_t y = pWidget->area.y;
+	uint32_t* pDst;
+	void* data;
+
+	if(pPicture->data == NULL || pPicture->width == 0 || pPicture->height == 0)
+	{
+		return;
+	}
+	// the middle of a larger picture is shown, a smaller picture is centered
+	if(pPicture->width > pWidget->area.width)
+	{
+		source.x = (pPicture->width - pWidget->area.width) / 2;
+		source.width = pWidget->area.width;
+	}
+	else
+	{
+		x += (pWidget->area.width - pPicture->width) / 2;
+	}
+	if(pPicture->height > pWidget->area.height)
+	{
+		source.y = (pPicture->height - pWidget->area.height) / 2;
+		source.height = pWidget->area.height;
+	}
+	else
+	{
+		y += (pWidget->area.height - pPicture->height) / 2;
+	}
+	// the pixels of a 4 bit format are stored in pairs, so a cut off picture starts and ends at a pair
+	if(bitsPerPixel < 8 && source.width != pPicture->width)
+	{
+		source.x &= ~1u;
+		source.width &= ~1u;
+	}
+	data = getCachedFrame(pPicture);
+	if(data == NULL || source.width == 0)
+	{
+		printf("the picture of widget %s can't be drawn\r\n", pWidget->name);
+		return;
+	}
+	pDst = (uint32_t*)WDA_LCD_GetDrawAddress() + (y * layerWidth) + x;
+	// the DMA2D converts a CLUT format to ARGB8888 with the CLUT of the picture, an A8 or A4 picture gets the color of the widget
+	struct dma2dJob job = {.type = dma2d_blend, .pSrc = (uint8_t*)data + (((uint32_t)source.y * pPicture->width + source.x) * bitsPerPixel) / 8, .srcOffset = pPicture->width - source.width,
+						   .srcFormat = pPicture->pixelFormat, .srcAlpha = 0xFF, .pClut = pPicture->clut, .clutSize = pPicture->clutSize, .pBackground = pDst,
+						   .backgroundOffset = layerWidth - source.width, .backgroundFormat = RAW_FORMAT_ARGB8888, .pDst = pDst, .dstOffset = layerWidth - source.width,
+						   .dstFormat = RAW_FORMAT_ARGB8888, .width = source.width, .height = source.height, .color = pWidget->color};
+
+	addDMA2DJob(&job);
+	// the frame cache doesn't reuse the slot of the picture before it is drawn
+	setFrameCacheJob(data, getLastDMA2DJob());
+}
+
+/*!
+ * \brief Fills an area of the framebuffer the BSP draws in with a color with a DMA2D fill.
+ *
+ * \param pArea -> the area on the LCD
+ * \param color -> ARGB8888 color, LCD_COLOR_TRANSPARENT to make the area transparent
+ *
+ * \retval void
+ */
+static void fillWidgetArea(const struct rawDirtyRect* pArea, uint32_t color)
+{
+	uint32_t layerWidth = BSP_LCD_GetXSize();
+	struct dma2dJob fill = {.type = dma2d_fill, .pDst = (uint32_t*)WDA_LCD_GetDrawAddress() + (pArea->y * layerWidth) + pArea->x, .dstOffset = layerWidth - pArea->width,
+							.dstFormat = RAW_FORMAT_ARGB8888, .width = pArea->width, .height = pArea->height, .color = color};
+
+	addDMA2DJob(&fill);
+}
+
+/*!
+ * \brief Checks if a widget handle belongs to a widget that can be changed.
+ *
+ * \param widget -> handle of the widget
+ *
+ * \retval 1 when it is a widget.
+ * \retval 0 when it isn't.
+ */
+static uint8_t isWidget(uint8_t widget)
+{
+	return (widget < WIDGET_MAX_AMOUNT && widgets[widget].used);
+}
@@ -7,61 +7,406 @@
  *  \author Tijn De Wever
  */
 #include "fileSystemAPI.h"
-static uint8_t validateImage(char* imagePath, uint16_t pathLength);
+static uint8_t getFileKind(char* pPath, uint16_t pathLength);
 static void convExtToLowerCase(char* pOrgPath, uint16_t orgPathLength, char* pModPath, uint16_t modPathSize);
-static void insertImagePath(char* imageList[], uint8_t imageAmount, char* newImage, sortType sortState);
 static uint16_t getPathLength(char* pPath, uint16_t pathLength, pathStopType stopMode);
 static uint8_t extractArgsOutOfPath(char* pPath, uint16_t pathLength, struct imageMetaData* pMetaData);
-static uint8_t imageAmount = 0;
-static uint8_t gifAmount = 0;
-static uint8_t largestNameLength = 0;
+static uint8_t readRawHeader(const struct fsdata_file* pFile, struct imageMetaData* pMetaData);
+static uint8_t checkImageSize(uint16_t width, uint16_t height, uint16_t frameTime, uint8_t pixelFormat, uint8_t compression);
+#if RAW_HEADER_VERIFY_CHECKSUM
+static uint32_t calcRawChecksum(const uint8_t* pData, uint32_t dataSize);
+#endif
+static int compareBase(char* pPathA, uint16_t baseLengthA, char* pPathB, uint16_t baseLengthB);
+static int compareFrames(const void* pA, const void* pB);
+static int compareEntryBase(const void* pA, const void* pB);
+static int compareEntryName(const void* pA, const void* pB);
+static uint16_t findFirstFrame(const struct catalogSnapshot* pCatalog, char* pPath, uint16_t baseLength);
+static uint16_t getFrameNumber(char* pPath, uint16_t pathLength, uint16_t baseLength);
+static uint8_t isFrameOf(const struct imageMetaData* pFrame, char* pPath, uint16_t baseLength);
+static struct catalogEntry* findEntry(struct catalogEntry* pEntries, uint16_t entryAmount, char* pPath, uint16_t baseLength);
+static int compareNamePrefix(const struct catalogEntry* pEntry, char* pPrefix, uint16_t prefixLength);
+static uint16_t findNameBound(const struct catalogEntry* pEntries, uint16_t entryAmount, char* pPrefix, uint16_t prefixLength, uint8_t upperBound);
+static uint8_t buildCatalog(struct catalogSnapshot* pCatalog);
+static uint8_t buildNameIndex(struct catalogSnapshot* pCatalog);
+static uint32_t hashName(char* pName, uint16_t nameLength, fileExtension extType);
+static uint8_t matchName(const struct catalogEntry* pEntry, char* pName, uint16_t nameLength);
+static const struct catalogEntry* getIndexedEntry(const struct catalogSnapshot* pCatalog, uint16_t entryNumber);
+static uint16_t linkCatalog(struct catalogSnapshot* pCatalog);
+static void publishCatalog(struct catalogSnapshot* pNext, const struct catalogSnapshot* pCurrent);
+static void freeCatalog(struct catalogSnapshot* pCatalog);
 extern const struct fsdata_file* const pFirstFile;
+// The image manifest is only present when fsdata_custom.c is generated with makefsdata -img.
+extern const struct imageManifest fsImageManifest __weak;
+
+typedef enum {kind_other, kind_png, kind_gif, kind_raw} fileKind;
+
+// Hash table (open addressing, linear probing) with the lowercase base name of every image and gif as key, built together with the catalog.
+// A slot holds the number of the entry: images are numbered first, gifs follow. NAME_INDEX_EMPTY marks an empty slot.
+#define NAME_INDEX_EMPTY 0xFFFF
+
+/*!
+ * \struct catalogSnapshot
+ * One version of the catalog. Images and gifs are sorted a_z on their name, the frames are sorted on their path without arguments and then on frame number.
+ * Because of this order all frames of one image or gif are stored next to each other.
+ * A snapshot is never changed after it is published, so it can be read from an interrupt without locks.
+ */
+struct catalogSnapshot
+{
+	uint32_t version;
+	volatile uint16_t pinCount;
+	const struct catalogEntry* images;
+	uint16_t imageAmount;
+	const struct catalogEntry* gifs;
+	uint16_t gifAmount;
+	const struct imageMetaData* frames;
+	uint16_t frameAmount;
+	uint8_t largestNameLength;
+	uint16_t* nameIndex;
+	uint16_t nameIndexMask;
+	// Storage of the catalog when it is built at runtime (no image manifest present).
+	struct catalogEntry* runtimeImages;
+	struct catalogEntry* runtimeGifs;
+	struct imageMetaData* runtimeFrames;
+};
+
+// initFileSystemAPI builds the next catalog in the snapshot that is not published and then publishes it with one pointer write.
+// The first snapshot stays empty (version 0) until the first catalog is published, so the API can always be read.
+static struct catalogSnapshot catalogSnapshots[CATALOG_SNAPSHOT_AMOUNT];
+static struct catalogSnapshot* volatile pPublishedCatalog = &catalogSnapshots[0];
 
 
 /*!
  *  \brief This function initializes the file system API. It has to be called before any API functions are used.
+ *  		Every valid image, gif and frame is stored in a sorted catalog, which is used by all the other API functions.
+ *  		When fsdata_custom.c contains an image manifest, it is used as catalog. Otherwise the file system is scanned once to build the catalog.
+ *  		Calling it again rebuilds the catalog while the previous one stays readable, the new catalog is only published when it is complete.
  *
  *  \param void
  *
  *  \retval 1 when the function has succeeded.
- *  \retval 0 when the function has failed. (The path of a file is longer than MAX_PATH_LENGTH)
+ *  \retval 0 when the function has failed. (The path of a file is longer than MAX_PATH_LENGTH, the catalog or name index could not be allocated or the previous catalog is still acquired)
+ *
+ *  \remark Has to be called from thread context (main loop or network callbacks), never from an interrupt.
  */
 uint8_t initFileSystemAPI(void)
 {
-	char* pLastSlash;
-	char pathBuffer[MAX_PATH_LENGTH];
+	struct catalogSnapshot* pCurrent = pPublishedCatalog;
+	struct catalogSnapshot* pNext = (pCurrent == &catalogSnapshots[0])? &catalogSnapshots[1] : &catalogSnapshots[0];
+	uint8_t returnVal = 1;
+	uint8_t allocated = 1;
+
+	// The snapshot before the published one is reused. This is only possible when nobody has acquired it anymore.
+	if(pNext->pinCount != 0)
+	{
+		return 0;
+	}
+	freeCatalog(pNext);
+
+	// The manifest was parsed and sorted by makefsdata, so it can be used directly without any string parsing.
+	if(&fsImageManifest != NULL)
+	{
+		pNext->images = fsImageManifest.images;
+		pNext->imageAmount = fsImageManifest.imageAmount;
+		pNext->gifs = fsImageManifest.gifs;
+		pNext->gifAmount = fsImageManifest.gifAmount;
+		pNext->frames = fsImageManifest.frames;
+		pNext->frameAmount = fsImageManifest.frameAmount;
+		pNext->largestNameLength = fsImageManifest.largestNameLength;
+	}
+	else
+	{
+		returnVal = buildCatalog(pNext);
+		allocated = (pNext->runtimeFrames != NULL)? 1 : 0;
+	}
+
+	// A catalog that could not be allocated is not published, the previous catalog stays in use.
+	if(allocated == 0 || buildNameIndex(pNext) == 0)
+	{
+		freeCatalog(pNext);
+		return 0;
+	}
+	publishCatalog(pNext, pCurrent);
+	return returnVal;
+}
+
+
+/*!
+ *  \brief This function publishes a completely built catalog, so every API function (and interrupt) uses it from now on.
+ *
+ *  \param pNext -> a pointer to the catalog that has to be published.
+ *  \param pCurrent -> a pointer to the catalog that is published now.
+ *
+ *  \return void
+ *
+ *  \remark A pointer write is atomic on the Cortex-M7, so a reader always sees either the complete old or the complete new catalog.
+ */
+static void publishCatalog(struct catalogSnapshot* pNext, const struct catalogSnapshot* pCurrent)
+{
+	pNext->version = pCurrent->version + 1;
+	// All writes to the new catalog have to be finished before its pointer becomes visible.
+	__DMB();
+	pPublishedCatalog = pNext;
+}
+
+
+/*!
+ *  \brief This function acquires the published catalog. An acquired catalog is not freed by initFileSystemAPI, so the frames retrieved from it stay valid while it is used.
+ *
+ *  \param void
+ *
+ *  \return A pointer to the acquired catalog. It has to be released with releaseCatalog.
+ *
+ *  \remark Only one catalog version can be rebuilt while another one is acquired. Release the old catalog as soon as getCatalogVersion changes.
+ *  \remark Has to be called from thread context, never from an interrupt.
+ */
+struct catalogSnapshot* acquireCatalog(void)
+{
+	struct catalogSnapshot* pCatalog = pPublishedCatalog;
+
+	pCatalog->pinCount++;
+	return pCatalog;
+}
+
+
+/*!
+ *  \brief This function releases a catalog that was acquired with acquireCatalog.
+ *
+ *  \param pCatalog -> a pointer to the acquired catalog. NULL is ignored.
+ *
+ *  \return void
+ */
+void releaseCatalog(struct catalogSnapshot* pCatalog)
+{
+	if(pCatalog != NULL && pCatalog->pinCount > 0)
+	{
+		pCatalog->pinCount--;
+	}
+}
+
+
+/*!
+ *  \brief This function returns the version of the published catalog. The version is increased every time initFileSystemAPI publishes a new catalog.
+ *
+ *  \param void
+ *
+ *  \return The version of the published catalog. 0 when no catalog is published yet.
+ */
+uint32_t getCatalogVersion(void)
+{
+	return pPublishedCatalog->version;
+}
+
+
+/*!
+ *  \brief This function builds the catalog at runtime by scanning the file system.
+ *
+ *  \param pCatalog -> a pointer to the (empty) catalog that has to be built.
+ *
+ *  \retval 1 when the function has succeeded.
+ *  \retval 0 when the function has failed. (The path of a file is longer than MAX_PATH_LENGTH or the catalog could not be allocated)
+ */
+static uint8_t buildCatalog(struct catalogSnapshot* pCatalog)
+{
+	uint16_t pngCnt = 0;
+	uint16_t gifCnt = 0;
+	uint16_t rawCnt = 0;
+	uint16_t pathLength;
+	uint8_t kind;
 	uint8_t returnVal = 1;
+	struct catalogEntry* pEntry;
 
+	// The first pass counts the candidates, so the catalog can be allocated in one go.
 	for(struct fsdata_file* f = (struct fsdata_file*)pFirstFile; f != NULL; f = (struct fsdata_file*)f->next)
 	{
 		// Check if the length of the full file path is smaller than MAX_PATH_LENGTH. When >= -> ERROR.
 		returnVal = (strlen((const char*)f->name) + 1 >= MAX_PATH_LENGTH)? 0 : returnVal;
-		// This if statement is used to check if the file f is a valid image.
-		if(validateImage((char*)f->name, strlen((const char*)f->name)) != 0x00)
+		kind = getFileKind((char*)f->name, strlen((const char*)f->name));
+		pngCnt += (kind == kind_png)? 1 : 0;
+		gifCnt += (kind == kind_gif)? 1 : 0;
+		rawCnt += (kind == kind_raw)? 1 : 0;
+	}
+
+	pCatalog->runtimeImages = (struct catalogEntry*)malloc((pngCnt + 1) * sizeof(struct catalogEntry));
+	pCatalog->runtimeGifs = (struct catalogEntry*)malloc((gifCnt + 1) * sizeof(struct catalogEntry));
+	pCatalog->runtimeFrames = (struct imageMetaData*)malloc((rawCnt + 1) * sizeof(struct imageMetaData));
+	if(pCatalog->runtimeImages == NULL || pCatalog->runtimeGifs == NULL || pCatalog->runtimeFrames == NULL)
+	{
+		freeCatalog(pCatalog);
+		return 0;
+	}
+
+	// The second pass fills the catalog. Only .raw files with a valid header or valid arguments are stored as frame.
+	for(struct fsdata_file* f = (struct fsdata_file*)pFirstFile; f != NULL; f = (struct fsdata_file*)f->next)
+	{
+		pathLength = strlen((const char*)f->name);
+		kind = getFileKind((char*)f->name, pathLength);
+		if(kind == kind_raw && readRawHeader(f, &pCatalog->runtimeFrames[pCatalog->frameAmount]) == 1)
+		{
+			pCatalog->runtimeFrames[pCatalog->frameAmount].name = (char*)f->name;
+			pCatalog->frameAmount++;
+		}
+		// A .raw file without header uses the arguments in its name, its data is always ARGB1555.
+		else if(kind == kind_raw && extractArgsOutOfPath((char*)f->name, pathLength, &pCatalog->runtimeFrames[pCatalog->frameAmount]) == 1)
 		{
+			pCatalog->runtimeFrames[pCatalog->frameAmount].name = (char*)f->name;
+			pCatalog->runtimeFrames[pCatalog->frameAmount].data = (void*)f->data;
+			pCatalog->runtimeFrames[pCatalog->frameAmount].pixelFormat = RAW_FORMAT_ARGB1555;
+			pCatalog->runtimeFrames[pCatalog->frameAmount].compression = RAW_COMPRESSION_NONE;
+			pCatalog->runtimeFrames[pCatalog->frameAmount].dataSize = f->len;
+			pCatalog->runtimeFrames[pCatalog->frameAmount].clut = NULL;
+			pCatalog->runtimeFrames[pCatalog->frameAmount].clutSize = 0;
+			pCatalog->runtimeFrames[pCatalog->frameAmount].dirty = (struct rawDirtyRect){.x = 0, .y = 0, .width = pCatalog->runtimeFrames[pCatalog->frameAmount].width, .height = pCatalog->runtimeFrames[pCatalog->frameAmount].height};
+			pCatalog->frameAmount++;
+		}
+		else if(kind == kind_png || kind == kind_gif)
+		{
+			pEntry = (kind == kind_png)? &pCatalog->runtimeImages[pCatalog->imageAmount++] : &pCatalog->runtimeGifs[pCatalog->gifAmount++];
+			pEntry->path = (char*)f->name;
 			// The last '/' is searched in order to get the name + extension out of the path.
-			pLastSlash = strrchr((const char*)f->name, '/');
-			// When no '/' has been found -> pLastSlash = start address of the file path.
-			pLastSlash = (pLastSlash == NULL)? (char*)f->name : pLastSlash + 1;
+			pEntry->nameOffset = (strrchr((const char*)f->name, '/') == NULL)? 0 : strrchr((const char*)f->name, '/') - (const char*)f->name + 1;
+			pEntry->baseLength = getPathLength((char*)f->name, pathLength, stop_at_any);
+			pEntry->firstFrame = 0;
+			pEntry->frameAmount = 0;
+		}
+	}
+
+	// The frames are sorted on path and frame number, the images and gifs on path so the frames can be linked to them.
+	qsort(pCatalog->runtimeFrames, pCatalog->frameAmount, sizeof(struct imageMetaData), compareFrames);
+	qsort(pCatalog->runtimeImages, pCatalog->imageAmount, sizeof(struct catalogEntry), compareEntryBase);
+	qsort(pCatalog->runtimeGifs, pCatalog->gifAmount, sizeof(struct catalogEntry), compareEntryBase);
+	pCatalog->frameAmount = linkCatalog(pCatalog);
+
+	// Images and gifs without frames are invalid and are removed from the catalog.
+	pngCnt = 0;
+	for(uint16_t index = 0; index < pCatalog->imageAmount; index++)
+	{
+		pCatalog->runtimeImages[pngCnt] = pCatalog->runtimeImages[index];
+		pngCnt += (pCatalog->runtimeImages[index].frameAmount != 0)? 1 : 0;
+	}
+	pCatalog->imageAmount = pngCnt;
+	gifCnt = 0;
+	for(uint16_t index = 0; index < pCatalog->gifAmount; index++)
+	{
+		pCatalog->runtimeGifs[gifCnt] = pCatalog->runtimeGifs[index];
+		gifCnt += (pCatalog->runtimeGifs[index].frameAmount != 0)? 1 : 0;
+	}
+	pCatalog->gifAmount = gifCnt;
+
+	// The length of every name is compared with largestNameLength so that largestNameLength can be updated when necessary.
+	for(uint16_t index = 0; index < pCatalog->imageAmount; index++)
+	{
+		pCatalog->largestNameLength = ((strlen(pCatalog->runtimeImages[index].path + pCatalog->runtimeImages[index].nameOffset) + 1) > pCatalog->largestNameLength)? (strlen(pCatalog->runtimeImages[index].path + pCatalog->runtimeImages[index].nameOffset) + 1) : pCatalog->largestNameLength;
+	}
+	for(uint16_t index = 0; index < pCatalog->gifAmount; index++)
+	{
+		pCatalog->largestNameLength = ((strlen(pCatalog->runtimeGifs[index].path + pCatalog->runtimeGifs[index].nameOffset) + 1) > pCatalog->largestNameLength)? (strlen(pCatalog->runtimeGifs[index].path + pCatalog->runtimeGifs[index].nameOffset) + 1) : pCatalog->largestNameLength;
+	}
+	for(uint16_t index = 0; index < pCatalog->frameAmount; index++)
+	{
+		char* pLastSlash = strrchr(pCatalog->runtimeFrames[index].name, '/');
+		pLastSlash = (pLastSlash == NULL)? pCatalog->runtimeFrames[index].name : pLastSlash + 1;
+		pCatalog->largestNameLength = ((strlen(pLastSlash) + 1) > pCatalog->largestNameLength)? (strlen(pLastSlash) + 1) : pCatalog->largestNameLength;
+	}
+
+	// Finally the images and gifs are sorted a_z, so getImageList only has to copy the catalog.
+	qsort(pCatalog->runtimeImages, pCatalog->imageAmount, sizeof(struct catalogEntry), compareEntryName);
+	qsort(pCatalog->runtimeGifs, pCatalog->gifAmount, sizeof(struct catalogEntry), compareEntryName);
+	pCatalog->images = pCatalog->runtimeImages;
+	pCatalog->gifs = pCatalog->runtimeGifs;
+	pCatalog->frames = pCatalog->runtimeFrames;
+	return returnVal;
+}
+
+
+/*!
+ *  \brief This function builds the name index of the catalog, so an image or gif can be found by name with one hash lookup.
+ *
+ *  \param pCatalog -> a pointer to the catalog whose name index has to be built.
+ *
+ *  \retval 1 when the function has succeeded.
+ *  \retval 0 when the function has failed. (The name index could not be allocated)
+ *
+ *  \remark When multiple images (or gifs) have the same name, the first one in a_z order is stored.
+ */
+static uint8_t buildNameIndex(struct catalogSnapshot* pCatalog)
+{
+	uint16_t entryAmount = pCatalog->imageAmount + pCatalog->gifAmount;
+	uint32_t indexSize = 4;
+	uint32_t slot;
+	const struct catalogEntry* pEntry;
 
-			// The length of the name is compared with largestNameLength so that largestNameLength can be updated when necessary.
-			largestNameLength = ((strlen(pLastSlash) + 1 ) > largestNameLength)? (strlen(pLastSlash) + 1) : largestNameLength;
+	// The index is kept at most half full, so a lookup almost always needs only one probe.
+	while(indexSize < 2 * (uint32_t)entryAmount)
+	{
+		indexSize <<= 1;
+	}
+	pCatalog->nameIndex = (uint16_t*)malloc(indexSize * sizeof(uint16_t));
+	if(pCatalog->nameIndex == NULL)
+	{
+		return 0;
+	}
+	memset(pCatalog->nameIndex, 0xFF, indexSize * sizeof(uint16_t));
+	pCatalog->nameIndexMask = indexSize - 1;
 
-			// convExtToLowerCase is called to convert the extension of the file f to lowercase. This way it doesn't matter whether the extension is e.g a .RAW or .raw .
-			convExtToLowerCase((char*)f->name, strlen((const char*)f->name), pathBuffer, sizeof(pathBuffer));
-			// This if statement is used to check whether the file f is an image or not.
-			if(strstr(pathBuffer, ".png") != NULL)
+	for(uint16_t entryNumber = 0; entryNumber < entryAmount; entryNumber++)
+	{
+		pEntry = getIndexedEntry(pCatalog, entryNumber);
+		if(pEntry->baseLength > pEntry->nameOffset)
+		{
+			slot = hashName(pEntry->path + pEntry->nameOffset, pEntry->baseLength - pEntry->nameOffset, (entryNumber < pCatalog->imageAmount)? png : gif) & pCatalog->nameIndexMask;
+			while(pCatalog->nameIndex[slot] != NAME_INDEX_EMPTY && !(matchName(getIndexedEntry(pCatalog, pCatalog->nameIndex[slot]), pEntry->path + pEntry->nameOffset, pEntry->baseLength - pEntry->nameOffset) && (pCatalog->nameIndex[slot] < pCatalog->imageAmount) == (entryNumber < pCatalog->imageAmount)))
 			{
-				imageAmount++;
+				slot = (slot + 1) & pCatalog->nameIndexMask;
 			}
-			// This if statement is used to check whether the file f is a gif or not.
-			if(strstr(pathBuffer, ".gif") != NULL)
+			pCatalog->nameIndex[slot] = (pCatalog->nameIndex[slot] == NAME_INDEX_EMPTY)? entryNumber : pCatalog->nameIndex[slot];
+		}
+	}
+	return 1;
+}
+
+
+/*!
+ *  \brief This function searches an image or gif by its name with the name index and retrieves the meta data of its (first) frame.
+ *  	   E.g: "cat", "Cat.gif" and "/gifs/cat/cat.gif" all find the gif named cat.
+ *
+ *  \param pName -> a pointer to the name of the image or gif. The name is case insensitive, a folder, arguments and extension are ignored.
+ *  \param nameLength -> the length of the name. (Length of the string without \0)
+ *  \param extType -> specifies if an image (png) or gif has to be found.
+ *  \param pMetaData -> a pointer to the location where the meta data will be stored.
+ *
+ *  \retval 0x01 if the image or gif has been found.
+ *  \retval 0x00 if no image or gif with this name exists.
+ */
+uint8_t findImageByName(char* pName, uint16_t nameLength, fileExtension extType, struct imageMetaData* pMetaData)
+{
+	const struct catalogSnapshot* pCatalog = pPublishedCatalog;
+	char* pLastSlash = (char*)memrchr(pName, '/', nameLength);
+	uint32_t slot;
+	uint16_t entryNumber;
+	uint8_t retVal = 0;
+
+	// The folder is cut off the front and the arguments or extension off the back, so only the base name is hashed.
+	if(pLastSlash != NULL)
+	{
+		nameLength -= pLastSlash + 1 - pName;
+		pName = pLastSlash + 1;
+	}
+	nameLength = getPathLength(pName, nameLength, stop_at_any);
+
+	if(pCatalog->nameIndex != NULL && nameLength > 0 && (extType == png || extType == gif))
+	{
+		slot = hashName(pName, nameLength, extType) & pCatalog->nameIndexMask;
+		while(retVal == 0 && (entryNumber = pCatalog->nameIndex[slot]) != NAME_INDEX_EMPTY)
+		{
+			if((entryNumber < pCatalog->imageAmount) == (extType == png) && matchName(getIndexedEntry(pCatalog, entryNumber), pName, nameLength))
 			{
-				gifAmount++;
+				*pMetaData = pCatalog->frames[getIndexedEntry(pCatalog, entryNumber)->firstFrame];
+				retVal = 1;
 			}
+			slot = (slot + 1) & pCatalog->nameIndexMask;
 		}
 	}
-	return returnVal;
+	return retVal;
 }
 
 
@@ -72,9 +417,11 @@ uint8_t initFileSystemAPI(void)
  *
  *  \return Amount of valid images that are present in the file system.
  */
-uint8_t getImageAmount(void)
+uint16_t getImageAmount(void)
 {
-	return imageAmount;
+	const struct catalogSnapshot* pCatalog = pPublishedCatalog;
+
+	return pCatalog->imageAmount;
 }
 
 /*!
@@ -84,9 +431,11 @@ uint8_t getImageAmount(void)
  *
  *  \return Amount of gifs images that are present in the file system.
  */
-uint8_t getGifAmount(void)
+uint16_t getGifAmount(void)
 {
-	return gifAmount;
+	const struct catalogSnapshot* pCatalog = pPublishedCatalog;
+
+	return pCatalog->gifAmount;
 }
 
 /*!
@@ -98,7 +447,9 @@ uint8_t getGifAmount(void)
  */
 uint8_t getLargestNameLength(void)
 {
-	return largestNameLength;
+	const struct catalogSnapshot* pCatalog = pPublishedCatalog;
+
+	return pCatalog->largestNameLength;
 }
 
 
@@ -119,6 +470,7 @@ uint8_t getLargestNameLength(void)
  */
 void extractNameOutOfPath(char* pPath, uint16_t pathLength, char* pName, extensionType nameState, caseType caseState)
 {
+	const struct catalogSnapshot* pCatalog = pPublishedCatalog;
 	// This function searches for the first '/' and last '.' character. With these results can the name be cut out of the path.
 
 	// memrchr and memchr are used because it is uncertain that the path string contains a \0.
@@ -132,7 +484,7 @@ void extractNameOutOfPath(char* pPath, uint16_t pathLength, char* pName, extensi
 
 	// If there is no '.' found -> pDot = start address of the path string + pathLength as offset.
 	pDot = (pDot == NULL)? pPath + pathLength : pDot;
-	memset(pName, '\0', largestNameLength);
+	memset(pName, '\0', pCatalog->largestNameLength);
 	strncpy(pName, pLastSlash, endOfName - pLastSlash);
 	if(nameState == ext)
 	{
@@ -164,28 +516,115 @@ void extractNameOutOfPath(char* pPath, uint16_t pathLength, char* pName, extensi
  *  \return This amount will be 0 if an error has occurred or no valid images were found.
  *
  *  \warning The array size HAS to be equal to imageAmount or gifAmount (which can be acquired through getImageAmount and getGifAmount) depending on extType.
+ *  \remark The catalog is already sorted a_z, no_sort returns the same order. Use an imageCursor to read the list page by page with a fixed size array.
  */
-uint8_t getImageList(char* imageList[], fileExtension extType, sortType sortState)
+uint16_t getImageList(char* imageList[], fileExtension extType, sortType sortState)
 {
-	uint8_t imageCnt = 0;
-	char pathBuffer[MAX_PATH_LENGTH];
+	const struct catalogSnapshot* pCatalog = pPublishedCatalog;
+	struct imageCursor cursor;
+	uint16_t imageCnt = 0;
 
 	if(extType == png || extType == gif)
 	{
-		for(struct fsdata_file* f = (struct fsdata_file*)pFirstFile; f != NULL; f = (struct fsdata_file*)f->next)
-		{
-			// validateImage is called to check if the file f is valid.
-			if(validateImage((char*)f->name, strlen((const char*)f->name)) != 0x00)
-			{
-				// convExtToLowerCase is called to convert the extension of the file f to lowercase. This way it doesn't matter whether the extension is e.g a .GIF or .gif .
-				convExtToLowerCase((char*)f->name, strlen((const char*)f->name), pathBuffer, sizeof(pathBuffer));
-				if((extType == png && strstr(pathBuffer, ".png") != NULL) || (extType == gif && strstr(pathBuffer, ".gif") != NULL))
-				{
-					insertImagePath(imageList, imageCnt, (char*)f->name, sortState);
-					imageCnt++;
-				}
-			}
-		}
+		openImageCursor(&cursor, extType, sortState, NULL, 0);
+		imageCnt = getImagePage(&cursor, imageList, (extType == png)? pCatalog->imageAmount : pCatalog->gifAmount);
+	}
+	return imageCnt;
+}
+
+
+/*!
+ *  \brief This function opens a cursor over the images or gifs in the catalog. Optionally only the names that start with pPrefix are selected.
+ *
+ *  \param pCursor -> a pointer to the cursor that has to be opened.
+ *  \param extType -> specifies the desired file type (png or gif).
+ *  \param sortState -> specifies the desired output order (a_z, z_a, no_sort)
+ *  \param pPrefix -> a pointer to the prefix the names have to start with (case insensitive, without folder). NULL selects every name.
+ *  \param prefixLength -> the length of the prefix. (Length of the string without \0)
+ *
+ *  \return The amount of images or gifs the cursor will return.
+ *
+ *  \remark The catalog is sorted a_z on the lowercase name, so the names with the same prefix are stored next to each other. They are found with a binary search.
+ */
+uint16_t openImageCursor(struct imageCursor* pCursor, fileExtension extType, sortType sortState, char* pPrefix, uint16_t prefixLength)
+{
+	const struct catalogSnapshot* pCatalog = pPublishedCatalog;
+
+	pCursor->pEntries = (extType == png)? pCatalog->images : pCatalog->gifs;
+	pCursor->firstIndex = 0;
+	pCursor->endIndex = (extType == png)? pCatalog->imageAmount : pCatalog->gifAmount;
+	pCursor->position = 0;
+	pCursor->sortState = sortState;
+	if(extType != png && extType != gif)
+	{
+		pCursor->endIndex = 0;
+	}
+	else if(pPrefix != NULL && prefixLength > 0)
+	{
+		pCursor->firstIndex = findNameBound(pCursor->pEntries, pCursor->endIndex, pPrefix, prefixLength, 0);
+		pCursor->endIndex = findNameBound(pCursor->pEntries, pCursor->endIndex, pPrefix, prefixLength, 1);
+	}
+	return pCursor->endIndex - pCursor->firstIndex;
+}
+
+
+/*!
+ *  \brief This function moves the cursor to the specified offset, so the next image that is returned is the (offset + 1)th one.
+ *
+ *  \param pCursor -> a pointer to an opened cursor.
+ *  \param offset -> the amount of images that have to be skipped from the start of the selection.
+ *
+ *  \return void
+ *
+ *  \remark An offset past the end of the selection moves the cursor to the end.
+ */
+void seekImageCursor(struct imageCursor* pCursor, uint16_t offset)
+{
+	pCursor->position = (offset < pCursor->endIndex - pCursor->firstIndex)? offset : pCursor->endIndex - pCursor->firstIndex;
+}
+
+
+/*!
+ *  \brief This function returns the file path of the next image of the cursor.
+ *
+ *  \param pCursor -> a pointer to an opened cursor.
+ *
+ *  \return A pointer to the file path of the image.
+ *  \return NULL when the end of the selection is reached.
+ */
+char* getNextImage(struct imageCursor* pCursor)
+{
+	char* pPath = NULL;
+
+	if(pCursor->position < pCursor->endIndex - pCursor->firstIndex)
+	{
+		// z_a is the a_z catalog read from back to front.
+		pPath = (pCursor->sortState == z_a)? pCursor->pEntries[pCursor->endIndex - 1 - pCursor->position].path : pCursor->pEntries[pCursor->firstIndex + pCursor->position].path;
+		pCursor->position++;
+	}
+	return pPath;
+}
+
+
+/*!
+ *  \brief This function reads the next page of file paths from the cursor.
+ *
+ *  \param pCursor -> a pointer to an opened cursor.
+ *  \param imageList -> an array where the page will be stored (array of char pointers).
+ *  \param limit -> the maximum amount of file paths that are read. (Size of imageList)
+ *
+ *  \return The amount of file paths present in the page.
+ *  \return This amount will be 0 when the end of the selection is reached.
+ */
+uint16_t getImagePage(struct imageCursor* pCursor, char* imageList[], uint16_t limit)
+{
+	uint16_t imageCnt = 0;
+	char* pPath;
+
+	while(imageCnt < limit && (pPath = getNextImage(pCursor)) != NULL)
+	{
+		*(imageList + imageCnt) = pPath;
+		imageCnt++;
 	}
 	return imageCnt;
 }
@@ -202,145 +641,613 @@ uint8_t getImageList(char* imageList[], fileExtension extType, sortType sortStat
  *  \return This amount will be 0 if an error has occurred or no valid gifs were found.
  *
  *  \remark Regardless of the extension type (or no extension) of pGifPath, the generated list will be for the corresponding .gif file.
- *  \warning The array size HAS to be equal to MAX_GIF_FRAMES.
+ *  \warning The array size HAS to be equal to MAX_GIF_FRAMES. Only the first MAX_GIF_FRAMES frames are listed, use getGifFrameData for longer gifs.
  */
-uint8_t getGifFrames(char* pGifPath, uint16_t pathLength, char* frameList[])
+uint16_t getGifFrames(char* pGifPath, uint16_t pathLength, char* frameList[])
 {
-	uint8_t frameCnt = 0;
-	uint16_t lengthUntilArgsOrExt;
-	char pathBuffer[MAX_PATH_LENGTH];
-	// validateImage is called to check if the specified image is valid.
-	if(validateImage(pGifPath, pathLength) != 0x00)
+	const struct imageMetaData* pFrames;
+	uint16_t frameAmount = getGifFrameData(pGifPath, pathLength, &pFrames);
+	uint16_t frameCnt = (frameAmount > MAX_GIF_FRAMES)? MAX_GIF_FRAMES : frameAmount;
+
+	for(uint16_t index = 0; index < frameCnt; index++)
+	{
+		*(frameList + index) = pFrames[index].name;
+	}
+	return frameCnt;
+}
+
+
+/*!
+ *  \brief This function retrieves the resolved meta data (data pointer, width, height, frame time) of all the frames of the specified gif.
+ *
+ *  \param pGifPath -> a pointer to the path of the gif, whose frames have to be retrieved.
+ *  \param pathLength -> the length of the path. (Length of the string without \0)
+ *	\param pFrames -> a pointer to the location where a pointer to the first frame will be stored. The frames are stored next to each other, sorted on frame number.
+ *
+ *  \return The amount of frames retrieved.
+ *  \return This amount will be 0 if an error has occurred or no valid gifs were found.
+ *
+ *  \remark The frames point into the published catalog. Acquire it first with acquireCatalog to keep the frames valid after initFileSystemAPI rebuilds the catalog. Indexing them is O(1), which makes them usable in an interrupt.
+ *  \remark Unlike getGifFrames, the amount of frames is not limited to MAX_GIF_FRAMES.
+ */
+uint16_t getGifFrameData(char* pGifPath, uint16_t pathLength, const struct imageMetaData** pFrames)
+{
+	const struct catalogSnapshot* pCatalog = pPublishedCatalog;
+	uint16_t frameCnt = 0;
+	// getPathLength is called to get the length of the path without arguments or the extension.
+	uint16_t lengthUntilArgsOrExt = getPathLength(pGifPath, pathLength, stop_at_any);
+	uint16_t frameIndex = findFirstFrame(pCatalog, pGifPath, lengthUntilArgsOrExt);
+
+	*pFrames = &pCatalog->frames[frameIndex];
+	// The frames of one gif are stored next to each other in the catalog, sorted on frame number.
+	while(frameIndex < pCatalog->frameAmount && compareBase(pCatalog->frames[frameIndex].name, getPathLength(pCatalog->frames[frameIndex].name, strlen(pCatalog->frames[frameIndex].name), stop_at_any), pGifPath, lengthUntilArgsOrExt) == 0)
 	{
-		// getPathLength is called to get the length of the path without arguments or the extension.
-		lengthUntilArgsOrExt = getPathLength(pGifPath, pathLength, stop_at_any);
+		frameCnt++;
+		frameIndex++;
+	}
+	return frameCnt;
+}
+
+
+/*!
+ *  \brief This function can be used to get the meta data of the specified raw image.
+ *
+ *  \param imagePath -> specifies from which image the data has to be retrieved.
+ *  \param pathLength -> the length of the image path. (Length of the string without \0)
+ *  \param pMetaData -> a pointer to the location where the meta data will be stored.
+ *
+ *  \retval 0x01 if the meta data has successfully been retrieved.
+ *  \retval 0x00 if an error occurred.
+ *
+ *  \remark Regardless of the extension type (or no extension) of imagePath, the retrieved meta data will be from the corresponding .raw file.
+ */
+uint8_t getRawImageMetaData(char* imagePath, uint16_t pathLength, struct imageMetaData* pMetaData)
+{
+	const struct catalogSnapshot* pCatalog = pPublishedCatalog;
+	// The first frame of the specified image is looked up in the catalog. When imagePath does not have a frame number -> .raw file with num 1 is chosen.
+	uint16_t lengthUntilArgsOrExt = getPathLength(imagePath, pathLength, stop_at_any);
+	uint16_t firstFrame = findFirstFrame(pCatalog, imagePath, lengthUntilArgsOrExt);
+	uint16_t num = getFrameNumber(imagePath, pathLength, lengthUntilArgsOrExt);
+	// The frames of one image are numbered 1, 2, 3, ... and sorted on frame number, so the frame is indexed directly.
+	uint32_t frameIndex = (uint32_t)firstFrame + num - 1;
+	uint32_t low = firstFrame;
+	uint32_t high;
+	uint32_t middle;
 
-		// This loop is used to check every file in the fs.
-		for(struct fsdata_file* f = (struct fsdata_file*)pFirstFile; f != NULL; f = (struct fsdata_file*)f->next)
+	pMetaData->num = num;
+	if(num == 0)
+	{
+		return 0;
+	}
+	if(frameIndex < pCatalog->frameAmount && pCatalog->frames[frameIndex].num == num && isFrameOf(&pCatalog->frames[frameIndex], imagePath, lengthUntilArgsOrExt))
+	{
+		*pMetaData = pCatalog->frames[frameIndex];
+		return 1;
+	}
+	// When frame numbers are skipped the frame is stored before that index. The frames of the image come first in that range, sorted on frame number,
+	// so a binary search treats the frames of the next images as larger.
+	high = (frameIndex < pCatalog->frameAmount)? frameIndex : pCatalog->frameAmount;
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		if(pCatalog->frames[middle].num < num && isFrameOf(&pCatalog->frames[middle], imagePath, lengthUntilArgsOrExt))
 		{
-			// convExtToLowerCase is called to convert the extension of the file f to lowercase. This way it doesn't matter whether the extension is e.g a .RAW or .raw .
-			convExtToLowerCase((char*)f->name, strlen((const char*)f->name), pathBuffer, sizeof(pathBuffer));
-			if(strncmp(pathBuffer, pGifPath, lengthUntilArgsOrExt) == 0 && strstr(pathBuffer, ".raw") != NULL)
-			{
-				insertImagePath(frameList, frameCnt, (char*)f->name, a_z);
-				frameCnt++;
-			}
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
 		}
 	}
-	return frameCnt;
+	if(low >= pCatalog->frameAmount || pCatalog->frames[low].num != num || isFrameOf(&pCatalog->frames[low], imagePath, lengthUntilArgsOrExt) == 0)
+	{
+		return 0;
+	}
+	*pMetaData = pCatalog->frames[low];
+	return 1;
 }
 
+
 /*!
- *  \brief This function inserts a new image path in imageList at the correct location (place), which can be specified by sortState.
+ *  \brief This function checks if a frame belongs to the specified image or gif.
  *
- *  \param imageList -> a pointer to the array that contains the sorted images and were the new image has to be inserted in
- *  \param imagesInList -> specifies the amount of sorted images present in imageList
- *	\param newImage -> a pointer to the path of the image that has to be inserted in imageList
- *	\param sortState ->specifies the desired sort order (a_z, z_a, no_sort)
+ *  \param pFrame -> a pointer to the frame.
+ *  \param pPath -> a pointer to the path of the image or gif.
+ *  \param baseLength -> the length of the path without arguments or extension.
  *
- *  \return void
+ *  \retval 0x01 when the path of the frame without arguments is the same.
+ *  \retval 0x00 when it isn't.
+ */
+static uint8_t isFrameOf(const struct imageMetaData* pFrame, char* pPath, uint16_t baseLength)
+{
+	return (compareBase(pFrame->name, getPathLength(pFrame->name, strlen(pFrame->name), stop_at_any), pPath, baseLength) == 0)? 1 : 0;
+}
+
+
+/*!
+ *  \brief This function reads the frame number of a path: the digits after the '#' that follows the path without arguments. The other arguments are not parsed.
+ *
+ *  \param pPath -> a pointer to the path.
+ *  \param pathLength -> the length of the path. (Length of the string without \0)
+ *  \param baseLength -> the length of the path without arguments or extension.
+ *
+ *  \return The frame number, 1 when the path has no frame number.
+ *  \return This number will be 0 if the frame number is larger than 65535.
  */
-static void insertImagePath(char* imageList[], uint8_t imagesInList, char* newImagePath, sortType sortState)
+static uint16_t getFrameNumber(char* pPath, uint16_t pathLength, uint16_t baseLength)
 {
-	uint8_t index;
-	uint8_t sortedFlag = 0;
-	char nameBuf[largestNameLength];
-	char newNameBuf[largestNameLength];
-	int8_t compareRes;
-	struct imageMetaData newImageMetaData = {.data = NULL, .name = NULL, .num = 0, .frameTime = 0, .height = 0, .width = 0};
-	struct imageMetaData metaDataBuffer = {.data = NULL, .name = NULL, .num = 0, .frameTime = 0, .height = 0, .width = 0};
+	uint32_t num = 0;
+	uint16_t index = baseLength + 1;
 
-	extractNameOutOfPath(newImagePath, strlen(newImagePath), newNameBuf, ext, lower);
-	// This if statement is used to check if the list has to be sorted + check whether the list is empty and thus cannot be sorted.
-	if(imagesInList == 0 || (sortState != a_z && sortState != z_a))
+	if(baseLength >= pathLength || pPath[baseLength] != '#' || index >= pathLength || pPath[index] < '0' || pPath[index] > '9')
 	{
-		*(imageList + imagesInList) = newImagePath;
+		return 1;
 	}
-	else
+	while(index < pathLength && pPath[index] >= '0' && pPath[index] <= '9' && num <= 0xFFFF)
 	{
-		index = 0;
-		extractArgsOutOfPath(newImagePath, strlen(newImagePath), &newImageMetaData);
-		while(index < imagesInList && sortedFlag == 0)
+		num = num * 10 + (pPath[index] - '0');
+		index++;
+	}
+	return (num <= 0xFFFF)? (uint16_t)num : 0;
+}
+
+
+/*!
+ *  \brief This function links every image and gif in the catalog to its frames and removes the frames that do not belong to an image or gif.
+ *
+ *  \param pCatalog -> a pointer to the catalog that is being built.
+ *
+ *  \return The amount of frames that are left in the catalog.
+ *
+ *  \warning The frames, images and gifs HAVE to be sorted on their path before this function is called.
+ *  \warning Both the .raw and .png or .gif and .raw files NEED to be located in the same folder.
+ */
+static uint16_t linkCatalog(struct catalogSnapshot* pCatalog)
+{
+	uint16_t frameCnt = 0;
+	uint16_t groupStart = 0;
+	uint16_t groupEnd;
+	uint16_t baseLength;
+	struct catalogEntry* pImage;
+	struct catalogEntry* pGif;
+
+	while(groupStart < pCatalog->frameAmount)
+	{
+		// A group contains all the frames with the same path without arguments.
+		baseLength = getPathLength(pCatalog->runtimeFrames[groupStart].name, strlen(pCatalog->runtimeFrames[groupStart].name), stop_at_any);
+		groupEnd = groupStart + 1;
+		while(groupEnd < pCatalog->frameAmount && compareBase(pCatalog->runtimeFrames[groupEnd].name, getPathLength(pCatalog->runtimeFrames[groupEnd].name, strlen(pCatalog->runtimeFrames[groupEnd].name), stop_at_any), pCatalog->runtimeFrames[groupStart].name, baseLength) == 0)
 		{
-			extractNameOutOfPath(*(imageList + index), strlen(*(imageList + index)), nameBuf, ext, lower);
-			compareRes = strcmp(newNameBuf, nameBuf);
-			extractArgsOutOfPath(*(imageList + index), strlen(*(imageList + index)), &metaDataBuffer);
+			groupEnd++;
+		}
 
-			// This if statement is used to check if both names match. If so, the frame number is compared and compareRes is changed if necessary.
-			// This is done so the frames of a gif align correct and not 1, 10, 2, 3. compareRes is not changed if the files have no arguments.
-			if(compareRes == 0)
-			{
-				compareRes = (newImageMetaData.num < metaDataBuffer.num)? -1 : compareRes;
-				compareRes = (newImageMetaData.num > metaDataBuffer.num)? 1 : compareRes;
-			}
-			if((sortState == a_z && compareRes <= 0) || (sortState == z_a && compareRes >= 0))
+		pImage = findEntry(pCatalog->runtimeImages, pCatalog->imageAmount, pCatalog->runtimeFrames[groupStart].name, baseLength);
+		pGif = findEntry(pCatalog->runtimeGifs, pCatalog->gifAmount, pCatalog->runtimeFrames[groupStart].name, baseLength);
+		// Only a group with a matching .png or .gif file is kept. The group is moved to the front so the frame table has no gaps.
+		if(pImage != NULL || pGif != NULL)
+		{
+			memmove(&pCatalog->runtimeFrames[frameCnt], &pCatalog->runtimeFrames[groupStart], (groupEnd - groupStart) * sizeof(struct imageMetaData));
+			if(pImage != NULL)
 			{
-				// This for loop is used to shift every image path from [index] -> [end of the list] one index to the right.
-				for(uint8_t copyIndex = imagesInList; copyIndex > index; copyIndex--)
-				{
-					*(imageList + copyIndex) = *(imageList + copyIndex - 1);
-				}
-				*(imageList + index) = newImagePath;
-				sortedFlag = 1;
+				pImage->firstFrame = frameCnt;
+				pImage->frameAmount = groupEnd - groupStart;
 			}
-			// This if statement is used to check if the end of the list - 1 has been reached. If so -> insert new image path at the back.
-			else if(((sortState == a_z && compareRes > 0) || (sortState == z_a && compareRes < 0)) && index == imagesInList - 1)
+			if(pGif != NULL)
 			{
-				*(imageList + imagesInList) = newImagePath;
-				sortedFlag = 1;
+				pGif->firstFrame = frameCnt;
+				pGif->frameAmount = groupEnd - groupStart;
 			}
-			index++;
+			frameCnt += groupEnd - groupStart;
 		}
+		groupStart = groupEnd;
 	}
+	return frameCnt;
+}
+
 
+/*!
+ *  \brief This function searches the index of the first frame of the specified image or gif with a binary search.
+ *
+ *  \param pCatalog -> a pointer to the catalog that is searched.
+ *  \param pPath -> a pointer to the path of the image or gif.
+ *  \param baseLength -> the length of the path without arguments or extension.
+ *
+ *  \return The index of the first frame whose path is equal to or larger than pPath.
+ *  \return This index will be the amount of frames if no such frame exists.
+ */
+static uint16_t findFirstFrame(const struct catalogSnapshot* pCatalog, char* pPath, uint16_t baseLength)
+{
+	uint16_t low = 0;
+	uint16_t high = pCatalog->frameAmount;
+	uint16_t middle;
+
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		if(compareBase(pCatalog->frames[middle].name, getPathLength(pCatalog->frames[middle].name, strlen(pCatalog->frames[middle].name), stop_at_any), pPath, baseLength) < 0)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low;
 }
 
 
 /*!
- *  \brief This function can be used to get the meta data of the specified raw image.
+ *  \brief This function searches the specified image or gif in a list of catalog entries sorted on path with a binary search.
  *
- *  \param imagePath -> specifies from which image the data has to be retrieved.
- *  \param pathLength -> the length of the image path. (Length of the string without \0)
- *  \param pMetaData -> a pointer to the location where the meta data will be stored.
+ *  \param pEntries -> a pointer to the catalog entries.
+ *  \param entryAmount -> the amount of entries.
+ *  \param pPath -> a pointer to the path that has to be found.
+ *  \param baseLength -> the length of the path without arguments or extension.
  *
- *  \retval 0x01 if the meta data has successfully been retrieved.
- *  \retval 0x00 if an error occurred.
+ *  \return A pointer to the found entry or NULL when the entry doesn't exist.
+ */
+static struct catalogEntry* findEntry(struct catalogEntry* pEntries, uint16_t entryAmount, char* pPath, uint16_t baseLength)
+{
+	uint16_t low = 0;
+	uint16_t high = entryAmount;
+	uint16_t middle;
+	int compareRes;
+
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		compareRes = compareBase(pEntries[middle].path, pEntries[middle].baseLength, pPath, baseLength);
+		if(compareRes == 0)
+		{
+			return &pEntries[middle];
+		}
+		else if(compareRes < 0)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return NULL;
+}
+
+
+/*!
+ *  \brief This function searches the first entry whose name starts with (lower bound) or comes after (upper bound) the specified prefix with a binary search.
  *
- *  \remark Regardless of the extension type (or no extension) of imagePath, the retrieved meta data will be from the corresponding .raw file.
+ *  \param pEntries -> a pointer to the catalog entries, sorted a_z on their lowercase name.
+ *  \param entryAmount -> the amount of entries.
+ *  \param pPrefix -> a pointer to the prefix.
+ *  \param prefixLength -> the length of the prefix. (Length of the string without \0)
+ *  \param upperBound -> 0 to search the first matching entry, 1 to search the first entry after the matching entries.
+ *
+ *  \return The index of the found entry or entryAmount when no such entry exists.
  */
-uint8_t getRawImageMetaData(char* imagePath, uint16_t pathLength, struct imageMetaData* pMetaData)
+static uint16_t findNameBound(const struct catalogEntry* pEntries, uint16_t entryAmount, char* pPrefix, uint16_t prefixLength, uint8_t upperBound)
+{
+	uint16_t low = 0;
+	uint16_t high = entryAmount;
+	uint16_t middle;
+	int compareRes;
+
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		compareRes = compareNamePrefix(&pEntries[middle], pPrefix, prefixLength);
+		if(compareRes < 0 || (upperBound == 1 && compareRes == 0))
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low;
+}
+
+
+/*!
+ *  \brief This function compares the start of the lowercase name of a catalog entry with the lowercase prefix.
+ *
+ *  \param pEntry -> a pointer to the catalog entry.
+ *  \param pPrefix -> a pointer to the prefix.
+ *  \param prefixLength -> the length of the prefix. (Length of the string without \0)
+ *
+ *  \return < 0, 0 or > 0 like strncmp.
+ */
+static int compareNamePrefix(const struct catalogEntry* pEntry, char* pPrefix, uint16_t prefixLength)
+{
+	const unsigned char* pName = (const unsigned char*)pEntry->path + pEntry->nameOffset;
+	unsigned char nameChar;
+	unsigned char prefixChar;
+	int compareRes = 0;
+
+	for(uint16_t index = 0; index < prefixLength && compareRes == 0; index++)
+	{
+		nameChar = (pName[index] >= 'A' && pName[index] <= 'Z')? pName[index] + 0x20 : pName[index];
+		prefixChar = ((unsigned char)pPrefix[index] >= 'A' && (unsigned char)pPrefix[index] <= 'Z')? pPrefix[index] + 0x20 : pPrefix[index];
+		compareRes = nameChar - prefixChar;
+		// A name that is shorter than the prefix ends with \0, which is smaller than every character of the prefix.
+		if(nameChar == '\0')
+		{
+			break;
+		}
+	}
+	return compareRes;
+}
+
+
+/*!
+ *  \brief This function calculates the FNV-1a hash of the lowercase name. The file type is hashed as well, so an image and gif with the same name get a different slot.
+ *
+ *  \param pName -> a pointer to the name.
+ *  \param nameLength -> the length of the name. (Length of the string without \0)
+ *  \param extType -> the file type (png or gif).
+ *
+ *  \return The hash of the name.
+ */
+static uint32_t hashName(char* pName, uint16_t nameLength, fileExtension extType)
+{
+	uint32_t hash = 2166136261u;
+	unsigned char nameChar;
+
+	hash = (hash ^ (uint32_t)extType) * 16777619u;
+	for(uint16_t index = 0; index < nameLength; index++)
+	{
+		nameChar = (unsigned char)pName[index];
+		nameChar = (nameChar >= 'A' && nameChar <= 'Z')? nameChar + 0x20 : nameChar;
+		hash = (hash ^ nameChar) * 16777619u;
+	}
+	return hash;
+}
+
+
+/*!
+ *  \brief This function checks if the base name of a catalog entry is equal to the specified name. (Case insensitive)
+ *
+ *  \param pEntry -> a pointer to the catalog entry.
+ *  \param pName -> a pointer to the name.
+ *  \param nameLength -> the length of the name. (Length of the string without \0)
+ *
+ *  \retval 1 when the names are equal.
+ *  \retval 0 when the names are different.
+ */
+static uint8_t matchName(const struct catalogEntry* pEntry, char* pName, uint16_t nameLength)
+{
+	const unsigned char* pEntryName = (const unsigned char*)pEntry->path + pEntry->nameOffset;
+	unsigned char entryChar;
+	unsigned char nameChar;
+	uint8_t retVal = (pEntry->baseLength - pEntry->nameOffset == nameLength)? 1 : 0;
+
+	for(uint16_t index = 0; index < nameLength && retVal == 1; index++)
+	{
+		entryChar = (pEntryName[index] >= 'A' && pEntryName[index] <= 'Z')? pEntryName[index] + 0x20 : pEntryName[index];
+		nameChar = ((unsigned char)pName[index] >= 'A' && (unsigned char)pName[index] <= 'Z')? pName[index] + 0x20 : pName[index];
+		retVal = (entryChar == nameChar)? 1 : 0;
+	}
+	return retVal;
+}
+
+
+/*!
+ *  \brief This function returns the catalog entry with the specified number from the name index. Images are numbered first, gifs follow.
+ *
+ *  \param pCatalog -> a pointer to the catalog.
+ *  \param entryNumber -> the number of the entry.
+ *
+ *  \return A pointer to the catalog entry.
+ */
+static const struct catalogEntry* getIndexedEntry(const struct catalogSnapshot* pCatalog, uint16_t entryNumber)
+{
+	return (entryNumber < pCatalog->imageAmount)? &pCatalog->images[entryNumber] : &pCatalog->gifs[entryNumber - pCatalog->imageAmount];
+}
+
+
+/*!
+ *  \brief This function compares two paths without their arguments or extension.
+ *
+ *  \param pPathA -> a pointer to the first path.
+ *  \param baseLengthA -> the length of the first path without arguments or extension.
+ *  \param pPathB -> a pointer to the second path.
+ *  \param baseLengthB -> the length of the second path without arguments or extension.
+ *
+ *  \return < 0, 0 or > 0 like strcmp.
+ */
+static int compareBase(char* pPathA, uint16_t baseLengthA, char* pPathB, uint16_t baseLengthB)
+{
+	int compareRes = strncmp(pPathA, pPathB, (baseLengthA < baseLengthB)? baseLengthA : baseLengthB);
+	if(compareRes == 0)
+	{
+		compareRes = (baseLengthA > baseLengthB) - (baseLengthA < baseLengthB);
+	}
+	return compareRes;
+}
+
+
+/*!
+ *  \brief qsort compare function for the frames in the catalog. The frames are sorted on path and then on frame number.
+ *
+ *  \param pA -> a pointer to the first frame.
+ *  \param pB -> a pointer to the second frame.
+ *
+ *  \return < 0, 0 or > 0 like strcmp.
+ */
+static int compareFrames(const void* pA, const void* pB)
+{
+	const struct imageMetaData* pFrameA = (const struct imageMetaData*)pA;
+	const struct imageMetaData* pFrameB = (const struct imageMetaData*)pB;
+	int compareRes = compareBase(pFrameA->name, getPathLength(pFrameA->name, strlen(pFrameA->name), stop_at_any), pFrameB->name, getPathLength(pFrameB->name, strlen(pFrameB->name), stop_at_any));
+	if(compareRes == 0)
+	{
+		compareRes = (pFrameA->num > pFrameB->num) - (pFrameA->num < pFrameB->num);
+	}
+	return compareRes;
+}
+
+
+/*!
+ *  \brief qsort compare function for the images and gifs in the catalog. The entries are sorted on path without arguments or extension.
+ *
+ *  \param pA -> a pointer to the first entry.
+ *  \param pB -> a pointer to the second entry.
+ *
+ *  \return < 0, 0 or > 0 like strcmp.
+ */
+static int compareEntryBase(const void* pA, const void* pB)
+{
+	const struct catalogEntry* pEntryA = (const struct catalogEntry*)pA;
+	const struct catalogEntry* pEntryB = (const struct catalogEntry*)pB;
+	return compareBase(pEntryA->path, pEntryA->baseLength, pEntryB->path, pEntryB->baseLength);
+}
+
+
+/*!
+ *  \brief qsort compare function for the images and gifs in the catalog. The entries are sorted a_z on their lowercase name with extension, like extractNameOutOfPath returns it.
+ *  	   The names are compared in place, because the catalog that is sorted isn't published yet (extractNameOutOfPath uses the published catalog).
+ *
+ *  \param pA -> a pointer to the first entry.
+ *  \param pB -> a pointer to the second entry.
+ *
+ *  \return < 0, 0 or > 0 like strcmp.
+ */
+static int compareEntryName(const void* pA, const void* pB)
+{
+	const struct catalogEntry* pEntryA = (const struct catalogEntry*)pA;
+	const struct catalogEntry* pEntryB = (const struct catalogEntry*)pB;
+	// The name with extension is the rest of the path after the last '/', the paths of the images and gifs have no arguments.
+	const char* pNameA = pEntryA->path + pEntryA->nameOffset;
+	const char* pNameB = pEntryB->path + pEntryB->nameOffset;
+	char charA;
+	char charB;
+
+	for(uint16_t index = 0; index < MAX_PATH_LENGTH; index++)
+	{
+		charA = (pNameA[index] >= 'A' && pNameA[index] <= 'Z')? pNameA[index] + 0x20 : pNameA[index];
+		charB = (pNameB[index] >= 'A' && pNameB[index] <= 'Z')? pNameB[index] + 0x20 : pNameB[index];
+		if(charA != charB || charA == '\0')
+		{
+			return (int)(unsigned char)charA - (int)(unsigned char)charB;
+		}
+	}
+	return 0;
+}
+
+
+/*!
+ *  \brief This function determines the kind of file (.png, .gif, .raw or other) from the extension of the path.
+ *
+ *  \param pPath -> a pointer to the file path.
+ *  \param pathLength -> the length of the path. (Length of the string without \0)
+ *
+ *  \return kind_png, kind_gif, kind_raw or kind_other.
+ */
+static uint8_t getFileKind(char* pPath, uint16_t pathLength)
 {
-	// In this function the specified image path without extension or arguments is compared to the names of the files in the file system.
-	// When both match and the file from the file system is a raw image, the correct raw file is found and the meta data from this image is retrieved.
-	uint16_t lengthUntilArgsOrExt;
 	char pathBuffer[MAX_PATH_LENGTH];
+	uint8_t kind = kind_other;
+
+	// convExtToLowerCase is called to convert the extension of the file to lowercase. This way it doesn't matter whether the extension is e.g a .PNG or .png .
+	convExtToLowerCase(pPath, pathLength, pathBuffer, sizeof(pathBuffer));
+	kind = (strstr(pathBuffer, ".png") != NULL)? kind_png : kind;
+	kind = (strstr(pathBuffer, ".gif") != NULL)? kind_gif : kind;
+	kind = (strstr(pathBuffer, ".raw") != NULL)? kind_raw : kind;
+	return kind;
+}
+
+
+/*!
+ *  \brief This function frees a catalog that is not published, so initFileSystemAPI can build a new one in it.
+ *
+ *  \param pCatalog -> a pointer to the catalog that has to be freed.
+ *
+ *  \return void
+ */
+static void freeCatalog(struct catalogSnapshot* pCatalog)
+{
+	free(pCatalog->runtimeImages);
+	free(pCatalog->runtimeGifs);
+	free(pCatalog->runtimeFrames);
+	free(pCatalog->nameIndex);
+	pCatalog->nameIndex = NULL;
+	pCatalog->nameIndexMask = 0;
+	pCatalog->runtimeImages = NULL;
+	pCatalog->runtimeGifs = NULL;
+	pCatalog->runtimeFrames = NULL;
+	pCatalog->images = NULL;
+	pCatalog->gifs = NULL;
+	pCatalog->frames = NULL;
+	pCatalog->frameAmount = 0;
+	pCatalog->imageAmount = 0;
+	pCatalog->gifAmount = 0;
+	pCatalog->largestNameLength = 0;
+}
+
+
+/*!
+ *  \brief This function reads the binary header (rawImageHeader) at the start of a .raw file.
+ *
+ *  \param pFile -> a pointer to the file.
+ *  \param pMetaData -> a pointer to the location where the meta data will be stored. The data pointer points to the pixel data after the header.
+ *
+ *  \retval 0x01 when the file starts with a valid header.
+ *  \retval 0x00 when the file has no header or the header is invalid.
+ *
+ *  \remark The payload of a file is aligned (makefsdata PAYLOAD_ALIGNMENT), so the header is read with one struct load instead of parsing the file name.
+ */
+static uint8_t readRawHeader(const struct fsdata_file* pFile, struct imageMetaData* pMetaData)
+{
+	struct rawImageHeader header;
 	uint8_t retVal = 0;
-	struct imageMetaData bufMetaData;
-	pMetaData->num = 1;
 
-	// validateImage is called to check if the specified image is valid.
-	if(validateImage(imagePath, pathLength) != 0x00)
+	// The length is checked first, so a small file without header is never read past its end.
+	if(pFile->len >= (int)sizeof(struct rawImageHeader) && ((uintptr_t)pFile->data % sizeof(uint32_t)) == 0)
 	{
-		// getPathLength is called to get the length of the path without arguments or the extension.
-		lengthUntilArgsOrExt = getPathLength(imagePath, pathLength, stop_at_any);
-		// extractArgsOutOfPath is called to extract the arguments of imagePath.
-		extractArgsOutOfPath(imagePath, pathLength, pMetaData);
-
-		// This loop is used to check every file in the fs.
-		for(struct fsdata_file* f = (struct fsdata_file*)pFirstFile; f != NULL; f = (struct fsdata_file*)f->next)
+		header = *(const struct rawImageHeader*)pFile->data;
+		if(header.magic == RAW_HEADER_MAGIC && header.headerSize >= sizeof(struct rawImageHeader) && getRawBitsPerPixel(header.pixelFormat) != 0
+				&& header.frameNumber > 0 && checkImageSize(header.width, header.height, header.frameTime, header.pixelFormat, header.compression)
+				// The frames are drawn without line offset, so the stride has to be the size of one line of pixels.
+				&& header.stride == (header.width * getRawBitsPerPixel(header.pixelFormat) + 7) / 8 && header.payloadSize <= (uint32_t)pFile->len - header.headerSize
+				// a CLUT format needs its CLUT, it is stored after the dirty rectangle
+				&& (getRawClutEntries(header.pixelFormat) == 0 || (header.version >= RAW_HEADER_CLUT_VERSION && header.clutSize != 0 && header.clutSize <= getRawClutEntries(header.pixelFormat)
+					&& header.headerSize >= sizeof(struct rawImageHeader) + sizeof(struct rawDirtyRect) + header.clutSize * sizeof(uint32_t)))
+				// the pixels of a 4 bit format are drawn in pairs
+				&& (getRawBitsPerPixel(header.pixelFormat) >= 8 || (header.width % 2) == 0)
+				// an uncompressed payload holds all pixels, RLE16 only compresses 16 bit pixels
+				&& ((header.compression == RAW_COMPRESSION_NONE && header.payloadSize >= (uint32_t)header.stride * header.height)
+					|| (header.compression == RAW_COMPRESSION_RLE16 && getRawBitsPerPixel(header.pixelFormat) == 16 && header.payloadSize >= sizeof(uint16_t))))
 		{
-			// convExtToLowerCase is called to convert the extension of the file f to lowercase. This way it doesn't matter whether the extension is e.g a .RAW or .raw .
-			convExtToLowerCase((char*)f->name, strlen((const char*)f->name), pathBuffer, sizeof(pathBuffer));
-			if(strncmp(pathBuffer, imagePath, lengthUntilArgsOrExt) == 0 && strstr(pathBuffer, ".raw") != NULL)
+			retVal = 1;
+#if RAW_HEADER_VERIFY_CHECKSUM
+			retVal = (calcRawChecksum(pFile->data + header.headerSize, header.payloadSize) == header.checksum)? 1 : 0;
+#endif
+			pMetaData->data = (void*)(pFile->data + header.headerSize);
+			pMetaData->width = header.width;
+			pMetaData->height = header.height;
+			pMetaData->num = header.frameNumber;
+			pMetaData->frameTime = header.frameTime;
+			pMetaData->pixelFormat = header.pixelFormat;
+			pMetaData->compression = header.compression;
+			pMetaData->dataSize = header.payloadSize;
+			pMetaData->clut = NULL;
+			pMetaData->clutSize = 0;
+			if(getRawClutEntries(header.pixelFormat) != 0)
+			{
+				pMetaData->clut = (const uint32_t*)(pFile->data + sizeof(struct rawImageHeader) + sizeof(struct rawDirtyRect));
+				pMetaData->clutSize = header.clutSize;
+			}
+			// the dirty rectangle follows the header, a frame without (valid) rectangle is drawn completely
+			pMetaData->dirty = (struct rawDirtyRect){.x = 0, .y = 0, .width = header.width, .height = header.height};
+			if(header.version >= RAW_HEADER_DIRTY_VERSION && header.headerSize >= sizeof(struct rawImageHeader) + sizeof(struct rawDirtyRect)
+					&& pFile->len >= (int)(sizeof(struct rawImageHeader) + sizeof(struct rawDirtyRect)))
 			{
-				// This if statement is used to compare the frame number of file f, with the frame number of imagePath.
-				// This is done so that the meta data of the correct .raw file is returned. If imagePath does not have a frame number -> .raw file with num 1 is chosen.
-				if(extractArgsOutOfPath((char*)f->name, strlen((const char*)f->name), &bufMetaData) != 0 && bufMetaData.num == pMetaData->num)
+				struct rawDirtyRect dirty = *(const struct rawDirtyRect*)(pFile->data + sizeof(struct rawImageHeader));
+				if((uint32_t)dirty.x + dirty.width <= header.width && (uint32_t)dirty.y + dirty.height <= header.height)
 				{
-					*pMetaData = bufMetaData;
-					pMetaData->name = (char*)f->name;
-					pMetaData->data = (void*)f->data;
-					retVal = 1;
+					pMetaData->dirty = dirty;
 				}
 			}
 		}
@@ -350,40 +1257,128 @@ uint8_t getRawImageMetaData(char* imagePath, uint16_t pathLength, struct imageMe
 
 
 /*!
- *  \brief This function checks if there is both a .png and .raw file or a .gif and .raw files of the specified file present in the file system.
+ *  \brief This function returns the amount of bits per pixel of a .raw pixel format.
  *
- *  \param imagePath -> specifies the image that has to be validated. This can be the .raw or .png or .gif file or the file path without any extensions.
- *  \param pathLength -> the length of the image path. (Length of the string without \0)
+ *  \param pixelFormat -> the pixel format (RAW_FORMAT_xxx).
  *
- *  \retval 0x01 when both the .png and .raw files or .gif and .raw files are found and the arguments of the .raw file(s) are valid.
- *  \retval 0x00 if the .png or .raw file or .gif and .raw files aren't found or when the arguments of the .raw file(s) are invalid.
+ *  \return The amount of bits per pixel.
+ *  \return 0 when the pixel format is not supported.
  *
- *  \warning Both the .raw and .png or .gif and .raw files NEED to be located in the same folder.
+ *  \remark The formats that need a fixed color (A8, A4) are not supported.
  */
-static uint8_t validateImage(char* imagePath, uint16_t pathLength)
+uint8_t getRawBitsPerPixel(uint8_t pixelFormat)
 {
-	uint16_t lengthUntilArgsOrExt = getPathLength(imagePath, pathLength, stop_at_any);
-	char pathBuffer[MAX_PATH_LENGTH];
-	uint8_t pngFound = 0;
-	uint8_t gifFound = 0;
-	uint8_t rawFound = 0;
-	uint8_t argsValid = 0;
-	struct imageMetaData buf;
+	uint8_t bitsPerPixel = 0;
 
-	for(struct fsdata_file* f = (struct fsdata_file*)pFirstFile; f != NULL; f = (struct fsdata_file*)f->next)
+	switch(pixelFormat)
+	{
+		case RAW_FORMAT_ARGB8888:
+			bitsPerPixel = 32;
+			break;
+		case RAW_FORMAT_RGB888:
+			bitsPerPixel = 24;
+			break;
+		case RAW_FORMAT_RGB565:
+		case RAW_FORMAT_ARGB1555:
+		case RAW_FORMAT_ARGB4444:
+		case RAW_FORMAT_AL88:
+			bitsPerPixel = 16;
+			break;
+		case RAW_FORMAT_L8:
+		case RAW_FORMAT_AL44:
+			bitsPerPixel = 8;
+			break;
+		case RAW_FORMAT_L4:
+			bitsPerPixel = 4;
+			break;
+		default:
+			break;
+	}
+	return bitsPerPixel;
+}
+
+
+/*!
+ *  \brief This function returns the maximum amount of CLUT entries of a .raw pixel format.
+ *
+ *  \param pixelFormat -> the pixel format (RAW_FORMAT_xxx).
+ *
+ *  \return The amount of entries the index of a pixel can address.
+ *  \return 0 when the pixel format doesn't use a CLUT.
+ */
+uint16_t getRawClutEntries(uint8_t pixelFormat)
+{
+	uint16_t clutEntries = 0;
+
+	switch(pixelFormat)
+	{
+		case RAW_FORMAT_L8:
+		case RAW_FORMAT_AL88:
+			clutEntries = 256;
+			break;
+		case RAW_FORMAT_AL44:
+		case RAW_FORMAT_L4:
+			clutEntries = 16;
+			break;
+		default:
+			break;
+	}
+	return clutEntries;
+}
+
+
+/*!
+ *  \brief This function checks the size of an image.
+ *
+ *  \param width -> the width of the image.
+ *  \param height -> the height of the image.
+ *  \param frameTime -> the frame time, 0 for a picture.
+ *  \param pixelFormat -> the pixel format (RAW_FORMAT_xxx).
+ *  \param compression -> the compression (RAW_COMPRESSION_xxx).
+ *
+ *  \retval 0x01 when the image fits in the picture area, or when it is a picture the LCD can scale down (up to MAX_SCALED_IMAGE_WIDTH x MAX_SCALED_IMAGE_HEIGHT).
+ *  \retval 0x00 when the image is too small or too large.
+ */
+static uint8_t checkImageSize(uint16_t width, uint16_t height, uint16_t frameTime, uint8_t pixelFormat, uint8_t compression)
+{
+	uint8_t scalable = (frameTime == 0 && compression == RAW_COMPRESSION_NONE && (pixelFormat == RAW_FORMAT_ARGB8888 || pixelFormat == RAW_FORMAT_ARGB1555))? 1 : 0;
+
+	if(width < MIN_IMAGE_WIDTH || height < MIN_IMAGE_HEIGHT)
+	{
+		return 0;
+	}
+	if(width <= MAX_IMAGE_WIDTH && height <= MAX_IMAGE_HEIGHT)
+	{
+		return 1;
+	}
+	return (scalable && width <= MAX_SCALED_IMAGE_WIDTH && height <= MAX_SCALED_IMAGE_HEIGHT)? 1 : 0;
+}
+
+
+#if RAW_HEADER_VERIFY_CHECKSUM
+/*!
+ *  \brief This function calculates the checksum of the pixel data of a .raw file. (CRC-32, the same as makefsdata writes in the header)
+ *
+ *  \param pData -> a pointer to the pixel data.
+ *  \param dataSize -> the size of the pixel data in bytes.
+ *
+ *  \return The checksum.
+ */
+static uint32_t calcRawChecksum(const uint8_t* pData, uint32_t dataSize)
+{
+	uint32_t crc = 0xFFFFFFFFu;
+
+	for(uint32_t index = 0; index < dataSize; index++)
 	{
-		// convExtToLowerCase is called to convert the extension of the file f to lowercase. This way it doesn't matter whether the extension is e.g a .PNG or .png .
-		convExtToLowerCase((char*)f->name, strlen((const char*)f->name), pathBuffer, sizeof(pathBuffer));
-		if(getPathLength((char*)f->name, strlen((const char*)f->name), stop_at_any) == lengthUntilArgsOrExt && strncmp(imagePath, (const char*)f->name, lengthUntilArgsOrExt) == 0)
+		crc ^= pData[index];
+		for(uint8_t bit = 0; bit < 8; bit++)
 		{
-			pngFound = (strstr(pathBuffer, ".png") != NULL)? 1 : pngFound;
-			gifFound = (strstr(pathBuffer, ".gif") != NULL)? 1 : gifFound;
-			rawFound = (strstr(pathBuffer, ".raw") != NULL)? 1 : rawFound;
-			argsValid = (rawFound == 1 && extractArgsOutOfPath((char*)f->name, strlen((const char*)f->name), &buf) == 1)? 1 : argsValid;
+			crc = (crc & 1)? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
 		}
 	}
-	return (argsValid == 1 && rawFound == 1 && (gifFound || pngFound == 1))? 1 : 0;
+	return ~crc;
 }
+#endif
 
 
 /*!
@@ -402,7 +1397,7 @@ static uint8_t extractArgsOutOfPath(char* pPath, uint16_t pathLength, struct ima
 	char pathBuffer[MAX_PATH_LENGTH];
 	char* pStartArg;
 
-	uint8_t argNumBuf;
+	uint16_t argNumBuf;
 	uint16_t argWidthBuf;
 	uint16_t argHeightBuf;
 	uint16_t argTimeBuf;
@@ -427,7 +1422,8 @@ static uint8_t extractArgsOutOfPath(char* pPath, uint16_t pathLength, struct ima
 		pStartArg = (pStartArg != NULL)? strtok(NULL, "#x@") : NULL;
 		argTimeBuf = (pStartArg != NULL)? strtol(pStartArg, NULL, 10) : 0;
 
-		if(pStartArg != NULL && argNumBuf > 0 && argWidthBuf >= MIN_IMAGE_WIDTH && argWidthBuf <= MAX_IMAGE_WIDTH && argHeightBuf >= MIN_IMAGE_HEIGHT && argHeightBuf <= MAX_IMAGE_HEIGHT)
+		// a file without header holds uncompressed ARGB1555 pixels
+		if(pStartArg != NULL && argNumBuf > 0 && checkImageSize(argWidthBuf, argHeightBuf, argTimeBuf, RAW_FORMAT_ARGB1555, RAW_COMPRESSION_NONE))
 		{
 			pMetaData->num = argNumBuf;
 			pMetaData->width = argWidthBuf;
@@ -195,7 +195,7 @@ int main(void)
 
       getImageList(imageList, png, a_z);
       printf("Images present in the fs: %u\n\r", getImageAmount());
-      for(uint8_t i = 0; i < getImageAmount(); i++)
+      for(uint16_t i = 0; i < getImageAmount(); i++)
       {
     	  // Extract the name out of the selected image path.
     	  extractNameOutOfPath(imageList[i], strlen(imageList[i]), name, no_ext, lower);
@@ -216,7 +216,7 @@ int main(void)
 	  }
       printf("Gifs present in the fs: %u\n\r", getGifAmount());
       getImageList(gifList, gif, a_z);
-	  for(uint8_t i = 0; i < getGifAmount(); i++)
+	  for(uint16_t i = 0; i < getGifAmount(); i++)
 	  {
 		  // Extract the name out of the selected image path.
 		  extractNameOutOfPath(gifList[i], strlen(gifList[i]), name, no_ext, lower);
@@ -267,6 +267,20 @@ int main(void)
     /* USER CODE BEGIN 3 */
 	MX_LWIP_Process();
 
+	// a gif that is shown switches to the new catalog when the file system API was reinitialized
+	refreshPicture();
+	// the next gif frame is drawn once its deadline on the frame timer has passed
+	scheduleFrames();
+	// the background layer shows the picture of a finished transition
+	finishTransition();
+	// a text that is higher than the text window scrolls
+	scrollText();
+	// the widgets that changed are repainted, at most once per refresh of the LCD
+	composeLCD();
+#if MEASURE_BLIT_TIME
+	printBlitTime();
+#endif
+
 	// read the button to turn the lcd back on
 	if(readButton() == 1)
 	{